@@ -46,7 +46,7 @@ CardItem *AbstractGame::getCard(int playerId, const QString &zoneName, int cardI
     if (!player)
         return nullptr;
 
-    CardZoneLogic *zone = player->getZones().value(zoneName, 0);
+    CardZoneLogic *zone = player->getZone(zoneName);
     if (!zone)
         return nullptr;
 
@@ -238,13 +238,13 @@ void ArrowDragItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
         }
 
         // if the card is in hand then we will move the card to stack or table as part of drawing the arrow
-        if (startZone->getName() == "hand") {
+        if (startZone->getId() == ZoneId::Hand) {
             startCard->playCard(false);
             CardInfoPtr ci = startCard->getCard().getCardPtr();
             bool playToStack = SettingsCache::instance().getPlayToStack();
-            if (ci &&
-                ((!playToStack && ci->getUiAttributes().tableRow == 3) ||
-                 (playToStack && ci->getUiAttributes().tableRow != 0 && startCard->getZone()->getName() != "stack")))
+            if (ci && ((!playToStack && ci->getUiAttributes().tableRow == 3) ||
+                       (playToStack && ci->getUiAttributes().tableRow != 0 &&
+                        startCard->getZone()->getId() != ZoneId::Stack)))
                 cmd.set_start_zone("stack");
             else
                 cmd.set_start_zone(playToStack ? "stack" : "table");
@@ -317,7 +317,7 @@ void ArrowAttachItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
 void ArrowAttachItem::attachCards(CardItem *startCard, const CardItem *targetCard)
 {
     // do nothing if target is already attached to another card or is not in play
-    if (targetCard->getAttachedTo() || targetCard->getZone()->getName() != "table") {
+    if (targetCard->getAttachedTo() || targetCard->getZone()->getId() != ZoneId::Table) {
         return;
     }
 
@@ -325,7 +325,7 @@ void ArrowAttachItem::attachCards(CardItem *startCard, const CardItem *targetCar
     CardZoneLogic *targetZone = targetCard->getZone();
 
     // move card onto table first if attaching from some other zone
-    if (startZone->getName() != "table") {
+    if (startZone->getId() != ZoneId::Table) {
         player->getPlayerActions()->playCardToTable(startCard, false);
     }
 
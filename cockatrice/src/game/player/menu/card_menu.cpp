@@ -115,11 +115,11 @@ CardMenu::CardMenu(Player *_player, const CardItem *_card, bool _shortcutsActive
     } else if (writeableCard) {
 
         if (card->getZone()) {
-            if (card->getZone()->getName() == "table") {
+            if (card->getZone()->getId() == ZoneId::Table) {
                 createTableMenu();
-            } else if (card->getZone()->getName() == "stack") {
+            } else if (card->getZone()->getId() == ZoneId::Stack) {
                 createStackMenu();
-            } else if (card->getZone()->getName() == "rfg" || card->getZone()->getName() == "grave") {
+            } else if (card->getZone()->getId() == ZoneId::Exile || card->getZone()->getId() == ZoneId::Graveyard) {
                 createGraveyardOrExileMenu();
             } else {
                 createHandOrCustomZoneMenu();
@@ -128,7 +128,7 @@ CardMenu::CardMenu(Player *_player, const CardItem *_card, bool _shortcutsActive
             addMenu(new MoveMenu(player));
         }
     } else {
-        if (card->getZone() && card->getZone()->getName() != "hand") {
+        if (card->getZone() && card->getZone()->getId() != ZoneId::Hand) {
             addAction(aDrawArrow);
             addSeparator();
             addRelatedCardView();
@@ -285,7 +285,7 @@ void CardMenu::createHandOrCustomZoneMenu()
     addMenu(new MoveMenu(player));
 
     // actions that are really wonky when done from deck or sideboard
-    if (card->getZone()->getName() == "hand") {
+    if (card->getZone()->getId() == ZoneId::Hand) {
         addSeparator();
         addAction(aAttach);
         addAction(aDrawArrow);
@@ -298,7 +298,7 @@ void CardMenu::createHandOrCustomZoneMenu()
     }
 
     addRelatedCardView();
-    if (card->getZone()->getName() == "hand") {
+    if (card->getZone()->getId() == ZoneId::Hand) {
         addRelatedCardActions();
     }
 }
@@ -32,7 +32,7 @@
 Player::Player(const ServerInfo_User &info, int _id, bool _local, bool _judge, AbstractGame *_parent)
     : QObject(_parent), game(_parent), playerInfo(new PlayerInfo(info, _id, _local, _judge)),
       playerEventHandler(new PlayerEventHandler(this)), playerActions(new PlayerActions(this)), active(false),
-      conceded(false), zoneId(0), dialogSemaphore(false)
+      conceded(false), zoneId(0), zonesById{}, dialogSemaphore(false)
 {
     initializeZones();
 
@@ -118,14 +118,6 @@ void Player::setZoneId(int _zoneId)
 
 void Player::processPlayerInfo(const ServerInfo_Player &info)
 {
-    static QSet<QString> builtinZones{/* PileZones */
-                                      "deck", "grave", "rfg", "sb",
-                                      /* TableZone */
-                                      "table",
-                                      /* StackZone */
-                                      "stack",
-                                      /* HandZone */
-                                      "hand"};
     clearCounters();
     clearArrows();
 
@@ -133,7 +125,7 @@ void Player::processPlayerInfo(const ServerInfo_Player &info)
     while (zoneIt.hasNext()) {
         zoneIt.next().value()->clearContents();
 
-        if (!builtinZones.contains(zoneIt.key())) {
+        if (zoneIt.value()->getId() == ZoneId::Other) {
             zoneIt.remove();
         }
     }
@@ -145,7 +137,7 @@ void Player::processPlayerInfo(const ServerInfo_Player &info)
         const ServerInfo_Zone &zoneInfo = info.zone_list(i);
 
         QString zoneName = QString::fromStdString(zoneInfo.name());
-        CardZoneLogic *zone = zones.value(zoneName, 0);
+        CardZoneLogic *zone = getZone(zoneName);
         if (!zone) {
             // Create a new CardZone if it doesn't exist
 
@@ -219,7 +211,7 @@ void Player::processCardAttachment(const ServerInfo_Player &info)
     const int zoneListSize = info.zone_list_size();
     for (int i = 0; i < zoneListSize; ++i) {
         const ServerInfo_Zone &zoneInfo = info.zone_list(i);
-        CardZoneLogic *zone = zones.value(QString::fromStdString(zoneInfo.name()), 0);
+        CardZoneLogic *zone = getZone(zoneInfo.name());
         if (!zone) {
             continue;
         }
@@ -375,10 +367,10 @@ ArrowItem *Player::addArrow(const ServerInfo_Arrow &arrow)
         return nullptr;
     }
 
-    CardZoneLogic *startZone = startPlayer->getZones().value(QString::fromStdString(arrow.start_zone()), 0);
+    CardZoneLogic *startZone = startPlayer->getZone(arrow.start_zone());
     CardZoneLogic *targetZone = nullptr;
     if (arrow.has_target_zone()) {
-        targetZone = targetPlayer->getZones().value(QString::fromStdString(arrow.target_zone()), 0);
+        targetZone = targetPlayer->getZone(arrow.target_zone());
     }
     if (!startZone || (!targetZone && arrow.has_target_zone())) {
         return nullptr;
@@ -140,12 +140,28 @@ public:
     template <typename T> T *addZone(T *zone)
     {
         zones.insert(zone->getName(), zone);
+        if (zone->getId() != ZoneId::Other) {
+            zonesById[zone->getId()] = zone;
+        }
         return zone;
     }
 
-    CardZoneLogic *getZone(const QString zoneName)
+    CardZoneLogic *getZone(ZoneId::Id id) const
     {
-        return zones.value(zoneName);
+        return id == ZoneId::Other ? nullptr : zonesById[id];
+    }
+
+    CardZoneLogic *getZone(const QString &zoneName) const
+    {
+        const ZoneId::Id id = ZoneId::fromName(zoneName);
+        return id == ZoneId::Other ? zones.value(zoneName) : zonesById[id];
+    }
+
+    /// Looks up the zone named in an event, only converting the name for zones other than the builtin ones.
+    CardZoneLogic *getZone(const std::string &zoneName) const
+    {
+        const ZoneId::Id id = ZoneId::fromName(zoneName);
+        return id == ZoneId::Other ? zones.value(QString::fromStdString(zoneName)) : zonesById[id];
     }
 
     const QMap<QString, CardZoneLogic *> &getZones() const
@@ -155,37 +171,37 @@ public:
 
     PileZoneLogic *getDeckZone()
     {
-        return qobject_cast<PileZoneLogic *>(zones.value("deck"));
+        return qobject_cast<PileZoneLogic *>(zonesById[ZoneId::Deck]);
     }
 
     PileZoneLogic *getGraveZone()
     {
-        return qobject_cast<PileZoneLogic *>(zones.value("grave"));
+        return qobject_cast<PileZoneLogic *>(zonesById[ZoneId::Graveyard]);
     }
 
     PileZoneLogic *getRfgZone()
     {
-        return qobject_cast<PileZoneLogic *>(zones.value("rfg"));
+        return qobject_cast<PileZoneLogic *>(zonesById[ZoneId::Exile]);
     }
 
     PileZoneLogic *getSideboardZone()
     {
-        return qobject_cast<PileZoneLogic *>(zones.value("sb"));
+        return qobject_cast<PileZoneLogic *>(zonesById[ZoneId::Sideboard]);
     }
 
     TableZoneLogic *getTableZone()
     {
-        return qobject_cast<TableZoneLogic *>(zones.value("table"));
+        return qobject_cast<TableZoneLogic *>(zonesById[ZoneId::Table]);
     }
 
     StackZoneLogic *getStackZone()
     {
-        return qobject_cast<StackZoneLogic *>(zones.value("stack"));
+        return qobject_cast<StackZoneLogic *>(zonesById[ZoneId::Stack]);
     }
 
     HandZoneLogic *getHandZone()
     {
-        return qobject_cast<HandZoneLogic *>(zones.value("hand"));
+        return qobject_cast<HandZoneLogic *>(zonesById[ZoneId::Hand]);
     }
 
     AbstractCounter *addCounter(const ServerInfo_Counter &counter);
@@ -245,6 +261,7 @@ private:
 
     int zoneId;
     QMap<QString, CardZoneLogic *> zones;
+    CardZoneLogic *zonesById[ZoneId::Count];
     QMap<int, AbstractCounter *> counters;
     QMap<int, ArrowItem *> arrows;
 
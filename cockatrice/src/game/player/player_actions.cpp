@@ -1079,7 +1079,7 @@ bool PlayerActions::createRelatedFromRelation(const CardItem *sourceCard, const
 
         // move card onto table first if attaching from some other zone
         // we only do this for AttachTo because cross-zone TransformInto is already handled server-side
-        if (attachType == CardRelationType::AttachTo && sourceCard->getZone()->getName() != "table") {
+        if (attachType == CardRelationType::AttachTo && sourceCard->getZone()->getId() != ZoneId::Table) {
             playCardToTable(sourceCard, false);
         }
 
@@ -1147,7 +1147,7 @@ void PlayerActions::createCard(const CardItem *sourceCard,
 
         case CardRelationType::TransformInto:
             // allow cards to directly transform on stack
-            cmd.set_zone(sourceCard->getZone()->getName() == "stack" ? "stack" : "table");
+            cmd.set_zone(sourceCard->getZone()->getId() == ZoneId::Stack ? "stack" : "table");
             // Transform card zone changes are handled server-side
             cmd.set_target_zone(sourceCard->getZone()->getName().toStdString());
             cmd.set_target_card_id(sourceCard->getId());
@@ -1651,7 +1651,7 @@ void PlayerActions::playSelectedCards(const bool faceDown)
               [](const auto &card1, const auto &card2) { return card1->getId() > card2->getId(); });
 
     for (auto &card : selectedCards) {
-        if (card && !isUnwritableRevealZone(card->getZone()) && card->getZone()->getName() != "table") {
+        if (card && !isUnwritableRevealZone(card->getZone()) && card->getZone()->getId() != ZoneId::Table) {
             playCard(card, faceDown);
         }
     }
@@ -42,7 +42,7 @@ void PlayerEventHandler::eventGameSay(const Event_GameSay &event)
 
 void PlayerEventHandler::eventShuffle(const Event_Shuffle &event)
 {
-    CardZoneLogic *zone = player->getZone(QString::fromStdString(event.zone_name()));
+    CardZoneLogic *zone = player->getZone(event.zone_name());
     if (!zone) {
         return;
     }
@@ -112,7 +112,7 @@ void PlayerEventHandler::eventDeleteArrow(const Event_DeleteArrow &event)
 
 void PlayerEventHandler::eventCreateToken(const Event_CreateToken &event)
 {
-    CardZoneLogic *zone = player->getZone(QString::fromStdString(event.zone_name()));
+    CardZoneLogic *zone = player->getZone(event.zone_name());
     if (!zone) {
         return;
     }
@@ -141,7 +141,7 @@ void PlayerEventHandler::eventSetCardAttr(const Event_SetCardAttr &event,
                                           const GameEventContext &context,
                                           EventProcessingOptions options)
 {
-    CardZoneLogic *zone = player->getZone(QString::fromStdString(event.zone_name()));
+    CardZoneLogic *zone = player->getZone(event.zone_name());
     if (!zone) {
         return;
     }
@@ -168,7 +168,7 @@ void PlayerEventHandler::eventSetCardAttr(const Event_SetCardAttr &event,
 
 void PlayerEventHandler::eventSetCardCounter(const Event_SetCardCounter &event)
 {
-    CardZoneLogic *zone = player->getZone(QString::fromStdString(event.zone_name()));
+    CardZoneLogic *zone = player->getZone(event.zone_name());
     if (!zone) {
         return;
     }
@@ -211,7 +211,7 @@ void PlayerEventHandler::eventDumpZone(const Event_DumpZone &event)
     if (!zoneOwner) {
         return;
     }
-    CardZoneLogic *zone = zoneOwner->getZones().value(QString::fromStdString(event.zone_name()), 0);
+    CardZoneLogic *zone = zoneOwner->getZone(event.zone_name());
     if (!zone) {
         return;
     }
@@ -224,15 +224,14 @@ void PlayerEventHandler::eventMoveCard(const Event_MoveCard &event, const GameEv
     if (!startPlayer) {
         return;
     }
-    QString startZoneString = QString::fromStdString(event.start_zone());
-    CardZoneLogic *startZone = startPlayer->getZones().value(startZoneString, 0);
+    CardZoneLogic *startZone = startPlayer->getZone(event.start_zone());
     Player *targetPlayer = player->getGame()->getPlayerManager()->getPlayers().value(event.target_player_id());
     if (!targetPlayer) {
         return;
     }
     CardZoneLogic *targetZone;
     if (event.has_target_zone()) {
-        targetZone = targetPlayer->getZones().value(QString::fromStdString(event.target_zone()), 0);
+        targetZone = targetPlayer->getZone(event.target_zone());
     } else {
         targetZone = startZone;
     }
@@ -321,15 +320,15 @@ void PlayerEventHandler::eventMoveCard(const Event_MoveCard &event, const GameEv
     }
     player->getPlayerMenu()->updateCardMenu(card);
 
-    if (player->getPlayerActions()->isMovingCardsUntil() && startZoneString == "deck" &&
-        targetZone->getName() == "stack") {
+    if (player->getPlayerActions()->isMovingCardsUntil() && startZone->getId() == ZoneId::Deck &&
+        targetZone->getId() == ZoneId::Stack) {
         player->getPlayerActions()->moveOneCardUntil(card);
     }
 }
 
 void PlayerEventHandler::eventFlipCard(const Event_FlipCard &event)
 {
-    CardZoneLogic *zone = player->getZone(QString::fromStdString(event.zone_name()));
+    CardZoneLogic *zone = player->getZone(event.zone_name());
     if (!zone) {
         return;
     }
@@ -351,7 +350,7 @@ void PlayerEventHandler::eventFlipCard(const Event_FlipCard &event)
 
 void PlayerEventHandler::eventDestroyCard(const Event_DestroyCard &event)
 {
-    CardZoneLogic *zone = player->getZone(QString::fromStdString(event.zone_name()));
+    CardZoneLogic *zone = player->getZone(event.zone_name());
     if (!zone) {
         return;
     }
@@ -381,14 +380,14 @@ void PlayerEventHandler::eventAttachCard(const Event_AttachCard &event)
     if (event.has_target_player_id()) {
         targetPlayer = playerList.value(event.target_player_id(), 0);
         if (targetPlayer) {
-            targetZone = targetPlayer->getZones().value(QString::fromStdString(event.target_zone()), 0);
+            targetZone = targetPlayer->getZone(event.target_zone());
             if (targetZone) {
                 targetCard = targetZone->getCard(event.target_card_id());
             }
         }
     }
 
-    CardZoneLogic *startZone = player->getZone(QString::fromStdString(event.start_zone()));
+    CardZoneLogic *startZone = player->getZone(event.start_zone());
     if (!startZone) {
         return;
     }
@@ -448,7 +447,7 @@ void PlayerEventHandler::eventDrawCards(const Event_DrawCards &event)
 void PlayerEventHandler::eventRevealCards(const Event_RevealCards &event, EventProcessingOptions options)
 {
     Q_UNUSED(options);
-    CardZoneLogic *zone = player->getZone(QString::fromStdString(event.zone_name()));
+    CardZoneLogic *zone = player->getZone(event.zone_name());
     if (!zone) {
         return;
     }
@@ -512,7 +511,7 @@ void PlayerEventHandler::eventRevealCards(const Event_RevealCards &event, EventP
 
 void PlayerEventHandler::eventChangeZoneProperties(const Event_ChangeZoneProperties &event)
 {
-    CardZoneLogic *zone = player->getZone(QString::fromStdString(event.zone_name()));
+    CardZoneLogic *zone = player->getZone(event.zone_name());
     if (!zone) {
         return;
     }
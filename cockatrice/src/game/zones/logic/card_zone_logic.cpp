@@ -25,8 +25,8 @@ CardZoneLogic::CardZoneLogic(Player *_player,
                              bool _isShufflable,
                              bool _contentsKnown,
                              QObject *parent)
-    : QObject(parent), player(_player), name(_name), cards(_contentsKnown), views{}, hasCardAttr(_hasCardAttr),
-      isShufflable(_isShufflable)
+    : QObject(parent), player(_player), name(_name), id(ZoneId::fromName(_name)), cards(_contentsKnown), views{},
+      hasCardAttr(_hasCardAttr), isShufflable(_isShufflable)
 {
     // If we join a game before the card db finishes loading, the cards might have the wrong printings.
     // Force refresh all cards in the zone when db finishes loading to fix that.
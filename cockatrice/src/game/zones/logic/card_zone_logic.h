@@ -12,6 +12,7 @@
 
 #include <QLoggingCategory>
 #include <QObject>
+#include <libcockatrice/utility/zone_id.h>
 
 inline Q_LOGGING_CATEGORY(CardZoneLogicLog, "card_zone_logic");
 
@@ -67,6 +68,10 @@ public:
     {
         return name;
     }
+    [[nodiscard]] ZoneId::Id getId() const
+    {
+        return id;
+    }
     [[nodiscard]] QString getTranslatedName(bool theirOwn, GrammaticalCase gc) const;
     [[nodiscard]] Player *getPlayer() const
     {
@@ -107,6 +112,7 @@ private slots:
 protected:
     Player *player;
     QString name;
+    ZoneId::Id id;
     CardList cards;
     QList<ZoneViewZone *> views;
     bool hasCardAttr;
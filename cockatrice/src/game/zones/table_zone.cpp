@@ -192,7 +192,7 @@ void TableZone::toggleTapped()
 
     auto isCardOnTable = [](const QGraphicsItem *item) {
         if (auto card = qgraphicsitem_cast<const CardItem *>(item)) {
-            return card->getZone()->getName() == "table";
+            return card->getZone()->getId() == ZoneId::Table;
         }
         return false;
     };
@@ -270,6 +270,9 @@ void GamesModel::updateGameList(const ServerInfo_Game &game)
             return;
         }
     }
+    // a game that left a server side filtered list before it reached this client
+    if (game.closed())
+        return;
     beginInsertRows(QModelIndex(), gameList.size(), gameList.size());
     gameList.append(game);
     endInsertRows();
@@ -29,9 +29,10 @@
 #include <libcockatrice/protocol/pb/response_replay_download.pb.h>
 #include <libcockatrice/protocol/pb/response_replay_get_code.pb.h>
 #include <libcockatrice/protocol/pending_command.h>
+#include <libcockatrice/protocol/replay_codec.h>
 
 TabReplays::TabReplays(TabSupervisor *_tabSupervisor, AbstractClient *_client, const ServerInfo_User *currentUserInfo)
-    : Tab(_tabSupervisor), client(_client)
+    : Tab(_tabSupervisor), client(_client), nextReplayDownloadId(0)
 {
     leftGroupBox = createLeftLayout();
     rightGroupBox = createRightLayout();
@@ -363,27 +364,10 @@ void TabReplays::actOpenRemoteReplay()
             continue;
         }
 
-        Command_ReplayDownload cmd;
-        cmd.set_replay_id(curRight->replay_id());
-
-        PendingCommand *pend = client->prepareSessionCommand(cmd);
-        connect(pend, &PendingCommand::finished, this, &TabReplays::openRemoteReplayFinished);
-        client->sendCommand(pend);
+        downloadReplay(curRight->replay_id(), QString());
     }
 }
 
-void TabReplays::openRemoteReplayFinished(const Response &r)
-{
-    if (r.response_code() != Response::RespOk)
-        return;
-
-    const Response_ReplayDownload &resp = r.GetExtension(Response_ReplayDownload::ext);
-    GameReplay *replay = new GameReplay;
-    replay->ParseFromString(resp.replay_data());
-
-    emit openReplay(replay);
-}
-
 void TabReplays::actDownload()
 {
     QModelIndex curLeft = localDirView->selectionModel()->currentIndex();
@@ -416,34 +400,74 @@ void TabReplays::downloadNodeAtIndex(const QModelIndex &curLeft, const QModelInd
         const QString dirPath = curLeft.isValid() ? localDirModel->filePath(curLeft) : localDirModel->rootPath();
         const QString filePath = dirPath + QString("/replay_%1.cor").arg(replay->replay_id());
 
-        Command_ReplayDownload cmd;
-        cmd.set_replay_id(replay->replay_id());
-
-        PendingCommand *pend = client->prepareSessionCommand(cmd);
-        pend->setExtraData(filePath);
-        connect(pend, &PendingCommand::finished, this, &TabReplays::downloadFinished);
-        client->sendCommand(pend);
+        downloadReplay(replay->replay_id(), filePath);
     }
     // node at index was invalid
 }
 
-void TabReplays::downloadFinished(const Response &r,
-                                  const CommandContainer & /* commandContainer */,
-                                  const QVariant &extraData)
+void TabReplays::downloadReplay(int replayId, const QString &filePath)
 {
-    if (r.response_code() != Response::RespOk)
+    const int downloadId = nextReplayDownloadId++;
+    replayDownloads.insert(downloadId, {replayId, filePath, QByteArray()});
+    requestReplayPart(downloadId);
+}
+
+void TabReplays::requestReplayPart(int downloadId)
+{
+    const ReplayDownload &download = replayDownloads[downloadId];
+
+    Command_ReplayDownload cmd;
+    cmd.set_replay_id(download.replayId);
+    cmd.set_offset(static_cast<quint32>(download.data.size()));
+    cmd.set_length(ReplayCodec::downloadChunkSize);
+
+    PendingCommand *pend = client->prepareSessionCommand(cmd);
+    pend->setExtraData(downloadId);
+    connect(pend, &PendingCommand::finished, this, &TabReplays::replayPartReceived);
+    client->sendCommand(pend);
+}
+
+void TabReplays::replayPartReceived(const Response &r,
+                                    const CommandContainer & /* commandContainer */,
+                                    const QVariant &extraData)
+{
+    const int downloadId = extraData.toInt();
+    if (r.response_code() != Response::RespOk) {
+        replayDownloads.remove(downloadId);
         return;
+    }
 
     const Response_ReplayDownload &resp = r.GetExtension(Response_ReplayDownload::ext);
-    QString filePath = extraData.toString();
+    ReplayDownload &download = replayDownloads[downloadId];
+    download.data.append(resp.replay_data().data(), static_cast<int>(resp.replay_data().size()));
+    const bool morePartsLeft = resp.has_total_size() && !resp.replay_data().empty() &&
+                               static_cast<quint32>(download.data.size()) < resp.total_size();
+    if (morePartsLeft) {
+        requestReplayPart(downloadId);
+        return;
+    }
+
+    // servers without partial downloads send the whole replay, uncompressed, in the first response
+    const ReplayDownload finished = replayDownloads.take(downloadId);
+    const QByteArray replayData = resp.has_total_size() ? ReplayCodec::decode(finished.data) : finished.data;
+    if (replayData.isEmpty() && !finished.data.isEmpty()) {
+        qWarning() << "failed to decode downloaded replay" << finished.replayId;
+        return;
+    }
+
+    if (finished.filePath.isEmpty()) {
+        GameReplay *replay = new GameReplay;
+        replay->ParseFromArray(replayData.data(), static_cast<int>(replayData.size()));
+        emit openReplay(replay);
+        return;
+    }
 
-    const std::string &_data = resp.replay_data();
-    QFile f(filePath);
+    QFile f(finished.filePath);
     if (!f.open(QIODevice::WriteOnly)) {
-        qWarning() << "failed to open" << filePath << "for writing after downloading replay";
+        qWarning() << "failed to open" << finished.filePath << "for writing after downloading replay";
         return;
     }
-    f.write((const char *)_data.data(), _data.size());
+    f.write(replayData);
     f.close();
 }
 
@@ -10,6 +10,7 @@
 
 #include "tab.h"
 
+#include <QMap>
 #include <libcockatrice/network/client/abstract/abstract_client.h>
 
 class ServerInfo_User;
@@ -39,12 +40,24 @@ private:
     QAction *aOpenRemoteReplay, *aDownload, *aKeep, *aDeleteRemoteReplay, *aGetReplayCode;
     QAction *aSubmitReplayCode;
 
+    // replays being downloaded part by part, see requestReplayPart()
+    struct ReplayDownload
+    {
+        int replayId;
+        QString filePath; // empty if the replay is opened instead of saved
+        QByteArray data;
+    };
+    QMap<int, ReplayDownload> replayDownloads;
+    int nextReplayDownloadId;
+
     QGroupBox *createLeftLayout();
     QGroupBox *createRightLayout();
 
     void setRemoteEnabled(bool enabled);
 
     void downloadNodeAtIndex(const QModelIndex &curLeft, const QModelIndex &curRight);
+    void downloadReplay(int replayId, const QString &filePath);
+    void requestReplayPart(int downloadId);
 
 private slots:
     void handleConnected(const ServerInfo_User &userInfo);
@@ -60,10 +73,9 @@ private slots:
 
     void actRemoteDoubleClick(const QModelIndex &curLeft);
     void actOpenRemoteReplay();
-    void openRemoteReplayFinished(const Response &r);
 
     void actDownload();
-    void downloadFinished(const Response &r, const CommandContainer &commandContainer, const QVariant &extraData);
+    void replayPartReceived(const Response &r, const CommandContainer &commandContainer, const QVariant &extraData);
 
     void actKeepRemoteReplay();
     void keepRemoteReplayFinished(const Response &r, const CommandContainer &commandContainer);
@@ -27,7 +27,7 @@ static const unsigned int protocolVersion = 14;
 
 RemoteClient::RemoteClient(QObject *parent, INetworkSettingsProvider *_networkSettingsProvider)
     : AbstractClient(parent), networkSettingsProvider(_networkSettingsProvider), timeRunning(0), lastDataReceived(0),
-      messageInProgress(false), handshakeStarted(false), usingWebSocket(false), messageLength(0), hashedPassword()
+      handshakeStarted(false), usingWebSocket(false), hashedPassword()
 {
 
     clearNewClientFeatures();
@@ -114,6 +114,8 @@ void RemoteClient::processServerIdentificationEvent(const Event_ServerIdentifica
         return;
     }
     serverSupportsPasswordHash = event.server_options() & Event_ServerIdentification::SupportsPasswordHash;
+    if (event.has_compression_threshold())
+        qCDebug(RemoteClientLog) << "Server compresses messages from" << event.compression_threshold() << "bytes";
 
     if (getStatus() == StatusRequestingForgotPassword) {
         Command_ForgotPasswordRequest cmdForgotPasswordRequest;
@@ -364,51 +366,50 @@ void RemoteClient::readData()
 
     inputBuffer.append(data);
 
-    do {
-        if (!messageInProgress) {
-            if (inputBuffer.size() >= 4) {
-                // dirty hack to be compatible with v14 server that sends 60 bytes of garbage at the beginning
-                if (!handshakeStarted) {
-                    handshakeStarted = true;
-                    if (inputBuffer.startsWith("<?xm")) {
-                        messageInProgress = true;
-                        messageLength = 60;
-                    }
-                } else {
-                    // end of hack
-                    messageLength = (((quint32)(unsigned char)inputBuffer[0]) << 24) +
-                                    (((quint32)(unsigned char)inputBuffer[1]) << 16) +
-                                    (((quint32)(unsigned char)inputBuffer[2]) << 8) +
-                                    ((quint32)(unsigned char)inputBuffer[3]);
-                    inputBuffer.remove(0, 4);
-                    messageInProgress = true;
-                }
-            } else
-                return;
-        }
-        if (inputBuffer.size() < messageLength)
+    // dirty hack to be compatible with v14 server that sends 60 bytes of garbage at the beginning
+    if (!handshakeStarted) {
+        if (inputBuffer.bytesAvailable() < FrameReader::headerSize)
             return;
+        handshakeStarted = true;
+        if (inputBuffer.startsWith("<?xm"))
+            inputBuffer.expectRawFrame(60);
+    }
+    // end of hack
 
+    const char *message;
+    int messageLength;
+    bool compressed;
+    while (inputBuffer.readFrame(message, messageLength, &compressed)) {
         ServerMessage newServerMessage;
-        newServerMessage.ParseFromArray(inputBuffer.data(), messageLength);
+        if (compressed) {
+            const QByteArray payload = FrameReader::uncompressPayload(message, messageLength);
+            newServerMessage.ParseFromArray(payload.constData(), static_cast<int>(payload.size()));
+        } else {
+            newServerMessage.ParseFromArray(message, messageLength);
+        }
 
         qCDebug(RemoteClientLog).noquote() << "IN" << getSafeDebugString(newServerMessage);
 
-        inputBuffer.remove(0, messageLength);
-        messageInProgress = false;
-
         processProtocolItem(newServerMessage);
 
         if (getStatus() == StatusDisconnecting) // use thread-safe getter
             doDisconnectFromServer();
-    } while (!inputBuffer.isEmpty());
+    }
 }
 
 void RemoteClient::websocketMessageReceived(const QByteArray &message)
 {
     lastDataReceived = timeRunning;
     ServerMessage newServerMessage;
-    newServerMessage.ParseFromArray(message.data(), message.length());
+    // compressed messages keep the length prefix of a TCP frame, whose flag no plain ServerMessage starts with
+    if (message.size() >= FrameReader::headerSize && (static_cast<quint8>(message.at(0)) & 0x80)) {
+        const char *body = message.constData() + FrameReader::headerSize;
+        const QByteArray payload =
+            FrameReader::uncompressPayload(body, static_cast<int>(message.size()) - FrameReader::headerSize);
+        newServerMessage.ParseFromArray(payload.constData(), static_cast<int>(payload.size()));
+    } else {
+        newServerMessage.ParseFromArray(message.data(), message.length());
+    }
 
     qCDebug(RemoteClientLog).noquote() << "IN" << getSafeDebugString(newServerMessage);
 
@@ -507,9 +508,8 @@ void RemoteClient::doDisconnectFromServer()
 {
     timer->stop();
 
-    messageInProgress = false;
+    inputBuffer.clear();
     handshakeStarted = false;
-    messageLength = 0;
 
     QList<PendingCommand *> pc = pendingCommands.values();
     for (const auto &i : pc) {
@@ -12,6 +12,7 @@
 #include <QLoggingCategory>
 #include <QWebSocket>
 #include <libcockatrice/interfaces/interface_network_settings_provider.h>
+#include <libcockatrice/protocol/frame_reader.h>
 #include <libcockatrice/protocol/pb/commands.pb.h>
 
 inline Q_LOGGING_CATEGORY(RemoteClientLog, "remote_client");
@@ -100,11 +101,9 @@ private:
     INetworkSettingsProvider *networkSettingsProvider;
     int maxTimeout;
     int timeRunning, lastDataReceived;
-    QByteArray inputBuffer;
-    bool messageInProgress;
+    FrameReader inputBuffer;
     bool handshakeStarted;
     bool usingWebSocket;
-    int messageLength;
     QTimer *timer;
     QTcpSocket *socket;
     QWebSocket *websocket;
@@ -3,6 +3,7 @@
 #include "../server.h"
 #include "../server_abstractuserinterface.h"
 #include "../server_database_interface.h"
+#include "../server_message_frame.h"
 #include "../server_room.h"
 #include "server_card.h"
 #include "server_game.h"
@@ -539,6 +540,15 @@ void Server_AbstractParticipant::sendGameEvent(const GameEventContainer &cont)
     }
 }
 
+void Server_AbstractParticipant::sendGameEvent(const ServerMessageFrame &frame)
+{
+    QMutexLocker locker(&playerMutex);
+
+    if (userInterface) {
+        userInterface->sendProtocolItem(frame);
+    }
+}
+
 void Server_AbstractParticipant::setUserInterface(Server_AbstractUserInterface *_userInterface)
 {
     playerMutex.lock();
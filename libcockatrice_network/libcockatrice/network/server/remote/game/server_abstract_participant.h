@@ -15,6 +15,7 @@ class ServerInfo_Player;
 class ServerInfo_PlayerProperties;
 class GameEventContainer;
 class GameEventStorage;
+class ServerMessageFrame;
 class ResponseContainer;
 class GameCommand;
 
@@ -175,6 +176,7 @@ public:
 
     Response::ResponseCode processGameCommand(const GameCommand &command, ResponseContainer &rc, GameEventStorage &ges);
     void sendGameEvent(const GameEventContainer &event);
+    void sendGameEvent(const ServerMessageFrame &frame);
 
     virtual void
     getInfo(ServerInfo_Player *info, Server_AbstractParticipant *recipient, bool omniscient, bool withUserInfo);
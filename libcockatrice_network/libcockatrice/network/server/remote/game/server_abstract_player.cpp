@@ -55,7 +55,7 @@ Server_AbstractPlayer::Server_AbstractPlayer(Server_Game *_game,
                                              bool _judge,
                                              Server_AbstractUserInterface *_userInterface)
     : Server_AbstractParticipant(_game, _playerId, _userInfo, _judge, _userInterface), conceded(false), deck(nullptr),
-      sideboardLocked(true), readyStart(false), nextCardId(0)
+      sideboardLocked(true), zonesById{}, readyStart(false), nextCardId(0)
 {
     spectator = false;
 }
@@ -100,8 +100,10 @@ void Server_AbstractPlayer::clearZones()
         delete zone;
     }
     zones.clear();
+    std::fill(std::begin(zonesById), std::end(zonesById), nullptr);
 
     for (Server_Arrow *arrow : arrows) {
+        game->removeArrowFromIndex(this, arrow);
         delete arrow;
     }
     arrows.clear();
@@ -110,11 +112,21 @@ void Server_AbstractPlayer::clearZones()
 void Server_AbstractPlayer::addZone(Server_CardZone *zone)
 {
     zones.insert(zone->getName(), zone);
+    if (zone->getId() != ZoneId::Other) {
+        zonesById[zone->getId()] = zone;
+    }
+}
+
+Server_CardZone *Server_AbstractPlayer::getZone(const std::string &name) const
+{
+    const ZoneId::Id id = ZoneId::fromName(name);
+    return id == ZoneId::Other ? zones.value(nameFromStdString(name)) : zonesById[id];
 }
 
 void Server_AbstractPlayer::addArrow(Server_Arrow *arrow)
 {
     arrows.insert(arrow->getId(), arrow);
+    game->addArrowToIndex(this, arrow);
 }
 
 void Server_AbstractPlayer::updateArrowId(int id)
@@ -130,6 +142,7 @@ bool Server_AbstractPlayer::deleteArrow(int arrowId)
         return false;
     }
     arrows.remove(arrowId);
+    game->removeArrowFromIndex(this, arrow);
     delete arrow;
     return true;
 }
@@ -142,7 +155,7 @@ static Event_CreateToken
 makeCreateTokenEvent(Server_CardZone *zone, Server_Card *card, int xCoord, int yCoord, bool revealFacedownInfo = false)
 {
     Event_CreateToken event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getStdName());
     event.set_card_id(card->getId());
     event.set_face_down(card->getFaceDown());
 
@@ -163,12 +176,12 @@ makeCreateTokenEvent(Server_CardZone *zone, Server_Card *card, int xCoord, int y
 static Event_AttachCard makeAttachCardEvent(Server_Card *attachedCard, Server_Card *parentCard = nullptr)
 {
     Event_AttachCard event;
-    event.set_start_zone(attachedCard->getZone()->getName().toStdString());
+    event.set_start_zone(attachedCard->getZone()->getStdName());
     event.set_card_id(attachedCard->getId());
 
     if (parentCard) {
         event.set_target_player_id(parentCard->getZone()->getPlayer()->getPlayerId());
-        event.set_target_zone(parentCard->getZone()->getName().toStdString());
+        event.set_target_zone(parentCard->getZone()->getStdName());
         event.set_target_card_id(parentCard->getId());
     }
 
@@ -185,13 +198,13 @@ shouldDestroyOnMove(const Server_Card *card, const Server_CardZone *startZone, c
         return false;
     }
 
-    if (startZone->getName() == targetZone->getName()) {
+    if (startZone->hasSameName(targetZone)) {
         return false;
     }
 
     // Allow tokens on the stack
-    if ((startZone->getName() == "table" || startZone->getName() == "stack") &&
-        (targetZone->getName() == "table" || targetZone->getName() == "stack")) {
+    if ((startZone->getId() == ZoneId::Table || startZone->getId() == ZoneId::Stack) &&
+        (targetZone->getId() == ZoneId::Table || targetZone->getId() == ZoneId::Stack)) {
         return false;
     }
 
@@ -235,7 +248,7 @@ Response::ResponseCode Server_AbstractPlayer::moveCard(GameEventStorage &ges,
         }
 
         // do not allow attached cards to move around on the table
-        if (card->getParentCard() && targetzone->getName() == "table") {
+        if (card->getParentCard() && targetzone->getId() == ZoneId::Table) {
             continue;
         }
 
@@ -266,7 +279,7 @@ Response::ResponseCode Server_AbstractPlayer::moveCard(GameEventStorage &ges,
         int position = startzone->removeCard(card, sourceBeingLookedAt);
 
         // Attachment relationships can be retained when moving a card onto the opponent's table
-        if (startzone->getName() != targetzone->getName()) {
+        if (!startzone->hasSameName(targetzone)) {
             // Delete all attachment relationships
             if (card->getParentCard()) {
                 card->setParentCard(nullptr);
@@ -281,21 +294,14 @@ Response::ResponseCode Server_AbstractPlayer::moveCard(GameEventStorage &ges,
 
         if (startzone != targetzone) {
             // Delete all arrows from and to the card
-            for (auto *player : game->getPlayers().values()) {
-                QList<int> arrowsToDelete;
-                for (Server_Arrow *arrow : player->getArrows()) {
-                    if ((arrow->getStartCard() == card) || (arrow->getTargetItem() == card))
-                        arrowsToDelete.append(arrow->getId());
-                }
-                for (int j : arrowsToDelete) {
-                    player->deleteArrow(j);
-                }
+            for (const auto &arrow : game->getArrowsOf(card)) {
+                arrow.first->deleteArrow(arrow.second->getId());
             }
         }
 
         if (shouldDestroyOnMove(card, startzone, targetzone)) {
             Event_DestroyCard event;
-            event.set_zone_name(startzone->getName().toStdString());
+            event.set_zone_name(startzone->getStdName());
             event.set_card_id(static_cast<google::protobuf::uint32>(card->getId()));
             ges.enqueueGameEvent(event, playerId);
 
@@ -319,7 +325,7 @@ Response::ResponseCode Server_AbstractPlayer::moveCard(GameEventStorage &ges,
                 newX = targetzone->getFreeGridColumn(newX, yCoord, card->getName(), faceDown);
             } else {
                 yCoord = 0;
-                card->resetState(targetzone->getName() == "stack");
+                card->resetState(targetzone->getId() == ZoneId::Stack);
             }
 
             targetzone->insertCard(card, newX, yCoord);
@@ -345,10 +351,10 @@ Response::ResponseCode Server_AbstractPlayer::moveCard(GameEventStorage &ges,
 
             Event_MoveCard eventOthers;
             eventOthers.set_start_player_id(startzone->getPlayer()->getPlayerId());
-            eventOthers.set_start_zone(startzone->getName().toStdString());
+            eventOthers.set_start_zone(startzone->getStdName());
             eventOthers.set_target_player_id(targetzone->getPlayer()->getPlayerId());
             if (startzone != targetzone) {
-                eventOthers.set_target_zone(targetzone->getName().toStdString());
+                eventOthers.set_target_zone(targetzone->getStdName());
             }
             eventOthers.set_y(yCoord);
             eventOthers.set_face_down(faceDown);
@@ -441,18 +447,17 @@ void Server_AbstractPlayer::onCardBeingMoved(GameEventStorage &ges,
 {
     Server_Card *card = cardStruct.card;
     const CardToMove *thisCardProperties = cardStruct.cardToMove;
+    Server_CardZone *attrZone = getZone(targetzone->getStdName());
 
     // set card to be tapped
     if (thisCardProperties->tapped()) {
-        setCardAttrHelper(ges, targetzone->getPlayer()->getPlayerId(), targetzone->getName(), card->getId(), AttrTapped,
-                          "1");
+        setCardAttrHelper(ges, targetzone->getPlayer()->getPlayerId(), attrZone, card->getId(), AttrTapped, "1");
     }
 
     // set card pt
     QString ptString = QString::fromStdString(thisCardProperties->pt());
     if (!ptString.isEmpty()) {
-        setCardAttrHelper(ges, targetzone->getPlayer()->getPlayerId(), targetzone->getName(), card->getId(), AttrPT,
-                          ptString);
+        setCardAttrHelper(ges, targetzone->getPlayer()->getPlayerId(), attrZone, card->getId(), AttrPT, ptString);
     }
 
     // If card is transferring to a different player, leave an annotation of who actually "owns" the card
@@ -461,7 +466,7 @@ void Server_AbstractPlayer::onCardBeingMoved(GameEventStorage &ges,
         const auto &ownerAnnotation = "Owner: " + QString::fromStdString(startzone->getPlayer()->getUserInfo()->name());
         const auto &newAnnotation =
             priorAnnotation.isEmpty() ? ownerAnnotation : ownerAnnotation + "\n\n" + priorAnnotation;
-        setCardAttrHelper(ges, targetzone->getPlayer()->getPlayerId(), targetzone->getName(), card->getId(),
+        setCardAttrHelper(ges, targetzone->getPlayer()->getPlayerId(), attrZone, card->getId(),
                           AttrAnnotation, newAnnotation, card);
     }
 }
@@ -473,7 +478,7 @@ void Server_AbstractPlayer::revealTopCardIfNeeded(Server_CardZone *zone, GameEve
     }
     if (zone->getAlwaysRevealTopCard()) {
         Event_RevealCards revealEvent;
-        revealEvent.set_zone_name(zone->getName().toStdString());
+        revealEvent.set_zone_name(zone->getStdName());
         revealEvent.add_card_id(0);
         zone->getCards().first()->getInfo(revealEvent.add_cards());
 
@@ -483,12 +488,12 @@ void Server_AbstractPlayer::revealTopCardIfNeeded(Server_CardZone *zone, GameEve
     if (zone->getAlwaysLookAtTopCard()) {
         Event_DumpZone dumpEvent;
         dumpEvent.set_zone_owner_id(playerId);
-        dumpEvent.set_zone_name(zone->getName().toStdString());
+        dumpEvent.set_zone_name(zone->getStdName());
         dumpEvent.set_number_cards(1);
         ges.enqueueGameEvent(dumpEvent, playerId, GameEventStorageItem::SendToOthers);
 
         Event_RevealCards revealEvent;
-        revealEvent.set_zone_name(zone->getName().toStdString());
+        revealEvent.set_zone_name(zone->getStdName());
         revealEvent.set_number_of_cards(1);
         revealEvent.add_card_id(0);
         zone->getCards().first()->getInfo(revealEvent.add_cards());
@@ -516,13 +521,12 @@ void Server_AbstractPlayer::unattachCard(GameEventStorage &ges, Server_Card *car
 
 Response::ResponseCode Server_AbstractPlayer::setCardAttrHelper(GameEventStorage &ges,
                                                                 int targetPlayerId,
-                                                                const QString &zoneName,
+                                                                Server_CardZone *zone,
                                                                 int cardId,
                                                                 CardAttribute attribute,
                                                                 const QString &attrValue,
                                                                 Server_Card *unzonedCard)
 {
-    Server_CardZone *zone = getZones().value(zoneName);
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -551,7 +555,7 @@ Response::ResponseCode Server_AbstractPlayer::setCardAttrHelper(GameEventStorage
     }
 
     Event_SetCardAttr event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getStdName());
     if (cardId != -1) {
         event.set_card_id(cardId);
     }
@@ -580,7 +584,7 @@ Server_AbstractPlayer::cmdConcede(const Command_Concede & /*cmd*/, ResponseConta
 
     // Return cards to their rightful owners before conceding the game
     static const QRegularExpression ownerRegex{"Owner: ?([^\n]+)"};
-    for (const auto &card : zones.value("table")->getCards()) {
+    for (const auto &card : getZone(ZoneId::Table)->getCards()) {
         if (card == nullptr) {
             continue;
         }
@@ -605,8 +609,8 @@ Server_AbstractPlayer::cmdConcede(const Command_Concede & /*cmd*/, ResponseConta
                 continue;
             }
 
-            const auto &startZone = zones.value("table");
-            const auto &targetZone = player->getZones().value("table");
+            const auto &startZone = getZone(ZoneId::Table);
+            const auto &targetZone = player->getZone(ZoneId::Table);
 
             if (startZone == nullptr || targetZone == nullptr) {
                 continue;
@@ -701,10 +705,13 @@ Server_AbstractPlayer::cmdRollDie(const Command_RollDie &cmd, ResponseContainer
     const auto validatedDiceToRoll =
         static_cast<int>(std::min(std::max(cmd.count(), MINIMUM_DICE_TO_ROLL), MAXIMUM_DICE_TO_ROLL));
 
+    unsigned int rolls[MAXIMUM_DICE_TO_ROLL];
+    rng->fill(std::span(rolls, validatedDiceToRoll), 1, validatedSides);
+
     Event_RollDie event;
     event.set_sides(validatedSides);
     for (auto i = 0; i < validatedDiceToRoll; ++i) {
-        const auto roll = rng->rand(1, validatedSides);
+        const auto roll = rolls[i];
         if (i == 0) {
             // Backwards compatibility
             event.set_value(roll);
@@ -730,7 +737,7 @@ Server_AbstractPlayer::cmdMoveCard(const Command_MoveCard &cmd, ResponseContaine
     if (!startPlayer) {
         return Response::RespNameNotFound;
     }
-    Server_CardZone *startZone = startPlayer->getZones().value(nameFromStdString(cmd.start_zone()));
+    Server_CardZone *startZone = startPlayer->getZone(cmd.start_zone());
     if (!startZone) {
         return Response::RespNameNotFound;
     }
@@ -743,7 +750,7 @@ Server_AbstractPlayer::cmdMoveCard(const Command_MoveCard &cmd, ResponseContaine
     if (!targetPlayer) {
         return Response::RespNameNotFound;
     }
-    Server_CardZone *targetZone = targetPlayer->getZones().value(nameFromStdString(cmd.target_zone()));
+    Server_CardZone *targetZone = targetPlayer->getZone(cmd.target_zone());
     if (!targetZone) {
         return Response::RespNameNotFound;
     }
@@ -770,7 +777,7 @@ Server_AbstractPlayer::cmdFlipCard(const Command_FlipCard &cmd, ResponseContaine
         return Response::RespContextError;
     }
 
-    Server_CardZone *zone = zones.value(nameFromStdString(cmd.zone()));
+    Server_CardZone *zone = getZone(cmd.zone());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -791,7 +798,7 @@ Server_AbstractPlayer::cmdFlipCard(const Command_FlipCard &cmd, ResponseContaine
     card->setFaceDown(faceDown);
 
     Event_FlipCard event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getStdName());
     event.set_card_id(card->getId());
     if (!faceDown) {
         event.set_card_name(card->getName().toStdString());
@@ -802,7 +809,7 @@ Server_AbstractPlayer::cmdFlipCard(const Command_FlipCard &cmd, ResponseContaine
 
     QString ptString = nameFromStdString(cmd.pt());
     if (!ptString.isEmpty() && !faceDown) {
-        setCardAttrHelper(ges, playerId, zone->getName(), card->getId(), AttrPT, ptString);
+        setCardAttrHelper(ges, playerId, zone, card->getId(), AttrPT, ptString);
     }
 
     return Response::RespOk;
@@ -818,7 +825,7 @@ Server_AbstractPlayer::cmdAttachCard(const Command_AttachCard &cmd, ResponseCont
         return Response::RespContextError;
     }
 
-    Server_CardZone *startzone = zones.value(nameFromStdString(cmd.start_zone()));
+    Server_CardZone *startzone = getZone(cmd.start_zone());
     if (!startzone) {
         return Response::RespNameNotFound;
     }
@@ -841,7 +848,7 @@ Server_AbstractPlayer::cmdAttachCard(const Command_AttachCard &cmd, ResponseCont
         return Response::RespContextError;
     }
     if (targetPlayer) {
-        targetzone = targetPlayer->getZones().value(nameFromStdString(cmd.target_zone()));
+        targetzone = targetPlayer->getZone(cmd.target_zone());
     }
     if (targetzone) {
         // This is currently enough to make sure cards don't get attached to a card that is not on the table.
@@ -867,21 +874,11 @@ Server_AbstractPlayer::cmdAttachCard(const Command_AttachCard &cmd, ResponseCont
         return Response::RespContextError;
     }
 
-    for (auto *player : game->getPlayers()) {
-        QList<Server_Arrow *> _arrows = player->getArrows().values();
-        QList<Server_Arrow *> toDelete;
-        for (auto a : _arrows) {
-            auto *tCard = qobject_cast<Server_Card *>(a->getTargetItem());
-            if ((tCard == card) || (a->getStartCard() == card)) {
-                toDelete.append(a);
-            }
-        }
-        for (auto &i : toDelete) {
-            Event_DeleteArrow event;
-            event.set_arrow_id(i->getId());
-            ges.enqueueGameEvent(event, player->getPlayerId());
-            player->deleteArrow(i->getId());
-        }
+    for (const auto &arrow : game->getArrowsOf(card)) {
+        Event_DeleteArrow event;
+        event.set_arrow_id(arrow.second->getId());
+        ges.enqueueGameEvent(event, arrow.first->getPlayerId());
+        arrow.first->deleteArrow(arrow.second->getId());
     }
 
     if (targetCard) {
@@ -926,7 +923,7 @@ Server_AbstractPlayer::cmdCreateToken(const Command_CreateToken &cmd, ResponseCo
         return Response::RespContextError;
     }
 
-    Server_CardZone *zone = zones.value(nameFromStdString(cmd.zone()));
+    Server_CardZone *zone = getZone(cmd.zone());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -936,7 +933,7 @@ Server_AbstractPlayer::cmdCreateToken(const Command_CreateToken &cmd, ResponseCo
 
     Server_Card *targetCard = nullptr;
     if (cmd.has_target_card_id()) {
-        Server_CardZone *targetZone = zones.value(nameFromStdString(cmd.target_zone()));
+        Server_CardZone *targetZone = getZone(cmd.target_zone());
         if (targetZone) {
             targetCard = targetZone->getCard(cmd.target_card_id());
             if (targetCard && cmd.target_mode() == Command_CreateToken::TRANSFORM_INTO) {
@@ -957,7 +954,7 @@ Server_AbstractPlayer::cmdCreateToken(const Command_CreateToken &cmd, ResponseCo
                 targetZone->removeCard(targetCard);
 
                 Event_DestroyCard event;
-                event.set_zone_name(targetZone->getName().toStdString());
+                event.set_zone_name(targetZone->getStdName());
                 event.set_card_id(static_cast<::google::protobuf::uint32>(cmd.target_card_id()));
                 ges.enqueueGameEvent(event, playerId);
             }
@@ -977,7 +974,7 @@ Server_AbstractPlayer::cmdCreateToken(const Command_CreateToken &cmd, ResponseCo
         yCoord = 0;
     }
 
-    auto *card = new Server_Card({cardName, cardProviderId}, newCardId(), xCoord, yCoord);
+    auto *card = new (game->getObjectPool()) Server_Card({cardName, cardProviderId}, newCardId(), xCoord, yCoord);
     card->moveToThread(thread());
     // Client should already prevent face-down tokens from having attributes; this just an extra server-side check
     if (!cmd.face_down()) {
@@ -1012,7 +1009,7 @@ Server_AbstractPlayer::cmdCreateToken(const Command_CreateToken &cmd, ResponseCo
         case Command_CreateToken::TRANSFORM_INTO: {
             // Copy attributes that are not present in the CreateToken event
             Event_SetCardAttr event;
-            event.set_zone_name(card->getZone()->getName().toStdString());
+            event.set_zone_name(card->getZone()->getStdName());
             event.set_card_id(card->getId());
 
             if (card->getTapped() != targetCard->getTapped()) {
@@ -1041,7 +1038,7 @@ Server_AbstractPlayer::cmdCreateToken(const Command_CreateToken &cmd, ResponseCo
                 i.next();
 
                 Event_SetCardCounter _event;
-                _event.set_zone_name(card->getZone()->getName().toStdString());
+                _event.set_zone_name(card->getZone()->getStdName());
                 _event.set_card_id(card->getId());
 
                 card->setCounter(i.key(), i.value(), &_event);
@@ -1066,48 +1063,43 @@ Server_AbstractPlayer::cmdCreateToken(const Command_CreateToken &cmd, ResponseCo
             }
 
             // Copy Arrows
-            for (auto *player : game->getPlayers().values()) {
-                QList<int> changedArrowIds;
-                for (Server_Arrow *arrow : player->getArrows()) {
-                    bool sendGameEvent = false;
-                    const auto *startCard = arrow->getStartCard();
-                    if (startCard == targetCard) {
-                        sendGameEvent = true;
-                        arrow->setStartCard(card);
-                        startCard = card;
-                    }
-                    const auto *targetItem = arrow->getTargetItem();
-                    if (targetItem == targetCard) {
-                        sendGameEvent = true;
-                        arrow->setTargetItem(card);
-                        targetItem = card;
-                    }
-                    if (sendGameEvent) {
-                        Event_CreateArrow _event;
-                        ServerInfo_Arrow *arrowInfo = _event.mutable_arrow_info();
-                        changedArrowIds.append(arrow->getId());
-                        int id = player->newArrowId();
-                        arrow->setId(id);
-                        arrowInfo->set_id(id);
-                        arrowInfo->set_start_player_id(player->getPlayerId());
-                        arrowInfo->set_start_zone(startCard->getZone()->getName().toStdString());
-                        arrowInfo->set_start_card_id(startCard->getId());
-                        const auto *arrowTargetPlayer = qobject_cast<const Server_AbstractPlayer *>(targetItem);
-                        if (arrowTargetPlayer != nullptr) {
-                            arrowInfo->set_target_player_id(arrowTargetPlayer->getPlayerId());
-                        } else {
-                            const auto *arrowTargetCard = qobject_cast<const Server_Card *>(targetItem);
-                            arrowInfo->set_target_player_id(arrowTargetCard->getZone()->getPlayer()->getPlayerId());
-                            arrowInfo->set_target_zone(arrowTargetCard->getZone()->getName().toStdString());
-                            arrowInfo->set_target_card_id(arrowTargetCard->getId());
-                        }
-                        arrowInfo->mutable_arrow_color()->CopyFrom(arrow->getColor());
-                        ges.enqueueGameEvent(_event, player->getPlayerId());
-                    }
+            for (const auto &arrowRef : game->getArrowsOf(targetCard)) {
+                Server_AbstractPlayer *player = arrowRef.first;
+                Server_Arrow *arrow = arrowRef.second;
+                game->removeArrowFromIndex(player, arrow);
+                const auto *startCard = arrow->getStartCard();
+                if (startCard == targetCard) {
+                    arrow->setStartCard(card);
+                    startCard = card;
+                }
+                const auto *targetItem = arrow->getTargetItem();
+                if (targetItem == targetCard) {
+                    arrow->setTargetItem(card);
+                    targetItem = card;
                 }
-                for (int id : changedArrowIds) {
-                    player->updateArrowId(id);
+                game->addArrowToIndex(player, arrow);
+
+                Event_CreateArrow _event;
+                ServerInfo_Arrow *arrowInfo = _event.mutable_arrow_info();
+                const int oldId = arrow->getId();
+                int id = player->newArrowId();
+                arrow->setId(id);
+                player->updateArrowId(oldId);
+                arrowInfo->set_id(id);
+                arrowInfo->set_start_player_id(player->getPlayerId());
+                arrowInfo->set_start_zone(startCard->getZone()->getStdName());
+                arrowInfo->set_start_card_id(startCard->getId());
+                const auto *arrowTargetPlayer = qobject_cast<const Server_AbstractPlayer *>(targetItem);
+                if (arrowTargetPlayer != nullptr) {
+                    arrowInfo->set_target_player_id(arrowTargetPlayer->getPlayerId());
+                } else {
+                    const auto *arrowTargetCard = qobject_cast<const Server_Card *>(targetItem);
+                    arrowInfo->set_target_player_id(arrowTargetCard->getZone()->getPlayer()->getPlayerId());
+                    arrowInfo->set_target_zone(arrowTargetCard->getZone()->getStdName());
+                    arrowInfo->set_target_card_id(arrowTargetCard->getId());
                 }
+                arrowInfo->mutable_arrow_color()->CopyFrom(arrow->getColor());
+                ges.enqueueGameEvent(_event, player->getPlayerId());
             }
 
             targetCard->resetState();
@@ -1144,7 +1136,7 @@ void Server_AbstractPlayer::sendCreateTokenEvents(Server_CardZone *zone,
 
     // Event_CreateToken didn't use to have face_down field; send attribute event afterward for backwards compatibility
     Event_SetCardAttr event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getStdName());
     event.set_card_id(card->getId());
     event.set_attribute(AttrFaceDown);
     event.set_attr_value("1");
@@ -1166,12 +1158,11 @@ Server_AbstractPlayer::cmdCreateArrow(const Command_CreateArrow &cmd, ResponseCo
     if (!startPlayer || !targetPlayer) {
         return Response::RespNameNotFound;
     }
-    QString startZoneName = nameFromStdString(cmd.start_zone());
-    Server_CardZone *startZone = startPlayer->getZones().value(startZoneName);
+    Server_CardZone *startZone = startPlayer->getZone(cmd.start_zone());
     bool playerTarget = !cmd.has_target_zone();
     Server_CardZone *targetZone = nullptr;
     if (!playerTarget) {
-        targetZone = targetPlayer->getZones().value(nameFromStdString(cmd.target_zone()));
+        targetZone = targetPlayer->getZone(cmd.target_zone());
     }
     if (!startZone || (!targetZone && !playerTarget)) {
         return Response::RespNameNotFound;
@@ -1201,22 +1192,24 @@ Server_AbstractPlayer::cmdCreateArrow(const Command_CreateArrow &cmd, ResponseCo
         return Response::RespNameNotFound;
     }
 
-    for (Server_Arrow *temp : arrows) {
-        if ((temp->getStartCard() == startCard) && (temp->getTargetItem() == targetItem)) {
+    for (const auto &arrow : game->getArrowsOf(startCard)) {
+        if ((arrow.first == this) && (arrow.second->getStartCard() == startCard) &&
+            (arrow.second->getTargetItem() == targetItem)) {
             return Response::RespContextError;
         }
     }
 
     int currentPhase = game->getActivePhase();
     int deletionPhase = cmd.has_delete_in_phase() ? cmd.delete_in_phase() : currentPhase;
-    auto arrow = new Server_Arrow(newArrowId(), startCard, targetItem, cmd.arrow_color(), currentPhase, deletionPhase);
+    auto arrow = new (game->getObjectPool())
+        Server_Arrow(newArrowId(), startCard, targetItem, cmd.arrow_color(), currentPhase, deletionPhase);
     addArrow(arrow);
 
     Event_CreateArrow event;
     ServerInfo_Arrow *arrowInfo = event.mutable_arrow_info();
     arrowInfo->set_id(arrow->getId());
     arrowInfo->set_start_player_id(startPlayer->getPlayerId());
-    arrowInfo->set_start_zone(startZoneName.toStdString());
+    arrowInfo->set_start_zone(startZone->getStdName());
     arrowInfo->set_start_card_id(startCard->getId());
     arrowInfo->set_target_player_id(targetPlayer->getPlayerId());
     if (!playerTarget) {
@@ -1260,7 +1253,7 @@ Server_AbstractPlayer::cmdSetCardAttr(const Command_SetCardAttr &cmd, ResponseCo
         return Response::RespContextError;
     }
 
-    return setCardAttrHelper(ges, playerId, nameFromStdString(cmd.zone()), cmd.card_id(), cmd.attribute(),
+    return setCardAttrHelper(ges, playerId, getZone(cmd.zone()), cmd.card_id(), cmd.attribute(),
                              nameFromStdString(cmd.attr_value()));
 }
 
@@ -1275,7 +1268,7 @@ Response::ResponseCode Server_AbstractPlayer::cmdSetCardCounter(const Command_Se
         return Response::RespContextError;
     }
 
-    Server_CardZone *zone = zones.value(nameFromStdString(cmd.zone()));
+    Server_CardZone *zone = getZone(cmd.zone());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -1289,7 +1282,7 @@ Response::ResponseCode Server_AbstractPlayer::cmdSetCardCounter(const Command_Se
     }
 
     Event_SetCardCounter event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getStdName());
     event.set_card_id(card->getId());
     card->setCounter(cmd.counter_id(), cmd.counter_value(), &event);
     ges.enqueueGameEvent(event, playerId);
@@ -1308,7 +1301,7 @@ Response::ResponseCode Server_AbstractPlayer::cmdIncCardCounter(const Command_In
         return Response::RespContextError;
     }
 
-    Server_CardZone *zone = zones.value(nameFromStdString(cmd.zone()));
+    Server_CardZone *zone = getZone(cmd.zone());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -1325,7 +1318,7 @@ Response::ResponseCode Server_AbstractPlayer::cmdIncCardCounter(const Command_In
     card->setCounter(cmd.counter_id(), newValue);
 
     Event_SetCardCounter event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getStdName());
     event.set_card_id(card->getId());
     event.set_counter_id(cmd.counter_id());
     event.set_counter_value(newValue);
@@ -1345,7 +1338,7 @@ Server_AbstractPlayer::cmdDumpZone(const Command_DumpZone &cmd, ResponseContaine
     if (!otherPlayer) {
         return Response::RespNameNotFound;
     }
-    Server_CardZone *zone = otherPlayer->getZones().value(nameFromStdString(cmd.zone_name()));
+    Server_CardZone *zone = otherPlayer->getZone(cmd.zone_name());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -1358,7 +1351,7 @@ Server_AbstractPlayer::cmdDumpZone(const Command_DumpZone &cmd, ResponseContaine
 
     auto *re = new Response_DumpZone;
     ServerInfo_Zone *zoneInfo = re->mutable_zone_info();
-    zoneInfo->set_name(zone->getName().toStdString());
+    zoneInfo->set_name(zone->getStdName());
     zoneInfo->set_type(zone->getType());
     zoneInfo->set_with_coords(zone->hasCoords());
     zoneInfo->set_card_count(numberCards < cards.size() ? cards.size() : numberCards);
@@ -1395,7 +1388,7 @@ Server_AbstractPlayer::cmdDumpZone(const Command_DumpZone &cmd, ResponseContaine
 
             if (card->getParentCard()) {
                 cardInfo->set_attach_player_id(card->getParentCard()->getZone()->getPlayer()->getPlayerId());
-                cardInfo->set_attach_zone(card->getParentCard()->getZone()->getName().toStdString());
+                cardInfo->set_attach_zone(card->getParentCard()->getZone()->getStdName());
                 cardInfo->set_attach_card_id(card->getParentCard()->getId());
             }
         }
@@ -1405,7 +1398,7 @@ Server_AbstractPlayer::cmdDumpZone(const Command_DumpZone &cmd, ResponseContaine
 
         Event_DumpZone event;
         event.set_zone_owner_id(otherPlayer->getPlayerId());
-        event.set_zone_name(zone->getName().toStdString());
+        event.set_zone_name(zone->getStdName());
         event.set_number_cards(numberCards);
         event.set_is_reversed(cmd.is_reversed());
         ges.enqueueGameEvent(event, playerId);
@@ -1429,7 +1422,7 @@ Server_AbstractPlayer::cmdRevealCards(const Command_RevealCards &cmd, ResponseCo
         if (!otherPlayer)
             return Response::RespNameNotFound;
     }
-    Server_CardZone *zone = zones.value(nameFromStdString(cmd.zone_name()));
+    Server_CardZone *zone = getZone(cmd.zone_name());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -1468,7 +1461,7 @@ Server_AbstractPlayer::cmdRevealCards(const Command_RevealCards &cmd, ResponseCo
 
     Event_RevealCards eventOthers;
     eventOthers.set_grant_write_access(cmd.grant_write_access());
-    eventOthers.set_zone_name(zone->getName().toStdString());
+    eventOthers.set_zone_name(zone->getStdName());
     eventOthers.set_number_of_cards(cardsToReveal.size());
     for (auto cardId : cmd.card_id()) {
         eventOthers.add_card_id(cardId);
@@ -1506,7 +1499,7 @@ Server_AbstractPlayer::cmdRevealCards(const Command_RevealCards &cmd, ResponseCo
 
         if (card->getParentCard()) {
             cardInfo->set_attach_player_id(card->getParentCard()->getZone()->getPlayer()->getPlayerId());
-            cardInfo->set_attach_zone(card->getParentCard()->getZone()->getName().toStdString());
+            cardInfo->set_attach_zone(card->getParentCard()->getZone()->getStdName());
             cardInfo->set_attach_card_id(card->getParentCard()->getId());
         }
     }
@@ -1540,7 +1533,7 @@ Response::ResponseCode Server_AbstractPlayer::cmdChangeZoneProperties(const Comm
                                                                       ResponseContainer & /* rc */,
                                                                       GameEventStorage &ges)
 {
-    Server_CardZone *zone = zones.value(nameFromStdString(cmd.zone_name()));
+    Server_CardZone *zone = getZone(cmd.zone_name());
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -6,6 +6,7 @@
 
 #include <QMap>
 #include <QString>
+#include <libcockatrice/utility/zone_id.h>
 
 class CardToMove;
 class DeckList;
@@ -30,6 +31,7 @@ protected:
     DeckList *deck;
     bool sideboardLocked;
     QMap<QString, Server_CardZone *> zones;
+    Server_CardZone *zonesById[ZoneId::Count];
     bool readyStart;
     int nextCardId;
 
@@ -68,6 +70,12 @@ public:
     {
         return zones;
     }
+    Server_CardZone *getZone(ZoneId::Id id) const
+    {
+        return id == ZoneId::Other ? nullptr : zonesById[id];
+    }
+    /// Looks up a zone by the name sent in a command, without converting it for the zones every player has.
+    Server_CardZone *getZone(const std::string &name) const;
     const QMap<int, Server_Arrow *> &getArrows() const
     {
         return arrows;
@@ -102,7 +110,7 @@ public:
     void unattachCard(GameEventStorage &ges, Server_Card *card);
     Response::ResponseCode setCardAttrHelper(GameEventStorage &ges,
                                              int targetPlayerId,
-                                             const QString &zone,
+                                             Server_CardZone *zone,
                                              int cardId,
                                              CardAttribute attribute,
                                              const QString &attrValue,
@@ -1,13 +1,15 @@
 #ifndef SERVER_ARROW_H
 #define SERVER_ARROW_H
 
+#include "server_game_object_pool.h"
+
 #include <libcockatrice/protocol/pb/color.pb.h>
 
 class Server_Card;
 class Server_ArrowTarget;
 class ServerInfo_Arrow;
 
-class Server_Arrow
+class Server_Arrow : public Server_GameObject
 {
 private:
     int id;
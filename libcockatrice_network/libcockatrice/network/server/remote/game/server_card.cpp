@@ -28,11 +28,20 @@
 #include <libcockatrice/protocol/pb/serverinfo_card.pb.h>
 
 Server_Card::Server_Card(const CardRef &cardRef, int _id, int _coord_x, int _coord_y, Server_CardZone *_zone)
-    : zone(_zone), id(_id), coord_x(_coord_x), coord_y(_coord_y), cardRef(cardRef), tapped(false), attacking(false),
-      facedown(false), destroyOnZoneChange(false), doesntUntap(false), parentCard(0), stashedCard(nullptr)
+    : zone(_zone), zoneSlot(0), id(_id), coord_x(_coord_x), coord_y(_coord_y), cardRef(cardRef), tapped(false),
+      attacking(false), facedown(false), destroyOnZoneChange(false), doesntUntap(false), parentCard(0),
+      stashedCard(nullptr)
 {
 }
 
+void Server_Card::setId(int _id)
+{
+    const int oldId = id;
+    id = _id;
+    if (zone)
+        zone->updateCardId(this, oldId);
+}
+
 Server_Card::~Server_Card()
 {
     // setParentCard(0) leads to the item being removed from our list, so we can't iterate properly
@@ -168,7 +177,7 @@ void Server_Card::getInfo(ServerInfo_Card *info)
 
     if (parentCard) {
         info->set_attach_player_id(parentCard->getZone()->getPlayer()->getPlayerId());
-        info->set_attach_zone(parentCard->getZone()->getName().toStdString());
+        info->set_attach_zone(parentCard->getZone()->getStdName());
         info->set_attach_card_id(parentCard->getId());
     }
 }
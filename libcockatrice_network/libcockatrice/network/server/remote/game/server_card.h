@@ -21,6 +21,7 @@
 #define SERVER_CARD_H
 
 #include "server_arrowtarget.h"
+#include "server_game_object_pool.h"
 
 #include <QMap>
 #include <QString>
@@ -32,11 +33,14 @@ class Server_CardZone;
 class Event_SetCardCounter;
 class Event_SetCardAttr;
 
-class Server_Card : public Server_ArrowTarget
+class Server_Card : public Server_ArrowTarget, public Server_GameObject
 {
     Q_OBJECT
+    friend class Server_CardZone;
+
 private:
     Server_CardZone *zone;
+    int zoneSlot; // the position in the zone, kept up to date by Server_CardZone
     int id;
     int coord_x, coord_y;
     CardRef cardRef;
@@ -140,10 +144,7 @@ public:
         return attachedCards;
     }
 
-    void setId(int _id)
-    {
-        id = _id;
-    }
+    void setId(int _id);
     void setCoords(int x, int y)
     {
         coord_x = x;
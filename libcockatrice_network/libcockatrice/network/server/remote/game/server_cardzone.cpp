@@ -31,8 +31,9 @@ Server_CardZone::Server_CardZone(Server_AbstractPlayer *_player,
                                  const QString &_name,
                                  bool _has_coords,
                                  ServerInfo_Zone::ZoneType _type)
-    : player(_player), name(_name), has_coords(_has_coords), type(_type), cardsBeingLookedAt(0),
-      alwaysRevealTopCard(false), alwaysLookAtTopCard(false)
+    : player(_player), name(_name), id(ZoneId::fromName(_name)), stdName(_name.toStdString()),
+      has_coords(_has_coords), type(_type), cardsBeingLookedAt(0), alwaysRevealTopCard(false),
+      alwaysLookAtTopCard(false), positionBase(0)
 {
 }
 
@@ -61,10 +62,9 @@ void Server_CardZone::shuffle(int start, int end)
     if (start < 0 || end < 0 || start >= cards.size() || end >= cards.size())
         return;
 
-    for (int i = end; i > start; i--) {
-        int j = rng->rand(start, i);
-        cards.swapItemsAt(j, i);
-    }
+    rng->shuffle(cards.begin() + start, cards.begin() + end + 1);
+    for (int i = start; i <= end; ++i)
+        cards[i]->zoneSlot = positionBase + i;
     playersWithWritePermission.clear();
 }
 
@@ -118,6 +118,54 @@ void Server_CardZone::insertCardIntoCoordMap(Server_Card *card, int x, int y)
     }
 }
 
+void Server_CardZone::insertCardAt(int index, Server_Card *card)
+{
+    if (index < cards.size() / 2) {
+        // all positions grow by one, except for the cards in front of the new one
+        --positionBase;
+        for (int i = 0; i < index; ++i)
+            --cards[i]->zoneSlot;
+    } else {
+        for (int i = index; i < cards.size(); ++i)
+            ++cards[i]->zoneSlot;
+    }
+    cards.insert(index, card);
+    card->zoneSlot = positionBase + index;
+    cardsById.insert(card->getId(), card);
+}
+
+void Server_CardZone::removeCardAt(int index)
+{
+    Server_Card *card = cards.takeAt(index);
+    auto byId = cardsById.find(card->getId());
+    if (byId != cardsById.end() && *byId == card)
+        cardsById.erase(byId);
+
+    if (index < cards.size() / 2) {
+        // all positions shrink by one, except for the cards in front of the removed one
+        ++positionBase;
+        for (int i = 0; i < index; ++i)
+            ++cards[i]->zoneSlot;
+    } else {
+        for (int i = index; i < cards.size(); ++i)
+            --cards[i]->zoneSlot;
+    }
+}
+
+int Server_CardZone::getPosition(const Server_Card *card) const
+{
+    return card->zoneSlot - positionBase;
+}
+
+void Server_CardZone::updateCardId(Server_Card *card, int oldId)
+{
+    auto byId = cardsById.find(oldId);
+    if (byId == cardsById.end() || *byId != card)
+        return;
+    cardsById.erase(byId);
+    cardsById.insert(card->getId(), card);
+}
+
 int Server_CardZone::removeCard(Server_Card *card)
 {
     bool wasLookedAt;
@@ -126,12 +174,12 @@ int Server_CardZone::removeCard(Server_Card *card)
 
 int Server_CardZone::removeCard(Server_Card *card, bool &wasLookedAt)
 {
-    int index = cards.indexOf(card);
+    int index = getPosition(card);
     wasLookedAt = isCardAtPosLookedAt(index);
     if (wasLookedAt && cardsBeingLookedAt > 0) {
         cardsBeingLookedAt -= 1;
     }
-    cards.removeAt(index);
+    removeCardAt(index);
     if (has_coords) {
         removeCardFromCoordMap(card, card->getX(), card->getY());
     }
@@ -142,32 +190,26 @@ int Server_CardZone::removeCard(Server_Card *card, bool &wasLookedAt)
 
 Server_Card *Server_CardZone::getCard(int id, int *position, bool remove)
 {
+    Server_Card *tmp;
+    int index;
     if (type != ServerInfo_Zone::HiddenZone) {
-        for (int i = 0; i < cards.size(); ++i) {
-            Server_Card *tmp = cards[i];
-            if (tmp->getId() == id) {
-                if (position)
-                    *position = i;
-                if (remove) {
-                    cards.removeAt(i);
-                    tmp->setZone(nullptr);
-                }
-                return tmp;
-            }
-        }
-        return nullptr;
+        tmp = cardsById.value(id);
+        if (!tmp)
+            return nullptr;
+        index = getPosition(tmp);
     } else {
         if ((id >= cards.size()) || (id < 0))
             return nullptr;
-        Server_Card *tmp = cards[id];
-        if (position)
-            *position = id;
-        if (remove) {
-            cards.removeAt(id);
-            tmp->setZone(nullptr);
-        }
-        return tmp;
+        tmp = cards[id];
+        index = id;
+    }
+    if (position)
+        *position = index;
+    if (remove) {
+        removeCardAt(index);
+        tmp->setZone(nullptr);
     }
+    return tmp;
 }
 
 bool Server_CardZone::isCardAtPosLookedAt(int pos) const
@@ -284,14 +326,14 @@ void Server_CardZone::insertCard(Server_Card *card, int x, int y)
 {
     if (hasCoords()) {
         card->setCoords(x, y);
-        cards.append(card);
+        insertCardAt(cards.size(), card);
         insertCardIntoCoordMap(card, x, y);
     } else {
         card->setCoords(0, 0);
         if (0 <= x && x < cards.length()) {
-            cards.insert(x, card);
+            insertCardAt(x, card);
         } else {
-            cards.append(card);
+            insertCardAt(cards.size(), card);
         }
     }
     card->setZone(this);
@@ -302,6 +344,8 @@ void Server_CardZone::clear()
     for (auto card : cards)
         delete card;
     cards.clear();
+    cardsById.clear();
+    positionBase = 0;
     coordinateMap.clear();
     freePilesMap.clear();
     freeSpaceMap.clear();
@@ -20,10 +20,12 @@
 #ifndef SERVER_CARDZONE_H
 #define SERVER_CARDZONE_H
 
+#include <QHash>
 #include <QMap>
 #include <QSet>
 #include <QString>
 #include <libcockatrice/protocol/pb/serverinfo_zone.pb.h>
+#include <libcockatrice/utility/zone_id.h>
 
 class Server_Card;
 class Server_AbstractPlayer;
@@ -36,6 +38,8 @@ class Server_CardZone
 private:
     Server_AbstractPlayer *player;
     QString name;
+    ZoneId::Id id;
+    std::string stdName; // the name as sent in events
     bool has_coords; // having coords means this zone has x and y coordinates
     ServerInfo_Zone::ZoneType type;
     int cardsBeingLookedAt;
@@ -43,6 +47,13 @@ private:
     bool alwaysRevealTopCard;
     bool alwaysLookAtTopCard;
     QList<Server_Card *> cards;
+    // Cards by id for getCard(). A card's position is its zoneSlot minus positionBase; inserting and removing
+    // renumbers whichever side of the position has fewer cards, so drawing from the top or appending costs O(1).
+    QHash<int, Server_Card *> cardsById;
+    int positionBase;
+    void insertCardAt(int index, Server_Card *card);
+    void removeCardAt(int index);
+    [[nodiscard]] int getPosition(const Server_Card *card) const;
     QMap<int, QMap<int, Server_Card *>> coordinateMap; // y -> (x -> card)
     QMap<int, QMultiMap<QString, int>> freePilesMap;   // y -> (cardName -> x)
     QMap<int, int> freeSpaceMap;                       // y -> x
@@ -63,6 +74,8 @@ public:
     int removeCard(Server_Card *card);
     int removeCard(Server_Card *card, bool &wasLookedAt);
     Server_Card *getCard(int id, int *position = nullptr, bool remove = false);
+    /// Called by Server_Card::setId() while the card is in this zone.
+    void updateCardId(Server_Card *card, int oldId);
 
     [[nodiscard]] int getCardsBeingLookedAt() const
     {
@@ -85,6 +98,19 @@ public:
     {
         return name;
     }
+    [[nodiscard]] ZoneId::Id getId() const
+    {
+        return id;
+    }
+    [[nodiscard]] const std::string &getStdName() const
+    {
+        return stdName;
+    }
+    /// Whether @p other is the zone of the same name, possibly of another player.
+    [[nodiscard]] bool hasSameName(const Server_CardZone *other) const
+    {
+        return id == other->id && (id != ZoneId::Other || name == other->name);
+    }
     [[nodiscard]] Server_AbstractPlayer *getPlayer() const
     {
         return player;
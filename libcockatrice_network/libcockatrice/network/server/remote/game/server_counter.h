@@ -20,12 +20,14 @@
 #ifndef SERVER_COUNTER_H
 #define SERVER_COUNTER_H
 
+#include "server_game_object_pool.h"
+
 #include <QString>
 #include <libcockatrice/protocol/pb/color.pb.h>
 
 class ServerInfo_Counter;
 
-class Server_Counter
+class Server_Counter : public Server_GameObject
 {
 protected:
     int id;
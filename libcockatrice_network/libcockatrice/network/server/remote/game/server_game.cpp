@@ -21,17 +21,20 @@
 
 #include "../server.h"
 #include "../server_database_interface.h"
+#include "../server_message_frame.h"
 #include "../server_protocolhandler.h"
 #include "../server_room.h"
 #include "server_abstract_player.h"
 #include "server_arrow.h"
 #include "server_card.h"
 #include "server_cardzone.h"
+#include "server_game_object_pool.h"
 #include "server_player.h"
+#include "server_replay_writer.h"
 #include "server_spectator.h"
 
 #include <QDebug>
-#include <QTimer>
+#include <algorithm>
 #include <google/protobuf/descriptor.h>
 #include <libcockatrice/deck_list/deck_list.h>
 #include <libcockatrice/protocol/pb/context_connection_state_changed.pb.h>
@@ -48,7 +51,6 @@
 #include <libcockatrice/protocol/pb/event_replay_added.pb.h>
 #include <libcockatrice/protocol/pb/event_set_active_phase.pb.h>
 #include <libcockatrice/protocol/pb/event_set_active_player.pb.h>
-#include <libcockatrice/protocol/pb/game_replay.pb.h>
 
 Server_Game::Server_Game(const ServerInfo_User &_creatorInfo,
                          int _gameId,
@@ -72,21 +74,22 @@ Server_Game::Server_Game(const ServerInfo_User &_creatorInfo,
       spectatorsNeedPassword(_spectatorsNeedPassword), spectatorsCanTalk(_spectatorsCanTalk),
       spectatorsSeeEverything(_spectatorsSeeEverything), startingLifeTotal(_startingLifeTotal),
       shareDecklistsOnLoad(_shareDecklistsOnLoad), inactivityCounter(0), startTimeOfThisGame(0), secondsElapsed(0),
-      firstGameStarted(false), turnOrderReversed(false), startTime(QDateTime::currentDateTime()), pingClock(nullptr),
-      gameMutex()
+      firstGameStarted(false), turnOrderReversed(false), startTime(QDateTime::currentDateTime()), pingTimerId(0),
+      pingStopped(false), gameMutex()
 {
-    currentReplay = new GameReplay;
-    currentReplay->set_replay_id(room->getServer()->getDatabaseInterface()->getNextReplayId());
+    objectPool = new Server_GameObjectPool;
     description = _description.simplified();
 
     connect(this, &Server_Game::sigStartGameIfReady, this, &Server_Game::doStartGameIfReady, Qt::QueuedConnection);
 
-    getInfo(*currentReplay->mutable_game_info());
+    ServerInfo_Game replayGameInfo;
+    getInfo(replayGameInfo);
+    currentReplay = new Server_ReplayWriter(room->getServer()->getDatabaseInterface()->getNextReplayId(),
+                                            replayGameInfo, room->getServer()->getReplayBufferSize());
 
     if (room->getServer()->getGameShouldPing()) {
-        pingClock = new QTimer(this);
-        connect(pingClock, &QTimer::timeout, this, &Server_Game::pingClockTimeout);
-        pingClock->start(1000);
+        pingClock = room->getServer()->getTimerWheel(Server_TimerWheel::SecondClock);
+        schedulePing();
     }
 }
 
@@ -95,6 +98,9 @@ Server_Game::~Server_Game()
     room->gamesLock.lockForWrite();
     gameMutex.lock();
 
+    // a ping that is already running sees this and doesn't schedule the next one
+    pingStopped = true;
+    const quint64 lastPingTimerId = pingTimerId;
     gameClosed = true;
     sendGameEventContainer(prepareGameEvent(Event_GameClosed(), -1));
     for (auto *participant : participants.values()) {
@@ -108,31 +114,32 @@ Server_Game::~Server_Game()
 
     gameMutex.unlock();
     room->gamesLock.unlock();
-    currentReplay->set_duration_seconds(secondsElapsed - startTimeOfThisGame);
+    currentReplay->setDurationSeconds(secondsElapsed - startTimeOfThisGame);
     replayList.append(currentReplay);
+    // hands the replays over to the database interface
     storeGameInformation();
-
-    for (auto *replay : replayList) {
-        delete replay;
-    }
     replayList.clear();
 
     room = nullptr;
     currentReplay = nullptr;
     creatorInfo = nullptr;
 
-    if (pingClock) {
-        delete pingClock;
-        pingClock = nullptr;
-    }
+    // waits for a ping that has already been taken off the wheel, it must not touch the game once it's gone
+    if (lastPingTimerId)
+        pingClock->cancel(lastPingTimerId);
 
-    qDebug() << "Server_Game destructor: gameId=" << gameId;
+    const Server_GameObjectPool::Stats poolStats = objectPool->getStats();
+    qDebug() << "Server_Game destructor: gameId=" << gameId << "objects allocated=" << poolStats.allocations
+             << "peak=" << poolStats.peakLiveObjects << "still alive=" << poolStats.liveObjects
+             << "pool bytes=" << poolStats.reservedBytes;
+    objectPool->release();
+    objectPool = nullptr;
     deleteLater();
 }
 
 void Server_Game::storeGameInformation()
 {
-    const ServerInfo_Game &gameInfo = replayList.first()->game_info();
+    const ServerInfo_Game &gameInfo = replayList.first()->getGameInfo();
 
     Event_ReplayAdded replayEvent;
     ServerInfo_ReplayMatch *replayMatchInfo = replayEvent.mutable_match_info();
@@ -153,18 +160,19 @@ void Server_Game::storeGameInformation()
 
     for (int i = 0; i < replayList.size(); ++i) {
         ServerInfo_Replay *replayInfo = replayMatchInfo->add_replay_list();
-        replayInfo->set_replay_id(replayList[i]->replay_id());
+        replayInfo->set_replay_id(replayList[i]->getReplayId());
         replayInfo->set_replay_name(gameInfo.description());
-        replayInfo->set_duration(replayList[i]->duration_seconds());
+        replayInfo->set_duration(replayList[i]->getDurationSeconds());
     }
 
     SessionEvent *sessionEvent = Server_ProtocolHandler::prepareSessionEvent(replayEvent);
+    const ServerMessageFrame frame(*sessionEvent);
     Server *server = room->getServer();
     server->clientsLock.lockForRead();
     for (auto userName : allPlayersEver + allSpectatorsEver) {
         Server_AbstractUserInterface *userHandler = server->findUser(userName);
         if (userHandler && server->getStoreReplaysEnabled())
-            userHandler->sendProtocolItem(*sessionEvent);
+            userHandler->sendProtocolItem(frame);
     }
     server->clientsLock.unlock();
     delete sessionEvent;
@@ -172,9 +180,22 @@ void Server_Game::storeGameInformation()
     if (server->getStoreReplaysEnabled()) {
         server->getDatabaseInterface()->storeGameInformation(room->getName(), _gameTypes, gameInfo, allPlayersEver,
                                                              allSpectatorsEver, replayList);
+    } else {
+        qDeleteAll(replayList);
     }
 }
 
+void Server_Game::schedulePing()
+{
+    pingTimerId = pingClock->scheduleAt(pingClock->getCurrentTick() + 1, [this] {
+        QMutexLocker locker(&gameMutex);
+        if (pingStopped)
+            return;
+        schedulePing();
+        pingClockTimeout();
+    });
+}
+
 void Server_Game::pingClockTimeout()
 {
     QMutexLocker locker(&gameMutex);
@@ -283,7 +304,7 @@ void Server_Game::sendGameStateToPlayers()
     GameEventContainer *replayCont = prepareGameEvent(omniscientEvent, -1);
     replayCont->set_seconds_elapsed(secondsElapsed - startTimeOfThisGame);
     replayCont->clear_game_id();
-    currentReplay->add_event_list()->CopyFrom(*replayCont);
+    currentReplay->appendEvent(*replayCont);
     delete replayCont;
 
     // If spectators are not omniscient, we need an additional createGameStateChangedEvent call, otherwise we can use
@@ -346,13 +367,13 @@ void Server_Game::doStartGameIfReady(bool forceStartGame)
     }
 
     if (firstGameStarted) {
-        currentReplay->set_duration_seconds(secondsElapsed - startTimeOfThisGame);
+        currentReplay->setDurationSeconds(secondsElapsed - startTimeOfThisGame);
         replayList.append(currentReplay);
-        currentReplay = new GameReplay;
-        currentReplay->set_replay_id(databaseInterface->getNextReplayId());
-        ServerInfo_Game *gameInfo = currentReplay->mutable_game_info();
-        getInfo(*gameInfo);
-        gameInfo->set_started(false);
+        ServerInfo_Game gameInfo;
+        getInfo(gameInfo);
+        gameInfo.set_started(false);
+        currentReplay = new Server_ReplayWriter(databaseInterface->getNextReplayId(), gameInfo,
+                                                room->getServer()->getReplayBufferSize());
 
         Event_GameStateChanged omniscientEvent;
         createGameStateChangedEvent(&omniscientEvent, nullptr, true, true);
@@ -360,7 +381,7 @@ void Server_Game::doStartGameIfReady(bool forceStartGame)
         GameEventContainer *replayCont = prepareGameEvent(omniscientEvent, -1);
         replayCont->set_seconds_elapsed(0);
         replayCont->clear_game_id();
-        currentReplay->add_event_list()->CopyFrom(*replayCont);
+        currentReplay->appendEvent(*replayCont);
         delete replayCont;
 
         startTimeOfThisGame = secondsElapsed;
@@ -580,28 +601,22 @@ void Server_Game::removeArrowsRelatedToPlayer(GameEventStorage &ges, Server_Abst
     // Remove all arrows of other players pointing to the player being removed or to one of his cards.
     // Also remove all arrows starting at one of his cards. This is necessary since players can create
     // arrows that start at another person's cards.
-    for (Server_AbstractPlayer *anyPlayer : getPlayers().values()) {
-        QList<Server_Arrow *> toDelete;
-        for (auto *arrow : anyPlayer->getArrows().values()) {
-            auto *targetCard = qobject_cast<Server_Card *>(arrow->getTargetItem());
-            if (targetCard) {
-                if (targetCard->getZone() != nullptr && targetCard->getZone()->getPlayer() == player)
-                    toDelete.append(arrow);
-            } else if (arrow->getTargetItem() == player) {
-                toDelete.append(arrow);
-            }
-
-            // Don't use else here! It has to happen regardless of whether targetCard == 0.
-            if (arrow->getStartCard()->getZone() != nullptr && arrow->getStartCard()->getZone()->getPlayer() == player)
-                toDelete.append(arrow);
-        }
-        for (auto *arrow : toDelete) {
-            Event_DeleteArrow event;
-            event.set_arrow_id(arrow->getId());
-            ges.enqueueGameEvent(event, anyPlayer->getPlayerId());
-
-            anyPlayer->deleteArrow(arrow->getId());
-        }
+    QList<QPair<Server_AbstractPlayer *, Server_Arrow *>> toDelete = getArrowsOf(player);
+    for (auto *zone : player->getZones())
+        for (auto *card : zone->getCards())
+            toDelete.append(getArrowsOf(card));
+    std::sort(toDelete.begin(), toDelete.end(), [](const auto &a, const auto &b) {
+        return std::make_pair(a.first->getPlayerId(), a.second->getId()) <
+               std::make_pair(b.first->getPlayerId(), b.second->getId());
+    });
+    toDelete.erase(std::unique(toDelete.begin(), toDelete.end()), toDelete.end());
+
+    for (const auto &arrow : toDelete) {
+        Event_DeleteArrow event;
+        event.set_arrow_id(arrow.second->getId());
+        ges.enqueueGameEvent(event, arrow.first->getPlayerId());
+
+        arrow.first->deleteArrow(arrow.second->getId());
     }
 }
 
@@ -688,6 +703,29 @@ void Server_Game::removeArrows(int newPhase, bool force)
     }
 }
 
+void Server_Game::addArrowToIndex(Server_AbstractPlayer *player, Server_Arrow *arrow)
+{
+    arrowsByItem.insert(arrow->getStartCard(), qMakePair(player, arrow));
+    if (arrow->getTargetItem() != arrow->getStartCard())
+        arrowsByItem.insert(arrow->getTargetItem(), qMakePair(player, arrow));
+}
+
+void Server_Game::removeArrowFromIndex(Server_AbstractPlayer *player, Server_Arrow *arrow)
+{
+    arrowsByItem.remove(arrow->getStartCard(), qMakePair(player, arrow));
+    arrowsByItem.remove(arrow->getTargetItem(), qMakePair(player, arrow));
+}
+
+QList<QPair<Server_AbstractPlayer *, Server_Arrow *>> Server_Game::getArrowsOf(const Server_ArrowTarget *item) const
+{
+    QList<QPair<Server_AbstractPlayer *, Server_Arrow *>> result = arrowsByItem.values(item);
+    std::sort(result.begin(), result.end(), [](const auto &a, const auto &b) {
+        return std::make_pair(a.first->getPlayerId(), a.second->getId()) <
+               std::make_pair(b.first->getPlayerId(), b.second->getId());
+    });
+    return result;
+}
+
 void Server_Game::nextTurn()
 {
     QMutexLocker locker(&gameMutex);
@@ -762,17 +800,22 @@ void Server_Game::sendGameEventContainer(GameEventContainer *cont,
     QMutexLocker locker(&gameMutex);
 
     cont->set_game_id(gameId);
+    ServerMessageFrame frame;
     for (auto *participant : participants.values()) {
         const bool playerPrivate = (participant->getPlayerId() == privatePlayerId) ||
                                    (participant->isSpectator() && (spectatorsSeeEverything || participant->isJudge()));
         if ((recipients.testFlag(GameEventStorageItem::SendToPrivate) && playerPrivate) ||
-            (recipients.testFlag(GameEventStorageItem::SendToOthers) && !playerPrivate))
-            participant->sendGameEvent(*cont);
+            (recipients.testFlag(GameEventStorageItem::SendToOthers) && !playerPrivate)) {
+            // encoded lazily, so containers nobody receives are never serialized
+            if (frame.isNull())
+                frame = ServerMessageFrame(*cont);
+            participant->sendGameEvent(frame);
+        }
     }
     if (recipients.testFlag(GameEventStorageItem::SendToPrivate)) {
         cont->set_seconds_elapsed(secondsElapsed - startTimeOfThisGame);
         cont->clear_game_id();
-        currentReplay->add_event_list()->CopyFrom(*cont);
+        currentReplay->appendEvent(*cont);
     }
 
     delete cont;
@@ -21,23 +21,28 @@
 #define SERVERGAME_H
 
 #include "../server_response_containers.h"
+#include "../server_timer_wheel.h"
 
 #include <QDateTime>
 #include <QMap>
+#include <QMultiHash>
 #include <QMutex>
 #include <QObject>
 #include <QSet>
+#include <QSharedPointer>
 #include <QStringList>
 #include <libcockatrice/protocol/pb/event_leave.pb.h>
 #include <libcockatrice/protocol/pb/response.pb.h>
 #include <libcockatrice/protocol/pb/serverinfo_game.pb.h>
 
-class QTimer;
 class GameEventContainer;
-class GameReplay;
 class Server_Room;
 class Server_AbstractPlayer;
 class Server_AbstractParticipant;
+class Server_Arrow;
+class Server_ArrowTarget;
+class Server_GameObjectPool;
+class Server_ReplayWriter;
 class ServerInfo_User;
 class ServerInfo_Game;
 class Server_AbstractUserInterface;
@@ -73,20 +78,27 @@ private:
     bool firstGameStarted;
     bool turnOrderReversed;
     QDateTime startTime;
-    QTimer *pingClock;
-    QList<GameReplay *> replayList;
-    GameReplay *currentReplay;
+    QSharedPointer<Server_TimerWheel> pingClock; // shared by all games of this thread
+    quint64 pingTimerId; // guarded by gameMutex, like pingStopped
+    bool pingStopped;
+    QList<Server_ReplayWriter *> replayList; // the replays of earlier restarts of this game
+    Server_ReplayWriter *currentReplay;
+    Server_GameObjectPool *objectPool; // released in the destructor, deletes itself once its objects are gone
+    // Every arrow with its player, by the card it starts at and by the card or player it points to, so that the
+    // arrows of a card are found without looking at all the others. Kept up to date by Server_AbstractPlayer.
+    QMultiHash<const Server_ArrowTarget *, QPair<Server_AbstractPlayer *, Server_Arrow *>> arrowsByItem;
 
     void createGameStateChangedEvent(Event_GameStateChanged *event,
                                      Server_AbstractParticipant *recipient,
                                      bool omniscient,
                                      bool withUserInfo);
     void storeGameInformation();
+    void schedulePing();
+    void pingClockTimeout();
 signals:
     void sigStartGameIfReady(bool override);
     void gameInfoChanged(ServerInfo_Game gameInfo);
 private slots:
-    void pingClockTimeout();
     void doStartGameIfReady(bool forceStartGame = false);
 
 public:
@@ -111,6 +123,11 @@ public:
     {
         return room;
     }
+    /// Where the cards, arrows and counters of this game are allocated, see Server_GameObject.
+    Server_GameObjectPool *getObjectPool() const
+    {
+        return objectPool;
+    }
     void getInfo(ServerInfo_Game &result) const;
     int getHostId() const
     {
@@ -197,6 +214,10 @@ public:
     void setActivePlayer(int newPlayer);
     void setActivePhase(int newPhase);
     void removeArrows(int newPhase, bool force = false);
+    void addArrowToIndex(Server_AbstractPlayer *player, Server_Arrow *arrow);
+    void removeArrowFromIndex(Server_AbstractPlayer *player, Server_Arrow *arrow);
+    /// The arrows starting at or pointing to @p item with their players, sorted by player and arrow id.
+    QList<QPair<Server_AbstractPlayer *, Server_Arrow *>> getArrowsOf(const Server_ArrowTarget *item) const;
     void nextTurn();
     int getSecondsElapsed() const
     {
@@ -0,0 +1,117 @@
+#include "server_game_object_pool.h"
+
+#include <new>
+
+namespace
+{
+struct alignas(std::max_align_t) BlockHeader
+{
+    Server_GameObjectPool *pool; // null for blocks from allocateUnpooled()
+    std::size_t blockSize;       // header included
+};
+
+BlockHeader *headerOf(void *ptr)
+{
+    return reinterpret_cast<BlockHeader *>(static_cast<char *>(ptr) - sizeof(BlockHeader));
+}
+} // namespace
+
+Server_GameObjectPool::Server_GameObjectPool()
+    : chunkPos(nullptr), chunkEnd(nullptr), freeLists{}, released(false)
+{
+}
+
+Server_GameObjectPool::~Server_GameObjectPool()
+{
+    for (char *chunk : chunks)
+        ::operator delete(chunk);
+}
+
+void Server_GameObjectPool::release()
+{
+    {
+        QMutexLocker locker(&mutex);
+        released = true;
+        if (stats.liveObjects > 0)
+            return;
+    }
+    delete this;
+}
+
+Server_GameObjectPool::Stats Server_GameObjectPool::getStats() const
+{
+    QMutexLocker locker(&mutex);
+    return stats;
+}
+
+void *Server_GameObjectPool::allocate(std::size_t size)
+{
+    const std::size_t blockSize = (sizeof(BlockHeader) + size + granularity - 1) / granularity * granularity;
+    const std::size_t sizeClass = blockSize / granularity - 1;
+    char *block;
+
+    QMutexLocker locker(&mutex);
+    if (sizeClass >= sizeClassCount) {
+        block = static_cast<char *>(::operator new(blockSize));
+        stats.reservedBytes += blockSize;
+    } else if (freeLists[sizeClass]) {
+        block = reinterpret_cast<char *>(freeLists[sizeClass]);
+        freeLists[sizeClass] = freeLists[sizeClass]->next;
+    } else {
+        if (chunkEnd - chunkPos < static_cast<std::ptrdiff_t>(blockSize)) {
+            // the rest of the current chunk is left unused, it is smaller than the largest size class
+            chunkPos = static_cast<char *>(::operator new(chunkSize));
+            chunkEnd = chunkPos + chunkSize;
+            chunks.append(chunkPos);
+            stats.reservedBytes += chunkSize;
+        }
+        block = chunkPos;
+        chunkPos += blockSize;
+    }
+
+    ++stats.allocations;
+    ++stats.liveObjects;
+    stats.peakLiveObjects = qMax(stats.peakLiveObjects, stats.liveObjects);
+    stats.liveBytes += blockSize;
+
+    auto *header = new (block) BlockHeader{this, blockSize};
+    return header + 1;
+}
+
+bool Server_GameObjectPool::deallocateBlock(void *block, std::size_t blockSize)
+{
+    QMutexLocker locker(&mutex);
+    const std::size_t sizeClass = blockSize / granularity - 1;
+    if (sizeClass >= sizeClassCount) {
+        ::operator delete(block);
+        stats.reservedBytes -= blockSize;
+    } else {
+        auto *freeBlock = static_cast<FreeBlock *>(block);
+        freeBlock->next = freeLists[sizeClass];
+        freeLists[sizeClass] = freeBlock;
+    }
+    --stats.liveObjects;
+    stats.liveBytes -= blockSize;
+    return released && stats.liveObjects == 0;
+}
+
+void Server_GameObjectPool::deallocate(void *ptr)
+{
+    if (!ptr)
+        return;
+
+    BlockHeader *header = headerOf(ptr);
+    Server_GameObjectPool *pool = header->pool;
+    if (!pool) {
+        ::operator delete(header);
+        return;
+    }
+    if (pool->deallocateBlock(header, header->blockSize))
+        delete pool;
+}
+
+void *Server_GameObjectPool::allocateUnpooled(std::size_t size)
+{
+    auto *header = new (::operator new(sizeof(BlockHeader) + size)) BlockHeader{nullptr, sizeof(BlockHeader) + size};
+    return header + 1;
+}
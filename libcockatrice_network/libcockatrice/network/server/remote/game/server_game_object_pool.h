@@ -0,0 +1,92 @@
+#ifndef SERVER_GAME_OBJECT_POOL_H
+#define SERVER_GAME_OBJECT_POOL_H
+
+#include <QList>
+#include <QMutex>
+#include <cstddef>
+
+/**
+ * The memory of the cards, arrows and counters of one game.
+ *
+ * Objects are carved out of 64 KiB chunks, and freed blocks go to a free list per size class, so a game that
+ * creates and destroys thousands of tokens reuses the same few chunks instead of scattering small allocations over
+ * the heap of a long running server. All chunks are returned in one go once the game has ended and its last object
+ * is freed; objects deleted later, e.g. with deleteLater(), keep the pool alive until then.
+ *
+ * Each block starts with a header pointing back to its pool, so objects are freed with a plain delete. Blocks too
+ * large for a size class, and objects created without a pool, e.g. in tests, come from the global heap.
+ */
+class Server_GameObjectPool
+{
+public:
+    struct Stats
+    {
+        quint64 allocations = 0;
+        int liveObjects = 0;
+        int peakLiveObjects = 0;
+        qint64 liveBytes = 0;
+        qint64 reservedBytes = 0; // chunks and large blocks currently held
+    };
+
+private:
+    static const std::size_t chunkSize = 64 * 1024;
+    static const std::size_t granularity = alignof(std::max_align_t);
+    static const int sizeClassCount = 64; // blocks of up to 64 * granularity bytes, header included
+
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    mutable QMutex mutex; // objects may be freed by deleteLater() outside of the game mutex
+    QList<char *> chunks;
+    char *chunkPos;
+    char *chunkEnd;
+    FreeBlock *freeLists[sizeClassCount];
+    Stats stats;
+    bool released;
+
+    ~Server_GameObjectPool();
+    bool deallocateBlock(void *block, std::size_t blockSize); // returns true if the pool should be deleted
+
+public:
+    Server_GameObjectPool();
+    Server_GameObjectPool(const Server_GameObjectPool &) = delete;
+    Server_GameObjectPool &operator=(const Server_GameObjectPool &) = delete;
+
+    /// Called by the game when it is destroyed, the pool deletes itself as soon as no object is left.
+    void release();
+    [[nodiscard]] Stats getStats() const;
+
+    void *allocate(std::size_t size);
+    /// Frees memory returned by allocate() or allocateUnpooled().
+    static void deallocate(void *ptr);
+    static void *allocateUnpooled(std::size_t size);
+};
+
+/**
+ * Base class of the objects that live in a Server_GameObjectPool, created with `new (pool) T(...)`. A plain
+ * `new T(...)` still works and uses the global heap.
+ */
+class Server_GameObject
+{
+public:
+    static void *operator new(std::size_t size, Server_GameObjectPool *pool)
+    {
+        return pool ? pool->allocate(size) : Server_GameObjectPool::allocateUnpooled(size);
+    }
+    static void *operator new(std::size_t size)
+    {
+        return Server_GameObjectPool::allocateUnpooled(size);
+    }
+    static void operator delete(void *ptr, Server_GameObjectPool * /* pool */)
+    {
+        Server_GameObjectPool::deallocate(ptr);
+    }
+    static void operator delete(void *ptr)
+    {
+        Server_GameObjectPool::deallocate(ptr);
+    }
+};
+
+#endif
@@ -79,6 +79,8 @@ void Server_Player::setupZones()
     // This may need to be customized according to the game rules.
     // ------------------------------------------------------------------
 
+    Server_GameObjectPool *pool = game->getObjectPool();
+
     // Create zones
     auto *deckZone = new Server_CardZone(this, "deck", false, ServerInfo_Zone::HiddenZone);
     addZone(deckZone);
@@ -90,22 +92,22 @@ void Server_Player::setupZones()
     addZone(new Server_CardZone(this, "grave", false, ServerInfo_Zone::PublicZone));
     addZone(new Server_CardZone(this, "rfg", false, ServerInfo_Zone::PublicZone));
 
-    addCounter(new Server_Counter(0, "life", makeColor(255, 255, 255), 25, game->getStartingLifeTotal()));
-    addCounter(new Server_Counter(1, "w", makeColor(255, 255, 150), 20, 0));
-    addCounter(new Server_Counter(2, "u", makeColor(150, 150, 255), 20, 0));
-    addCounter(new Server_Counter(3, "b", makeColor(150, 150, 150), 20, 0));
-    addCounter(new Server_Counter(4, "r", makeColor(250, 150, 150), 20, 0));
-    addCounter(new Server_Counter(5, "g", makeColor(150, 255, 150), 20, 0));
-    addCounter(new Server_Counter(6, "x", makeColor(255, 255, 255), 20, 0));
-    addCounter(new Server_Counter(7, "storm", makeColor(255, 150, 30), 20, 0));
+    addCounter(new (pool) Server_Counter(0, "life", makeColor(255, 255, 255), 25, game->getStartingLifeTotal()));
+    addCounter(new (pool) Server_Counter(1, "w", makeColor(255, 255, 150), 20, 0));
+    addCounter(new (pool) Server_Counter(2, "u", makeColor(150, 150, 255), 20, 0));
+    addCounter(new (pool) Server_Counter(3, "b", makeColor(150, 150, 150), 20, 0));
+    addCounter(new (pool) Server_Counter(4, "r", makeColor(250, 150, 150), 20, 0));
+    addCounter(new (pool) Server_Counter(5, "g", makeColor(150, 255, 150), 20, 0));
+    addCounter(new (pool) Server_Counter(6, "x", makeColor(255, 255, 255), 20, 0));
+    addCounter(new (pool) Server_Counter(7, "storm", makeColor(255, 150, 30), 20, 0));
 
     // ------------------------------------------------------------------
 
     // Assign card ids and create deck from deck list
-    auto insertCardsIntoZone = [this](auto cards, auto *zone) {
+    auto insertCardsIntoZone = [this, pool](auto cards, auto *zone) {
         for (auto card : cards) {
             for (int k = 0; k < card->getNumber(); ++k) {
-                zone->insertCard(new Server_Card(card->toCardRef(), nextCardId++, 0, 0, zone), -1, 0);
+                zone->insertCard(new (pool) Server_Card(card->toCardRef(), nextCardId++, 0, 0, zone), -1, 0);
             }
         }
     };
@@ -164,8 +166,8 @@ void Server_Player::addCounter(Server_Counter *counter)
 
 Response::ResponseCode Server_Player::drawCards(GameEventStorage &ges, int number)
 {
-    Server_CardZone *deckZone = zones.value("deck");
-    Server_CardZone *handZone = zones.value("hand");
+    Server_CardZone *deckZone = getZone(ZoneId::Deck);
+    Server_CardZone *handZone = getZone(ZoneId::Hand);
     if (deckZone->getCards().size() < number) {
         number = deckZone->getCards().size();
     }
@@ -210,7 +212,7 @@ void Server_Player::onCardBeingMoved(GameEventStorage &ges,
     // "Undo draw" should only remain valid if the just-drawn card stays within the user's hand (e.g., they only
     // reorder their hand). If a just-drawn card leaves the hand then remove cards before it from the list
     // (Ignore the case where the card is currently being un-drawn.)
-    if (startzone->getName() == "hand" && targetzone->getName() != "hand" && !undoingDraw) {
+    if (startzone->getId() == ZoneId::Hand && targetzone->getId() != ZoneId::Hand && !undoingDraw) {
         int index = lastDrawList.lastIndexOf(card->getId());
         if (index != -1) {
             lastDrawList.erase(lastDrawList.begin(), lastDrawList.begin() + index);
@@ -330,7 +332,7 @@ Server_Player::cmdShuffle(const Command_Shuffle &cmd, ResponseContainer & /*rc*/
         return Response::RespFunctionNotAllowed;
     }
 
-    Server_CardZone *zone = zones.value("deck");
+    Server_CardZone *zone = getZone(ZoneId::Deck);
     if (!zone) {
         return Response::RespNameNotFound;
     }
@@ -338,7 +340,7 @@ Server_Player::cmdShuffle(const Command_Shuffle &cmd, ResponseContainer & /*rc*/
     zone->shuffle(cmd.start(), cmd.end());
 
     Event_Shuffle event;
-    event.set_zone_name(zone->getName().toStdString());
+    event.set_zone_name(zone->getStdName());
     event.set_start(cmd.start());
     event.set_end(cmd.end());
     ges.enqueueGameEvent(event, playerId);
@@ -357,8 +359,8 @@ Server_Player::cmdMulligan(const Command_Mulligan &cmd, ResponseContainer & /*rc
         return Response::RespContextError;
     }
 
-    Server_CardZone *hand = zones.value("hand");
-    Server_CardZone *_deck = zones.value("deck");
+    Server_CardZone *hand = getZone(ZoneId::Hand);
+    Server_CardZone *_deck = getZone(ZoneId::Deck);
     int number = cmd.number();
 
     if (!hand->getCards().isEmpty()) {
@@ -414,8 +416,8 @@ Server_Player::cmdUndoDraw(const Command_UndoDraw & /*cmd*/, ResponseContainer &
     Response::ResponseCode retVal;
     auto *cardToMove = new CardToMove;
     cardToMove->set_card_id(lastDrawList.takeLast());
-    retVal = moveCard(ges, zones.value("hand"), QList<const CardToMove *>() << cardToMove, zones.value("deck"), 0, 0,
-                      false, true);
+    retVal = moveCard(ges, getZone(ZoneId::Hand), QList<const CardToMove *>() << cardToMove, getZone(ZoneId::Deck), 0,
+                      0, false, true);
     delete cardToMove;
 
     return retVal;
@@ -456,8 +458,8 @@ Server_Player::cmdCreateCounter(const Command_CreateCounter &cmd, ResponseContai
         return Response::RespContextError;
     }
 
-    auto *c = new Server_Counter(newCounterId(), nameFromStdString(cmd.counter_name()), cmd.counter_color(),
-                                 cmd.radius(), cmd.value());
+    auto *c = new (game->getObjectPool()) Server_Counter(newCounterId(), nameFromStdString(cmd.counter_name()),
+                                                         cmd.counter_color(), cmd.radius(), cmd.value());
     addCounter(c);
 
     Event_CreateCounter event;
@@ -565,7 +567,7 @@ Response::ResponseCode Server_Player::cmdChangeZoneProperties(const Command_Chan
 {
     auto ret = Server_AbstractPlayer::cmdChangeZoneProperties(cmd, rc, ges);
 
-    Server_CardZone *zone = zones.value(nameFromStdString(cmd.zone_name()));
+    Server_CardZone *zone = getZone(cmd.zone_name());
     if (!zone) {
         return Response::RespNameNotFound;
     }
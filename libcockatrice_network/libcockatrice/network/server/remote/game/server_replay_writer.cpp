@@ -0,0 +1,77 @@
+#include "server_replay_writer.h"
+
+#include "../server_message_frame.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QTemporaryFile>
+#include <libcockatrice/protocol/pb/game_replay.pb.h>
+
+Server_ReplayWriter::Server_ReplayWriter(quint64 _replayId, const ServerInfo_Game &_gameInfo, int _bufferSize)
+    : replayId(_replayId), gameInfo(_gameInfo), durationSeconds(0), bufferSize(_bufferSize), spoolFile(nullptr),
+      spoolFailed(false), spooledBytes(0), eventCount(0), peakBufferedBytes(0)
+{
+}
+
+Server_ReplayWriter::~Server_ReplayWriter()
+{
+    delete spoolFile;
+}
+
+void Server_ReplayWriter::appendEvent(const GameEventContainer &cont)
+{
+    ServerMessageFrame::appendEncodedField(buffer, GameReplay::kEventListFieldNumber,
+                                           QByteArray::fromStdString(cont.SerializeAsString()));
+    ++eventCount;
+    peakBufferedBytes = qMax(peakBufferedBytes, static_cast<int>(buffer.size()));
+    if (buffer.size() >= bufferSize && !spoolFailed)
+        flush();
+}
+
+void Server_ReplayWriter::flush()
+{
+    if (!spoolFile) {
+        spoolFile = new QTemporaryFile(QDir::tempPath() + "/servatrice-replay-XXXXXX");
+        if (!spoolFile->open()) {
+            qWarning() << "Server_ReplayWriter: could not create" << spoolFile->fileTemplate() << "-"
+                       << spoolFile->errorString() << "- keeping replay" << replayId << "in memory";
+            spoolFailed = true;
+            return;
+        }
+    }
+    if (spoolFile->write(buffer) != buffer.size()) {
+        qWarning() << "Server_ReplayWriter: could not write" << spoolFile->fileName() << "-"
+                   << spoolFile->errorString() << "- keeping replay" << replayId << "in memory";
+        // the file is cut back to what was fully written, the rest stays in the buffer
+        spoolFile->resize(spooledBytes);
+        spoolFile->seek(spooledBytes);
+        spoolFailed = true;
+        return;
+    }
+    spooledBytes += buffer.size();
+    buffer.resize(0);
+}
+
+QByteArray Server_ReplayWriter::readReplay()
+{
+    GameReplay head;
+    head.set_replay_id(replayId);
+    head.mutable_game_info()->CopyFrom(gameInfo);
+    head.set_duration_seconds(durationSeconds);
+    const std::string headFields = head.SerializeAsString();
+
+    QByteArray replay;
+    replay.reserve(static_cast<int>(headFields.size() + spooledBytes) + buffer.size());
+    replay.append(headFields.data(), static_cast<int>(headFields.size()));
+    if (spooledBytes > 0) {
+        spoolFile->flush();
+        spoolFile->seek(0);
+        replay.append(spoolFile->read(spooledBytes));
+        spoolFile->seek(spooledBytes);
+        if (replay.size() != static_cast<int>(headFields.size() + spooledBytes))
+            qWarning() << "Server_ReplayWriter: could not read back" << spoolFile->fileName() << "-"
+                       << spoolFile->errorString();
+    }
+    replay.append(buffer);
+    return replay;
+}
@@ -0,0 +1,79 @@
+#ifndef SERVER_REPLAY_WRITER_H
+#define SERVER_REPLAY_WRITER_H
+
+#include <QByteArray>
+#include <libcockatrice/protocol/pb/serverinfo_game.pb.h>
+
+class GameEventContainer;
+class QTemporaryFile;
+
+/**
+ * Records one replay of a game while it is played.
+ *
+ * Each event container is encoded right away as an event_list entry of a GameReplay and appended to a buffer. Once
+ * the buffer grows past its limit it is written to a temporary file, so a long game holds at most one buffer of its
+ * replay in memory instead of every event it ever sent. As protobuf accepts the fields of a message in any order,
+ * readReplay() only has to put the replay id, game info and duration in front of the recorded events to get a
+ * serialized GameReplay.
+ *
+ * If the temporary file can't be written the events stay in memory, which is what happened before.
+ */
+class Server_ReplayWriter
+{
+private:
+    quint64 replayId;
+    ServerInfo_Game gameInfo;
+    int durationSeconds;
+    int bufferSize;
+    QByteArray buffer;         // encoded events not written to the spool file yet
+    QTemporaryFile *spoolFile; // created by the first flush
+    bool spoolFailed;
+    qint64 spooledBytes;
+    int eventCount;
+    int peakBufferedBytes;
+
+    void flush();
+
+public:
+    Server_ReplayWriter(quint64 _replayId, const ServerInfo_Game &_gameInfo, int _bufferSize);
+    ~Server_ReplayWriter();
+    Server_ReplayWriter(const Server_ReplayWriter &) = delete;
+    Server_ReplayWriter &operator=(const Server_ReplayWriter &) = delete;
+
+    quint64 getReplayId() const
+    {
+        return replayId;
+    }
+    const ServerInfo_Game &getGameInfo() const
+    {
+        return gameInfo;
+    }
+    int getDurationSeconds() const
+    {
+        return durationSeconds;
+    }
+    void setDurationSeconds(int _durationSeconds)
+    {
+        durationSeconds = _durationSeconds;
+    }
+    int getEventCount() const
+    {
+        return eventCount;
+    }
+    /// The size of all recorded events, in memory or on disk.
+    qint64 getRecordedBytes() const
+    {
+        return spooledBytes + buffer.size();
+    }
+    /// The most the buffer ever held before it was flushed.
+    int getPeakBufferedBytes() const
+    {
+        return peakBufferedBytes;
+    }
+
+    void appendEvent(const GameEventContainer &cont);
+    /// Returns the whole replay as a serialized GameReplay.
+    QByteArray readReplay();
+};
+
+#endif
@@ -22,6 +22,8 @@
 #include "game/server_game.h"
 #include "game/server_player.h"
 #include "server_database_interface.h"
+#include "server_game_executor.h"
+#include "server_message_frame.h"
 #include "server_protocolhandler.h"
 #include "server_remoteuserinterface.h"
 #include "server_room.h"
@@ -37,7 +39,8 @@
 #include <libcockatrice/protocol/pb/isl_message.pb.h>
 #include <libcockatrice/protocol/pb/session_event.pb.h>
 
-Server::Server(QObject *parent) : QObject(parent), nextLocalGameId(0), tcpUserCount(0), webSocketUserCount(0)
+Server::Server(QObject *parent)
+    : QObject(parent), nextLocalGameId(0), tcpUserCount(0), webSocketUserCount(0), gameExecutor(nullptr)
 {
     qRegisterMetaType<ServerInfo_Ban>("ServerInfo_Ban");
     qRegisterMetaType<ServerInfo_Game>("ServerInfo_Game");
@@ -52,8 +55,20 @@ Server::Server(QObject *parent) : QObject(parent), nextLocalGameId(0), tcpUserCo
     connect(this, &Server::sigSendIslMessage, this, &Server::doSendIslMessage, Qt::QueuedConnection);
 }
 
+Server::~Server()
+{
+    delete gameExecutor;
+}
+
 void Server::prepareDestroy()
 {
+    // games are about to be deleted, so no more game commands may run
+    if (gameExecutor) {
+        gameExecutor->stop();
+        for (QThread *thread : gameExecutor->getThreads())
+            databaseInterfaces.remove(thread);
+    }
+
     roomsLock.lockForWrite();
     QMapIterator<int, Server_Room *> roomIterator(rooms);
     while (roomIterator.hasNext())
@@ -62,6 +77,75 @@ void Server::prepareDestroy()
     roomsLock.unlock();
 }
 
+void Server::startGameExecutor(int threadCount)
+{
+    if (gameExecutor || threadCount <= 0)
+        return;
+    gameExecutor = new Server_GameExecutor(threadCount);
+
+    // game commands log chat messages and load decks through the database interface of the thread they run on
+    const QList<QThread *> &gameThreads = gameExecutor->getThreads();
+    for (int i = 0; i < gameThreads.size(); ++i) {
+        Server_DatabaseInterface *gameDatabaseInterface = createGameThreadDatabaseInterface(i, gameThreads[i]);
+        if (gameDatabaseInterface)
+            databaseInterfaces.insert(gameThreads[i], gameDatabaseInterface);
+    }
+}
+
+// Must be called before the first client connects.
+void Server::loadUserDirectorySettings()
+{
+    userDirectory.setHistorySize(getUserListHistorySize());
+}
+
+// Must be called before the first client connects, the limits are not locked.
+void Server::loadRateLimits()
+{
+    using Limit = Server_RateLimiter::Limit;
+    Server_RateLimiter::Limits limits = rateLimiter.getLimits();
+
+    // a per session message maximum of 0 drops every message, everywhere else 0 turns the limit off
+    const qint64 messageInterval = qMax(getMessageCountingInterval(), 0) * 1000LL;
+    const int maxMessageCount = getMaxMessageCountPerInterval();
+    const int maxMessageSize = getMaxMessageSizePerInterval();
+    limits.perSession[Server_RateLimiter::MessageCount] = Limit{maxMessageCount, messageInterval};
+    limits.perSession[Server_RateLimiter::MessageSize] = Limit{maxMessageSize, messageInterval};
+
+    const int maxAddressMessageCount = getMaxMessageCountPerAddressPerInterval();
+    const int maxAddressMessageSize = getMaxMessageSizePerAddressPerInterval();
+    limits.perAddress[Server_RateLimiter::MessageCount] =
+        Limit{maxAddressMessageCount, maxAddressMessageCount > 0 ? messageInterval : 0};
+    limits.perAddress[Server_RateLimiter::MessageSize] =
+        Limit{maxAddressMessageSize, maxAddressMessageSize > 0 ? messageInterval : 0};
+
+    const qint64 commandInterval = qMax(getCommandCountingInterval(), 0) * 1000LL;
+    const int maxCommandCount = getMaxCommandCountPerInterval();
+    const int maxAddressCommandCount = getMaxCommandCountPerAddressPerInterval();
+    limits.perSession[Server_RateLimiter::CommandCount] =
+        Limit{maxCommandCount, maxCommandCount > 0 ? commandInterval : 0};
+    limits.perAddress[Server_RateLimiter::CommandCount] =
+        Limit{maxAddressCommandCount, maxAddressCommandCount > 0 ? commandInterval : 0};
+
+    rateLimiter.setLimits(limits);
+}
+
+QSharedPointer<Server_TimerWheel> Server::getTimerWheel(Server_TimerWheel::Clock clock)
+{
+    QMutexLocker locker(&timerWheelsMutex);
+    const QPair<QThread *, int> key(QThread::currentThread(), clock);
+    QSharedPointer<Server_TimerWheel> timerWheel = timerWheels.value(key).toStrongRef();
+    if (timerWheel)
+        return timerWheel;
+
+    auto *newTimerWheel = new Server_TimerWheel(clock == Server_TimerWheel::SecondClock ? 1000 : 0);
+    if (clock == Server_TimerWheel::PingClock)
+        connect(this, &Server::pingClockTimeout, newTimerWheel, &Server_TimerWheel::advance);
+    // the last user may be released from another thread during shutdown
+    timerWheel = QSharedPointer<Server_TimerWheel>(newTimerWheel, &QObject::deleteLater);
+    timerWheels.insert(key, timerWheel);
+    return timerWheel;
+}
+
 void Server::setDatabaseInterface(Server_DatabaseInterface *_databaseInterface)
 {
     connect(this, &Server::endSession, _databaseInterface, &Server_DatabaseInterface::endSession);
@@ -162,13 +246,17 @@ AuthenticationResult Server::loginUser(Server_ProtocolHandler *session,
 
     Event_UserJoined event;
     event.mutable_user_info()->CopyFrom(session->copyUserInfo(false));
+    event.set_version(userDirectory.addUser(event.user_info()));
     SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
+    const ServerMessageFrame frame(*se);
     for (auto &client : clients)
-        if (client->getAcceptsUserListChanges())
-            client->sendProtocolItem(*se);
+        if (client->getAcceptsUserListChanges(name))
+            client->sendProtocolItem(frame);
     delete se;
 
+    // the other servers keep their own user list versions
     event.mutable_user_info()->CopyFrom(session->copyUserInfo(true, true, true));
+    event.clear_version();
     locker.unlock();
 
     if (hasClientId) {
@@ -212,6 +300,31 @@ Server_AbstractUserInterface *Server::findUser(const QString &userName) const
         return externalUsers.value(userName);
 }
 
+void Server::updateUserInfo(Server_ProtocolHandler *session)
+{
+    {
+        QWriteLocker locker(&clientsLock);
+        const QString userName = QString::fromStdString(session->getUserInfo()->name());
+        if (users.value(userName) != session)
+            return;
+
+        // announced like a login, the clients replace the entry they have
+        Event_UserJoined event;
+        event.mutable_user_info()->CopyFrom(session->copyUserInfo(false));
+        event.set_version(userDirectory.addUser(event.user_info()));
+        SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
+        const ServerMessageFrame frame(*se);
+        for (auto &client : clients)
+            if (client->getAcceptsUserListChanges(userName))
+                client->sendProtocolItem(frame);
+        delete se;
+    }
+
+    QReadLocker roomsLocker(&roomsLock);
+    for (Server_Room *room : rooms)
+        room->updateClient(session);
+}
+
 void Server::addClient(Server_ProtocolHandler *client)
 {
     if (client->getConnectionType() == "tcp")
@@ -220,8 +333,12 @@ void Server::addClient(Server_ProtocolHandler *client)
     if (client->getConnectionType() == "websocket")
         webSocketUserCount++;
 
+    client->startTimeoutChecks();
+    client->startFloodControl();
+
     QWriteLocker locker(&clientsLock);
     clients << client;
+    clientsByAddress[client->getAddress()].append(client);
 }
 
 void Server::removeClient(Server_ProtocolHandler *client)
@@ -240,14 +357,24 @@ void Server::removeClient(Server_ProtocolHandler *client)
 
     QWriteLocker locker(&clientsLock);
     clients.removeAt(clientIndex);
+    auto addressClients = clientsByAddress.find(client->getAddress());
+    if (addressClients != clientsByAddress.end()) {
+        addressClients->removeOne(client);
+        if (addressClients->isEmpty())
+            clientsByAddress.erase(addressClients);
+    }
     ServerInfo_User *data = client->getUserInfo();
     if (data) {
+        const QString userName = QString::fromStdString(data->name());
         Event_UserLeft event;
         event.set_name(data->name());
+        event.set_version(userDirectory.removeUser(userName));
         SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
+        const ServerMessageFrame frame(*se);
         for (auto &_client : clients)
-            if (_client->getAcceptsUserListChanges())
-                _client->sendProtocolItem(*se);
+            if (_client->getAcceptsUserListChanges(userName))
+                _client->sendProtocolItem(frame);
+        se->MutableExtension(Event_UserLeft::ext)->clear_version();
         sendIsl_SessionEvent(*se);
         delete se;
 
@@ -289,13 +416,16 @@ void Server::externalUserJoined(const ServerInfo_User &userInfo)
     externalUsers.insert(QString::fromStdString(userInfo.name()), newUser);
     externalUsersBySessionId.insert(userInfo.session_id(), newUser);
 
+    const QString userName = QString::fromStdString(userInfo.name());
     Event_UserJoined event;
     event.mutable_user_info()->CopyFrom(userInfo);
+    event.set_version(userDirectory.addUser(newUser->copyUserInfo(false)));
 
     SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
+    const ServerMessageFrame frame(*se);
     for (auto &client : clients)
-        if (client->getAcceptsUserListChanges())
-            client->sendProtocolItem(*se);
+        if (client->getAcceptsUserListChanges(userName))
+            client->sendProtocolItem(frame);
     delete se;
     clientsLock.unlock();
 
@@ -311,6 +441,17 @@ void Server::externalUserLeft(const QString &userName)
     clientsLock.lockForWrite();
     Server_AbstractUserInterface *user = externalUsers.take(userName);
     externalUsersBySessionId.remove(user->getUserInfo()->session_id());
+
+    // announced together with the change of the user list, so that the versions reach the clients in order
+    Event_UserLeft event;
+    event.set_name(userName.toStdString());
+    event.set_version(userDirectory.removeUser(userName));
+    SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
+    const ServerMessageFrame frame(*se);
+    for (auto &client : clients)
+        if (client->getAcceptsUserListChanges(userName))
+            client->sendProtocolItem(frame);
+    delete se;
     clientsLock.unlock();
 
     QMap<int, QPair<int, int>> userGames(user->getGames());
@@ -337,17 +478,6 @@ void Server::externalUserLeft(const QString &userName)
     roomsLock.unlock();
 
     delete user;
-
-    Event_UserLeft event;
-    event.set_name(userName.toStdString());
-
-    SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
-    clientsLock.lockForRead();
-    for (auto &client : clients)
-        if (client->getAcceptsUserListChanges())
-            client->sendProtocolItem(*se);
-    clientsLock.unlock();
-    delete se;
 }
 
 void Server::externalRoomUserJoined(int roomId, const ServerInfo_User &userInfo)
@@ -545,11 +675,12 @@ void Server::broadcastRoomUpdate(const ServerInfo_Room &roomInfo, bool sendToIsl
     event.add_room_list()->CopyFrom(roomInfo);
 
     SessionEvent *se = Server_ProtocolHandler::prepareSessionEvent(event);
+    const ServerMessageFrame frame(*se);
 
     clientsLock.lockForRead();
     for (auto &client : clients)
         if (client->getAcceptsRoomListChanges())
-            client->sendProtocolItem(*se);
+            client->sendProtocolItem(frame);
     clientsLock.unlock();
 
     if (sendToIsl)
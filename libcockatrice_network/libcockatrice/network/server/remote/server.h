@@ -2,21 +2,27 @@
 #define SERVER_H
 
 #include "server_player_reference.h"
+#include "server_rate_limiter.h"
+#include "server_timer_wheel.h"
+#include "server_user_directory.h"
 
+#include <QHash>
 #include <QMultiMap>
 #include <QMutex>
 #include <QObject>
 #include <QReadWriteLock>
+#include <QSharedPointer>
 #include <libcockatrice/protocol/pb/commands.pb.h>
 #include <libcockatrice/protocol/pb/serverinfo_ban.pb.h>
 #include <libcockatrice/protocol/pb/serverinfo_user.pb.h>
 
 class Server_DatabaseInterface;
 class Server_Game;
+class Server_GameExecutor;
 class Server_Room;
 class Server_ProtocolHandler;
 class Server_AbstractUserInterface;
-class GameReplay;
+class Server_ReplayWriter;
 class IslMessage;
 class SessionEvent;
 class RoomEvent;
@@ -54,7 +60,7 @@ private slots:
 public:
     mutable QReadWriteLock clientsLock, roomsLock; // locking order: roomsLock before clientsLock
     explicit Server(QObject *parent = nullptr);
-    ~Server() override = default;
+    ~Server() override;
     AuthenticationResult loginUser(Server_ProtocolHandler *session,
                                    QString &name,
                                    const QString &password,
@@ -64,6 +70,9 @@ public:
                                    QString &clientid,
                                    QString &clientVersion,
                                    QString &connectionType);
+    /// Lists the account data of a logged in user again after it was changed, e.g. the real name or the country, in the
+    /// user directory and in the rooms the user is in.
+    void updateUserInfo(Server_ProtocolHandler *session);
 
     const QMap<int, Server_Room *> &getRooms()
     {
@@ -79,6 +88,11 @@ public:
     {
         return usersBySessionId;
     }
+    /// Connections whose getAddress() equals @p address. Lock clientsLock before calling this.
+    QList<Server_ProtocolHandler *> getClientsWithAddress(const QString &address) const
+    {
+        return clientsByAddress.value(address);
+    }
     virtual QMap<QString, bool> getServerRequiredFeatureList() const
     {
         return QMap<QString, bool>();
@@ -122,6 +136,11 @@ public:
     {
         return true;
     }
+    /// Bytes of a replay kept in memory while the game runs, anything beyond that is spooled to a temporary file.
+    virtual int getReplayBufferSize() const
+    {
+        return 64 * 1024;
+    }
     virtual int getIdleClientTimeout() const
     {
         return 0;
@@ -162,6 +181,33 @@ public:
     {
         return 0;
     }
+    /// Frames with a payload of at least this many bytes are compressed for clients that support it, 0 turns it off.
+    virtual int getCompressionThreshold() const
+    {
+        return 0;
+    }
+    /// Game list changes in a room are collected for this many msecs and sent together, 0 sends them right away.
+    virtual int getGameListUpdateInterval() const
+    {
+        return 0;
+    }
+    /// How many logins and logouts clients can catch up on with Command_ListUsers.since_version.
+    virtual int getUserListHistorySize() const
+    {
+        return 1000;
+    }
+    virtual int getMaxMessageCountPerAddressPerInterval() const
+    {
+        return 0;
+    }
+    virtual int getMaxMessageSizePerAddressPerInterval() const
+    {
+        return 0;
+    }
+    virtual int getMaxCommandCountPerAddressPerInterval() const
+    {
+        return 0;
+    }
     virtual int getMaxUserTotal() const
     {
         return 9999999;
@@ -176,6 +222,18 @@ public:
     }
 
     Server_DatabaseInterface *getDatabaseInterface() const;
+    /// Runs game commands off the connection threads, or nullptr if they run on the calling connection's thread.
+    /// Stays valid until the server is deleted, so connection threads may still post to it during shutdown.
+    Server_GameExecutor *getGameExecutor() const
+    {
+        return gameExecutor;
+    }
+    Server_RateLimiter &getRateLimiter()
+    {
+        return rateLimiter;
+    }
+    /// The timer wheel of the calling thread for @p clock, created on first use and deleted with its last user.
+    QSharedPointer<Server_TimerWheel> getTimerWheel(Server_TimerWheel::Clock clock);
     int getNextLocalGameId()
     {
         QMutexLocker locker(&nextLocalGameIdMutex);
@@ -193,6 +251,11 @@ public:
     {
         return externalUsers;
     }
+    /// The local and external users as listed to clients. Lock clientsLock before calling this.
+    const Server_UserDirectory &getUserDirectory() const
+    {
+        return userDirectory;
+    }
 
     void addPersistentPlayer(const QString &userName, int roomId, int gameId, int playerId);
     void removePersistentPlayer(const QString &userName, int roomId, int gameId, int playerId);
@@ -212,7 +275,12 @@ private:
     QMultiMap<QString, PlayerReference> persistentPlayers;
     mutable QReadWriteLock persistentPlayersLock;
     int nextLocalGameId, tcpUserCount, webSocketUserCount;
+    Server_GameExecutor *gameExecutor;
     QMutex nextLocalGameIdMutex;
+    QMutex timerWheelsMutex;
+    Server_RateLimiter rateLimiter;
+    Server_UserDirectory userDirectory;
+    QHash<QPair<QThread *, int>, QWeakPointer<Server_TimerWheel>> timerWheels;
 
 protected slots:
     void externalUserJoined(const ServerInfo_User &userInfo);
@@ -235,8 +303,17 @@ protected slots:
 
 protected:
     void prepareDestroy();
+    void startGameExecutor(int threadCount);
+    /// Returns the database interface game commands use on executor thread @p thread, already moved to that thread.
+    virtual Server_DatabaseInterface *createGameThreadDatabaseInterface(int /* threadNumber */, QThread * /* thread */)
+    {
+        return nullptr;
+    }
+    void loadRateLimits();
+    void loadUserDirectorySettings();
     void setDatabaseInterface(Server_DatabaseInterface *_databaseInterface);
     QList<Server_ProtocolHandler *> clients;
+    QHash<QString, QList<Server_ProtocolHandler *>> clientsByAddress;
     QMap<qint64, Server_ProtocolHandler *> usersBySessionId;
     QMap<QString, Server_ProtocolHandler *> users;
     QMap<qint64, Server_AbstractUserInterface *> externalUsersBySessionId;
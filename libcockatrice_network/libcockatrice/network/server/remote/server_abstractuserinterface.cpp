@@ -3,6 +3,7 @@
 #include "game/server_game.h"
 #include "game/server_player.h"
 #include "server.h"
+#include "server_message_frame.h"
 #include "server_player_reference.h"
 #include "server_response_containers.h"
 #include "server_room.h"
@@ -52,14 +53,23 @@ void Server_AbstractUserInterface::sendResponseContainer(const ResponseContainer
         Response response;
         response.set_cmd_id(responseContainer.getCmdId());
         response.set_response_code(responseCode);
+        const QByteArray &encodedExtension = responseContainer.getEncodedResponseExtension();
         ::google::protobuf::Message *responseExtension = responseContainer.getResponseExtension();
-        if (responseExtension)
-            response.GetReflection()
-                ->MutableMessage(&response, responseExtension->GetDescriptor()->FindExtensionByName("ext"))
-                ->CopyFrom(*responseExtension);
-        sendProtocolItem(response);
+        if (!encodedExtension.isEmpty()) {
+            // encoded once and shared, e.g. by everyone joining the same room
+            sendProtocolItem(ServerMessageFrame(response, encodedExtension));
+        } else {
+            if (responseExtension)
+                response.GetReflection()
+                    ->MutableMessage(&response, responseExtension->GetDescriptor()->FindExtensionByName("ext"))
+                    ->CopyFrom(*responseExtension);
+            sendProtocolItem(response);
+        }
     }
 
+    for (const ServerMessageFrame &frame : responseContainer.getPostResponseFrames())
+        sendProtocolItem(frame);
+
     const QList<QPair<ServerMessage::MessageType, ::google::protobuf::Message *>> &postResponseQueue =
         responseContainer.getPostResponseQueue();
     for (int i = 0; i < postResponseQueue.size(); ++i)
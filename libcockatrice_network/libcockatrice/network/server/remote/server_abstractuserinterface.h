@@ -12,6 +12,7 @@ class SessionEvent;
 class GameEventContainer;
 class RoomEvent;
 class ResponseContainer;
+class ServerMessageFrame;
 
 class Server;
 class Server_Game;
@@ -53,6 +54,7 @@ public:
     virtual void sendProtocolItem(const SessionEvent &item) = 0;
     virtual void sendProtocolItem(const GameEventContainer &item) = 0;
     virtual void sendProtocolItem(const RoomEvent &item) = 0;
+    virtual void sendProtocolItem(const ServerMessageFrame &frame) = 0;
     void sendProtocolItemByType(ServerMessage::MessageType type, const ::google::protobuf::Message &item);
 
     static SessionEvent *prepareSessionEvent(const ::google::protobuf::Message &sessionEvent);
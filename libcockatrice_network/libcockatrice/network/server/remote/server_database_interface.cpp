@@ -1,2 +1,13 @@
-
 #include "server_database_interface.h"
+
+#include "game/server_replay_writer.h"
+
+void Server_DatabaseInterface::storeGameInformation(const QString & /* roomName */,
+                                                    const QStringList & /* roomGameTypes */,
+                                                    const ServerInfo_Game & /* gameInfo */,
+                                                    const QSet<QString> & /* allPlayersEver */,
+                                                    const QSet<QString> & /* allSpectatorsEver */,
+                                                    const QList<Server_ReplayWriter *> &replayList)
+{
+    qDeleteAll(replayList);
+}
@@ -57,14 +57,13 @@ public:
         return false;
     }
     virtual ServerInfo_User getUserData(const QString &name, bool withId = false) = 0;
+    /// Takes ownership of the replays, which may be stored after the call has returned.
     virtual void storeGameInformation(const QString & /* roomName */,
                                       const QStringList & /* roomGameTypes */,
                                       const ServerInfo_Game & /* gameInfo */,
                                       const QSet<QString> & /* allPlayersEver */,
                                       const QSet<QString> & /* allSpectatorsEver */,
-                                      const QList<GameReplay *> & /* replayList */)
-    {
-    }
+                                      const QList<Server_ReplayWriter *> &replayList);
     virtual DeckList *getDeckFromDatabase(int /* deckId */, int /* userId */)
     {
         return 0;
@@ -0,0 +1,103 @@
+#include "server_game_executor.h"
+
+#include <QDebug>
+#include <QObject>
+#include <QThread>
+
+Server_GameExecutor::Server_GameExecutor(int threadCount) : stopped(false), nextWorker(0)
+{
+    for (int i = 0; i < threadCount; ++i) {
+        auto newThread = new QThread;
+        newThread->setObjectName("game_" + QString::number(i));
+        auto newWorker = new QObject;
+        newWorker->moveToThread(newThread);
+        newThread->start();
+
+        threads.append(newThread);
+        workers.append(newWorker);
+    }
+}
+
+Server_GameExecutor::~Server_GameExecutor()
+{
+    stop();
+    // a post() that raced with stop() may still be invoking a worker, so they live as long as the executor
+    qDeleteAll(workers);
+    qDeleteAll(threads);
+}
+
+void Server_GameExecutor::stop()
+{
+    {
+        QMutexLocker locker(&mutex);
+        if (stopped)
+            return;
+        stopped = true;
+    }
+
+    for (QThread *thread : threads) {
+        thread->quit();
+        thread->wait();
+    }
+
+    QMutexLocker locker(&mutex);
+    int droppedJobs = 0;
+    for (const QQueue<Job> &mailbox : mailboxes)
+        droppedJobs += mailbox.size();
+    if (droppedJobs > 0)
+        qDebug() << "Server_GameExecutor: dropped" << droppedJobs << "pending jobs on shutdown";
+}
+
+void Server_GameExecutor::post(int gameId, Job job)
+{
+    {
+        QMutexLocker locker(&mutex);
+        if (stopped)
+            return;
+        auto mailbox = mailboxes.find(gameId);
+        if (mailbox != mailboxes.end()) {
+            // the game is already queued or running; whoever runs it will pick this job up
+            mailbox->enqueue(std::move(job));
+            return;
+        }
+        mailboxes[gameId].enqueue(std::move(job));
+        readyGames.enqueue(gameId);
+    }
+
+    // Any worker can run any game. The one woken up here may be busy, but the next idle worker that is woken up
+    // drains the whole ready queue, so a game only waits behind another one when every worker is busy.
+    QObject *worker = workers[static_cast<int>(nextWorker.fetchAndAddRelaxed(1) % workers.size())];
+    QMetaObject::invokeMethod(worker, [this] { runReadyGames(); }, Qt::QueuedConnection);
+}
+
+void Server_GameExecutor::runReadyGames()
+{
+    forever {
+        int gameId;
+        {
+            QMutexLocker locker(&mutex);
+            if (readyGames.isEmpty())
+                return;
+            gameId = readyGames.dequeue();
+        }
+
+        for (int i = 0; i <= maxJobsPerTurn; ++i) {
+            Job job;
+            {
+                QMutexLocker locker(&mutex);
+                auto mailbox = mailboxes.find(gameId);
+                if (mailbox->isEmpty()) {
+                    mailboxes.erase(mailbox);
+                    break;
+                }
+                if (i == maxJobsPerTurn) {
+                    // turn is used up, let the other ready games run first
+                    readyGames.enqueue(gameId);
+                    break;
+                }
+                job = mailbox->dequeue();
+            }
+            job();
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef SERVER_GAME_EXECUTOR_H
+#define SERVER_GAME_EXECUTOR_H
+
+#include <QAtomicInteger>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QQueue>
+#include <functional>
+
+class QObject;
+class QThread;
+
+/**
+ * Runs game commands on a dedicated set of threads, one game at a time.
+ *
+ * Every game has a mailbox of jobs that are executed in the order they were posted and never concurrently with each
+ * other, so a protocol handler can hand off a command container without waiting for the room and game locks. Games
+ * with pending jobs are kept in a single ready queue that all worker threads pull from; a game gives up its turn after
+ * a few jobs so that a busy game can't starve the others.
+ *
+ * The workers run event loops, since game commands create QObjects and rely on deleteLater().
+ */
+class Server_GameExecutor
+{
+public:
+    using Job = std::function<void()>;
+
+private:
+    static const int maxJobsPerTurn = 16;
+
+    QMutex mutex;
+    QHash<int, QQueue<Job>> mailboxes; // a game has an entry while it has jobs queued or running
+    QQueue<int> readyGames;
+    bool stopped;
+    QList<QThread *> threads;
+    QList<QObject *> workers;
+    QAtomicInteger<quint32> nextWorker;
+
+    void runReadyGames();
+
+public:
+    explicit Server_GameExecutor(int threadCount);
+    ~Server_GameExecutor();
+
+    /// Jobs posted after stop() are dropped.
+    void post(int gameId, Job job);
+    /// Waits for the running jobs and stops the threads. The executor stays valid, so late posts are harmless.
+    void stop();
+    [[nodiscard]] int getThreadCount() const
+    {
+        return threads.size();
+    }
+    [[nodiscard]] const QList<QThread *> &getThreads() const
+    {
+        return threads;
+    }
+};
+
+#endif
@@ -0,0 +1,75 @@
+#include "server_game_filter.h"
+
+Server_GameFilter::Server_GameFilter() : userIsRegistered(false)
+{
+}
+
+Server_GameFilter::Server_GameFilter(const ServerInfo_GameFilter &_filter, bool _userIsRegistered)
+    : filter(_filter), userIsRegistered(_userIsRegistered),
+      gameNameFilter(QString::fromStdString(_filter.game_name_filter()))
+{
+    for (const std::string &creatorNameFilter : filter.creator_name_filters())
+        creatorNameFilters.append(QString::fromStdString(creatorNameFilter));
+    for (int gameTypeId : filter.game_type_ids())
+        gameTypeIds.insert(gameTypeId);
+}
+
+bool Server_GameFilter::accepts(const ServerInfo_Game &game, qint64 now) const
+{
+    if (filter.hide_buddies_only_games() && game.only_buddies())
+        return false;
+    if (filter.hide_open_decklist_games() && game.share_decklists_on_load())
+        return false;
+    if (filter.hide_full_games() && game.player_count() == game.max_players())
+        return false;
+    if (filter.hide_games_that_started() && game.started())
+        return false;
+    if (!userIsRegistered && game.only_registered())
+        return false;
+    if (filter.hide_password_protected_games() && game.with_password())
+        return false;
+    if (!gameNameFilter.isEmpty() &&
+        !QString::fromStdString(game.description()).contains(gameNameFilter, Qt::CaseInsensitive))
+        return false;
+    if (!creatorNameFilters.isEmpty()) {
+        const QString creatorName = QString::fromStdString(game.creator_info().name());
+        bool found = false;
+        for (const QString &creatorNameFilter : creatorNameFilters)
+            if (creatorName.contains(creatorNameFilter, Qt::CaseInsensitive)) {
+                found = true;
+                break;
+            }
+        if (!found)
+            return false;
+    }
+
+    if (!gameTypeIds.isEmpty()) {
+        bool found = false;
+        for (int gameType : game.game_types())
+            if (gameTypeIds.contains(gameType)) {
+                found = true;
+                break;
+            }
+        if (!found)
+            return false;
+    }
+
+    if (game.max_players() < filter.max_players_min() || game.max_players() > filter.max_players_max())
+        return false;
+
+    const qint64 gameAge = now - static_cast<qint64>(game.start_time());
+    if (filter.max_game_age_seconds() != 0 && gameAge > static_cast<qint64>(filter.max_game_age_seconds()))
+        return false;
+
+    if (filter.show_only_if_spectators_can_watch()) {
+        if (!game.spectators_allowed())
+            return false;
+        if (!filter.show_spectator_password_protected() && game.spectators_need_password())
+            return false;
+        if (filter.show_only_if_spectators_can_chat() && !game.spectators_can_chat())
+            return false;
+        if (filter.show_only_if_spectators_can_see_hands() && !game.spectators_omniscient())
+            return false;
+    }
+    return true;
+}
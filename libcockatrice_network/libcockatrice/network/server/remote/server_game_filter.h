@@ -0,0 +1,48 @@
+#ifndef SERVER_GAME_FILTER_H
+#define SERVER_GAME_FILTER_H
+
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <libcockatrice/protocol/pb/serverinfo_game.pb.h>
+#include <libcockatrice/protocol/pb/serverinfo_game_filter.pb.h>
+
+/**
+ * The game list filter a client registered for a room, see ServerInfo_GameFilter.
+ *
+ * Mirrors GamesProxyModel::filterAcceptsRow() on the client, except for the parts that depend on the client's
+ * buddy and ignore lists. The strings and game types are converted once, as a room checks every changed game
+ * against the filter of every filtering user.
+ */
+class Server_GameFilter
+{
+private:
+    ServerInfo_GameFilter filter;
+    bool userIsRegistered;
+    QString gameNameFilter;
+    QStringList creatorNameFilters;
+    QSet<int> gameTypeIds;
+
+public:
+    Server_GameFilter();
+    Server_GameFilter(const ServerInfo_GameFilter &_filter, bool _userIsRegistered);
+
+    /// The game types a game needs one of to pass, empty if all game types pass.
+    [[nodiscard]] const QSet<int> &getGameTypeIds() const
+    {
+        return gameTypeIds;
+    }
+    [[nodiscard]] bool hidesStartedGames() const
+    {
+        return filter.hide_games_that_started();
+    }
+    /// The most games the client's list holds at a time, 0 if there is no limit.
+    [[nodiscard]] int getPageSize() const
+    {
+        return static_cast<int>(filter.page_size());
+    }
+    /// @p now is the current time in seconds since epoch, for the maximum game age.
+    [[nodiscard]] bool accepts(const ServerInfo_Game &game, qint64 now) const;
+};
+
+#endif
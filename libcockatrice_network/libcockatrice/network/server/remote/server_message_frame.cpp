@@ -0,0 +1,141 @@
+#include "server_message_frame.h"
+
+#include <cstring>
+#include <libcockatrice/protocol/frame_reader.h>
+
+ServerMessageFrame::ServerMessageFrame(const ServerMessage &_message) : message(new ServerMessage(_message))
+{
+    encode();
+}
+
+ServerMessageFrame::ServerMessageFrame(const Response &item)
+{
+    auto *msg = new ServerMessage;
+    msg->mutable_response()->CopyFrom(item);
+    msg->set_message_type(ServerMessage::RESPONSE);
+    message.reset(msg);
+    encode();
+}
+
+ServerMessageFrame::ServerMessageFrame(const SessionEvent &item)
+{
+    auto *msg = new ServerMessage;
+    msg->mutable_session_event()->CopyFrom(item);
+    msg->set_message_type(ServerMessage::SESSION_EVENT);
+    message.reset(msg);
+    encode();
+}
+
+ServerMessageFrame::ServerMessageFrame(const GameEventContainer &item)
+{
+    auto *msg = new ServerMessage;
+    msg->mutable_game_event_container()->CopyFrom(item);
+    msg->set_message_type(ServerMessage::GAME_EVENT_CONTAINER);
+    message.reset(msg);
+    encode();
+}
+
+ServerMessageFrame::ServerMessageFrame(const RoomEvent &item)
+{
+    auto *msg = new ServerMessage;
+    msg->mutable_room_event()->CopyFrom(item);
+    msg->set_message_type(ServerMessage::ROOM_EVENT);
+    message.reset(msg);
+    encode();
+}
+
+ServerMessageFrame::ServerMessageFrame(const Response &head, const QByteArray &encodedFields)
+    : decoded(new DecodedMessage)
+{
+    const std::string headFields = head.SerializeAsString();
+    QByteArray response;
+    response.reserve(static_cast<int>(headFields.size()) + encodedFields.size());
+    response.append(headFields.data(), static_cast<int>(headFields.size()));
+    response.append(encodedFields);
+
+    ServerMessage msg;
+    msg.set_message_type(ServerMessage::RESPONSE);
+    const std::string messageFields = msg.SerializeAsString();
+    frame.reserve(headerSize + static_cast<int>(messageFields.size()) + response.size() + 10);
+    frame.resize(headerSize);
+    frame.append(messageFields.data(), static_cast<int>(messageFields.size()));
+    appendEncodedField(frame, ServerMessage::kResponseFieldNumber, response);
+    setHeader();
+}
+
+void ServerMessageFrame::appendEncodedField(QByteArray &out, int fieldNumber, const QByteArray &encoded)
+{
+    // tag and length of a length-delimited field, both as varints
+    const int wireTypeLengthDelimited = 2;
+    for (quint32 value : {static_cast<quint32>((fieldNumber << 3) | wireTypeLengthDelimited),
+                          static_cast<quint32>(encoded.size())}) {
+        while (value >= 0x80) {
+            out.append(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out.append(static_cast<char>(value));
+    }
+    out.append(encoded);
+}
+
+void ServerMessageFrame::writeHeader(char *data, quint32 header)
+{
+    data[3] = (unsigned char)header;
+    data[2] = (unsigned char)(header >> 8);
+    data[1] = (unsigned char)(header >> 16);
+    data[0] = (unsigned char)(header >> 24);
+}
+
+void ServerMessageFrame::encode()
+{
+#if GOOGLE_PROTOBUF_VERSION > 3001000
+    unsigned int size = static_cast<unsigned int>(message->ByteSizeLong());
+#else
+    unsigned int size = static_cast<unsigned int>(message->ByteSize());
+#endif
+    frame.resize(size + headerSize);
+    message->SerializeToArray(frame.data() + headerSize, size);
+    setHeader();
+}
+
+void ServerMessageFrame::setHeader()
+{
+    const unsigned int size = static_cast<unsigned int>(frame.size() - headerSize);
+    writeHeader(frame.data(), size);
+
+    if (size >= static_cast<unsigned int>(minCompressedPayloadSize))
+        compressed.reset(new CompressedFrame);
+}
+
+const ServerMessage &ServerMessageFrame::getMessage() const
+{
+    if (message)
+        return *message;
+
+    QMutexLocker locker(&decoded->mutex);
+    if (!decoded->done) {
+        decoded->done = true;
+        decoded->message.ParseFromArray(frame.constData() + headerSize, frame.size() - headerSize);
+    }
+    return decoded->message;
+}
+
+const QByteArray &ServerMessageFrame::getCompressedFrame() const
+{
+    if (!compressed)
+        return frame;
+
+    QMutexLocker locker(&compressed->mutex);
+    if (!compressed->done) {
+        compressed->done = true;
+        QByteArray body = FrameReader::compressPayload(getPayload());
+        if (body.size() + headerSize < frame.size()) {
+            const quint32 header = FrameReader::compressedFlag | static_cast<quint32>(body.size());
+            QByteArray &result = compressed->frame;
+            result.resize(headerSize + body.size());
+            writeHeader(result.data(), header);
+            memcpy(result.data() + headerSize, body.constData(), body.size());
+        }
+    }
+    return compressed->frame.isEmpty() ? frame : compressed->frame;
+}
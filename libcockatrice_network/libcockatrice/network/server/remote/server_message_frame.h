@@ -0,0 +1,104 @@
+#ifndef SERVER_MESSAGE_FRAME_H
+#define SERVER_MESSAGE_FRAME_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QSharedPointer>
+#include <libcockatrice/protocol/pb/server_message.pb.h>
+
+class Response;
+class SessionEvent;
+class GameEventContainer;
+class RoomEvent;
+
+/**
+ * An immutable, pre-encoded ServerMessage.
+ *
+ * The message is serialized exactly once, on construction, into a buffer holding the 4-byte big-endian length
+ * prefix followed by the payload. Copies are cheap (both the buffer and the decoded message are shared), so a
+ * broadcast can build one frame and enqueue it by value into the output queue of every recipient.
+ *
+ * Frames with a large enough payload can also be sent compressed to sessions that negotiated it. The compressed
+ * form is built by the first recipient that asks for it and shared with all other copies.
+ *
+ * A response can also be assembled from fields that were serialized ahead of time, such as a room snapshot served
+ * to every joining user. Such frames are only decoded if a transport asks for the message.
+ */
+class ServerMessageFrame
+{
+private:
+    struct CompressedFrame
+    {
+        QMutex mutex;
+        bool done = false;
+        QByteArray frame; // stays empty if compressing doesn't make the frame smaller
+    };
+    struct DecodedMessage
+    {
+        QMutex mutex;
+        bool done = false;
+        ServerMessage message;
+    };
+
+    QSharedPointer<const ServerMessage> message; // null for frames assembled from pre-encoded fields
+    QSharedPointer<DecodedMessage> decoded;      // which are decoded here on first use instead
+    QByteArray frame;
+    QSharedPointer<CompressedFrame> compressed;
+
+    void encode();
+    void setHeader();
+    static void writeHeader(char *data, quint32 header);
+
+public:
+    static const int headerSize = 4;
+    /// Payloads smaller than this are never compressed, whatever the configured threshold.
+    static const int minCompressedPayloadSize = 256;
+
+    ServerMessageFrame() = default;
+    explicit ServerMessageFrame(const ServerMessage &_message);
+    explicit ServerMessageFrame(const Response &item);
+    explicit ServerMessageFrame(const SessionEvent &item);
+    explicit ServerMessageFrame(const GameEventContainer &item);
+    explicit ServerMessageFrame(const RoomEvent &item);
+    /**
+     * A response made of @p head followed by @p encodedFields, the serialized fields of a Response that @p head
+     * leaves unset (usually a response extension).
+     */
+    ServerMessageFrame(const Response &head, const QByteArray &encodedFields);
+
+    /// Appends field @p fieldNumber with the serialized message @p encoded to @p out.
+    static void appendEncodedField(QByteArray &out, int fieldNumber, const QByteArray &encoded);
+
+    [[nodiscard]] bool isNull() const
+    {
+        return frame.isEmpty();
+    }
+    /// The decoded message, for transports that do not write to a socket (local games, ISL). Thread-safe.
+    [[nodiscard]] const ServerMessage &getMessage() const;
+    /// Length prefix followed by the payload, as written to TCP sockets.
+    [[nodiscard]] const QByteArray &getFrame() const
+    {
+        return frame;
+    }
+    /// The payload without the length prefix. The returned array references this frame's buffer and must not
+    /// outlive it.
+    [[nodiscard]] QByteArray getPayload() const
+    {
+        return QByteArray::fromRawData(frame.constData() + headerSize, frame.size() - headerSize);
+    }
+    [[nodiscard]] qsizetype getFrameSize() const
+    {
+        return frame.size();
+    }
+    [[nodiscard]] qsizetype getPayloadSize() const
+    {
+        return frame.size() - headerSize;
+    }
+    /**
+     * The frame with its payload compressed and FrameReader::compressedFlag set in the length prefix, or the plain
+     * frame if its payload is too small or doesn't compress. Thread-safe.
+     */
+    [[nodiscard]] const QByteArray &getCompressedFrame() const;
+};
+
+#endif
@@ -3,6 +3,8 @@
 #include "game/server_game.h"
 #include "game/server_player.h"
 #include "server_database_interface.h"
+#include "server_game_executor.h"
+#include "server_message_frame.h"
 #include "server_room.h"
 
 #include <QDateTime>
@@ -22,25 +24,48 @@
 #include <libcockatrice/protocol/pb/response.pb.h>
 #include <libcockatrice/protocol/pb/response_get_games_of_user.pb.h>
 #include <libcockatrice/protocol/pb/response_get_user_info.pb.h>
-#include <libcockatrice/protocol/pb/response_join_room.pb.h>
 #include <libcockatrice/protocol/pb/response_list_users.pb.h>
 #include <libcockatrice/protocol/pb/response_login.pb.h>
 #include <libcockatrice/protocol/pb/serverinfo_user.pb.h>
 #include <libcockatrice/utility/trice_limits.h>
 
+static bool isSubjectToIdleTimeout(const ServerInfo_User *userInfo)
+{
+    // PrivLevel users, Moderators, and Admins are not subject to the server idle timeout policy
+    const bool hasPrivLevel = userInfo && QString::fromStdString(userInfo->privlevel()).toLower() != "none";
+    const bool isModOrAdmin =
+        userInfo && (userInfo->user_level() & (ServerInfo_User::IsModerator | ServerInfo_User::IsAdmin));
+    return !hasPrivLevel && !isModOrAdmin;
+}
+
 Server_ProtocolHandler::Server_ProtocolHandler(Server *_server,
                                                Server_DatabaseInterface *_databaseInterface,
                                                QObject *parent)
     : QObject(parent), Server_AbstractUserInterface(_server), deleted(false), databaseInterface(_databaseInterface),
-      authState(NotLoggedIn), usingRealPassword(false), acceptsUserListChanges(false), acceptsRoomListChanges(false),
-      idleClientWarningSent(false), timeRunning(0), lastDataReceived(0), lastActionReceived(0)
-
+      authState(NotLoggedIn), usingRealPassword(false), acceptsUserListChanges(false), userListOnlyNamedUsers(false),
+      acceptsRoomListChanges(false), idleClientWarningSent(false), compressionThreshold(0), timeoutTimerId(0),
+      lastDataReceived(0), lastActionReceived(0)
 {
-    connect(server, &Server::pingClockTimeout, this, &Server_ProtocolHandler::pingClockTimeout);
 }
 
 Server_ProtocolHandler::~Server_ProtocolHandler()
 {
+    if (timeoutTimerId)
+        timerWheel->cancel(timeoutTimerId);
+}
+
+void Server_ProtocolHandler::startTimeoutChecks()
+{
+    if (timerWheel)
+        return;
+    timerWheel = server->getTimerWheel(Server_TimerWheel::PingClock);
+    lastDataReceived = lastActionReceived = currentTick();
+    scheduleTimeoutCheck();
+}
+
+void Server_ProtocolHandler::startFloodControl()
+{
+    addressFloodBuckets = server->getRateLimiter().getAddressBuckets(getAddress());
 }
 
 // This function must only be called from the thread this object lives in.
@@ -128,6 +153,17 @@ void Server_ProtocolHandler::sendProtocolItem(const RoomEvent &item)
     transmitProtocolItem(msg);
 }
 
+void Server_ProtocolHandler::sendProtocolItem(const ServerMessageFrame &frame)
+{
+    transmitProtocolFrame(frame);
+}
+
+void Server_ProtocolHandler::transmitProtocolFrame(const ServerMessageFrame &frame)
+{
+    // Transports without a socket of their own don't benefit from the pre-encoded buffer.
+    transmitProtocolItem(frame.getMessage());
+}
+
 Response::ResponseCode Server_ProtocolHandler::processSessionCommandContainer(const CommandContainer &cont,
                                                                               ResponseContainer &rc)
 {
@@ -205,6 +241,12 @@ Response::ResponseCode Server_ProtocolHandler::processRoomCommandContainer(const
             case RoomCommand::JOIN_GAME:
                 resp = cmdJoinGame(sc.GetExtension(Command_JoinGame::ext), room, rc);
                 break;
+            case RoomCommand::SET_GAME_FILTER:
+                resp = cmdSetGameFilter(sc.GetExtension(Command_SetGameFilter::ext), room, rc);
+                break;
+            case RoomCommand::NEXT_GAME_PAGE:
+                resp = cmdNextGamePage(sc.GetExtension(Command_NextGamePage::ext), room, rc);
+                break;
         }
         if (resp != Response::RespOk)
             finalResponseCode = resp;
@@ -215,23 +257,6 @@ Response::ResponseCode Server_ProtocolHandler::processRoomCommandContainer(const
 Response::ResponseCode Server_ProtocolHandler::processGameCommandContainer(const CommandContainer &cont,
                                                                            ResponseContainer &rc)
 {
-    static QList<GameCommand::GameCommandType> antifloodCommandsWhiteList =
-        QList<GameCommand::GameCommandType>()
-        // draw/undo card draw (example: drawing 10 cards one by one from the deck)
-        << GameCommand::DRAW_CARDS
-        << GameCommand::UNDO_DRAW
-        // create, delete arrows (example: targeting with 10 cards during an attack)
-        << GameCommand::CREATE_ARROW
-        << GameCommand::DELETE_ARROW
-        // set card attributes (example: tapping 10 cards at once)
-        << GameCommand::SET_CARD_ATTR
-        // increment / decrement counter (example: -10 life points one by one)
-        << GameCommand::INC_COUNTER
-        // mulling lots of hands in a row
-        << GameCommand::MULLIGAN
-        // allows a user to sideboard without receiving flooding message
-        << GameCommand::MOVE_CARD;
-
     if (authState == NotLoggedIn)
         return Response::RespLoginNeeded;
 
@@ -240,8 +265,60 @@ Response::ResponseCode Server_ProtocolHandler::processGameCommandContainer(const
         return Response::RespNotInRoom;
     const QPair<int, int> roomIdAndPlayerId = gameMap.value(cont.game_id());
 
+    resetIdleTimer();
+
+    // Commands are processed from the last to the first; once the flood limit is hit, the remaining ones are dropped.
+    int commandCount = cont.game_command_size();
+    Server_RateLimiter &rateLimiter = server->getRateLimiter();
+    for (int i = cont.game_command_size() - 1; i >= 0; --i) {
+        const GameCommand &sc = cont.game_command(i);
+        if (!rateLimiter.allowGameCommand(floodBuckets, addressFloodBuckets.data(),
+                                          static_cast<GameCommand::GameCommandType>(getPbExtension(sc)))) {
+            commandCount = cont.game_command_size() - 1 - i;
+            break;
+        }
+
+        logDebugMessage(QString("game %1 player %2: ").arg(cont.game_id()).arg(roomIdAndPlayerId.second) +
+                        getSafeDebugString(sc));
+    }
+    if (commandCount == 0)
+        return Response::RespChatFlood;
+
+    const qint64 sessionId = userInfo->session_id();
+    Server_GameExecutor *gameExecutor = server->getGameExecutor();
+    if (!gameExecutor)
+        return executeGameCommands(server, cont, roomIdAndPlayerId.first, roomIdAndPlayerId.second, sessionId,
+                                   commandCount, rc);
+
+    // This handler may be gone by the time the commands have run, so the response is sent to whichever handler
+    // still owns the session.
+    Server *_server = server;
+    gameExecutor->post(cont.game_id(), [_server, cont, roomIdAndPlayerId, sessionId, commandCount] {
+        ResponseContainer responseContainer(static_cast<int>(cont.cmd_id()));
+        const Response::ResponseCode responseCode =
+            executeGameCommands(_server, cont, roomIdAndPlayerId.first, roomIdAndPlayerId.second, sessionId,
+                                commandCount, responseContainer);
+        if (responseCode == Response::RespNothing)
+            return;
+
+        QReadLocker clientsLocker(&_server->clientsLock);
+        Server_ProtocolHandler *handler = _server->getUsersBySessionId().value(sessionId);
+        if (handler)
+            handler->sendResponseContainer(responseContainer, responseCode);
+    });
+    return Response::RespNothing;
+}
+
+Response::ResponseCode Server_ProtocolHandler::executeGameCommands(Server *server,
+                                                                   const CommandContainer &cont,
+                                                                   int roomId,
+                                                                   int playerId,
+                                                                   qint64 sessionId,
+                                                                   int commandCount,
+                                                                   ResponseContainer &rc)
+{
     QReadLocker roomsLocker(&server->roomsLock);
-    Server_Room *room = server->getRooms().value(roomIdAndPlayerId.first);
+    Server_Room *room = server->getRooms().value(roomId);
     if (!room)
         return Response::RespNotInRoom;
 
@@ -249,53 +326,31 @@ Response::ResponseCode Server_ProtocolHandler::processGameCommandContainer(const
     Server_Game *game = room->getGames().value(cont.game_id());
     if (!game) {
         if (room->getExternalGames().contains(cont.game_id())) {
-            server->sendIsl_GameCommand(cont, room->getExternalGames().value(cont.game_id()).server_id(),
-                                        userInfo->session_id(), roomIdAndPlayerId.first, roomIdAndPlayerId.second);
+            server->sendIsl_GameCommand(cont, room->getExternalGames().value(cont.game_id()).server_id(), sessionId,
+                                        roomId, playerId);
             return Response::RespNothing;
         }
         return Response::RespNotInRoom;
     }
 
     QMutexLocker gameLocker(&game->gameMutex);
-    auto *participant = game->getParticipants().value(roomIdAndPlayerId.second);
+    auto *participant = game->getParticipants().value(playerId);
     if (!participant)
         return Response::RespNotInRoom;
 
-    resetIdleTimer();
-
-    int commandCountingInterval = server->getCommandCountingInterval();
-    int maxCommandCountPerInterval = server->getMaxCommandCountPerInterval();
     GameEventStorage ges;
     Response::ResponseCode finalResponseCode = Response::RespOk;
-    for (int i = cont.game_command_size() - 1; i >= 0; --i) {
-        const GameCommand &sc = cont.game_command(i);
-        logDebugMessage(QString("game %1 player %2: ").arg(cont.game_id()).arg(roomIdAndPlayerId.second) +
-                        getSafeDebugString(sc));
-
-        if (commandCountingInterval > 0) {
-            int totalCount = 0;
-            if (commandCountOverTime.isEmpty())
-                commandCountOverTime.prepend(0);
-
-            if (!antifloodCommandsWhiteList.contains((GameCommand::GameCommandType)getPbExtension(sc)))
-                ++commandCountOverTime[0];
-
-            for (int count : commandCountOverTime) {
-                totalCount += count;
-            }
-
-            if (maxCommandCountPerInterval > 0 && totalCount > maxCommandCountPerInterval) {
-                return Response::RespChatFlood;
-            }
-        }
-
-        Response::ResponseCode resp = participant->processGameCommand(sc, rc, ges);
+    const int lastCommand = cont.game_command_size() - commandCount;
+    for (int i = cont.game_command_size() - 1; i >= lastCommand; --i) {
+        Response::ResponseCode resp = participant->processGameCommand(cont.game_command(i), rc, ges);
 
         if (resp != Response::RespOk)
             finalResponseCode = resp;
     }
     ges.sendToGame(game);
 
+    if (commandCount < cont.game_command_size())
+        return Response::RespChatFlood;
     return finalResponseCode;
 }
 
@@ -353,7 +408,7 @@ void Server_ProtocolHandler::processCommandContainer(const CommandContainer &con
     if (deleted)
         return;
 
-    lastDataReceived = timeRunning;
+    lastDataReceived = currentTick();
 
     ResponseContainer responseContainer(cont.has_cmd_id() ? cont.cmd_id() : -1);
     Response::ResponseCode finalResponseCode;
@@ -375,50 +430,45 @@ void Server_ProtocolHandler::processCommandContainer(const CommandContainer &con
         sendResponseContainer(responseContainer, finalResponseCode);
 }
 
-void Server_ProtocolHandler::pingClockTimeout()
+// Sleeps until the earliest tick at which checkTimeouts() could act. Incoming data only moves the deadlines, the
+// check that wakes up too early notices that and goes back to sleep.
+void Server_ProtocolHandler::scheduleTimeoutCheck()
 {
+    qint64 deadline = lastDataReceived + server->getMaxPlayerInactivityTime() + 1;
 
-    int cmdcountinterval = server->getCommandCountingInterval();
-    int msgcountinterval = server->getMessageCountingInterval();
-    int pingclockinterval = server->getClientKeepAlive();
-
-    int interval = server->getMessageCountingInterval();
-    if (interval > 0) {
-        if (pingclockinterval > 0) {
-            messageSizeOverTime.prepend(0);
-            if (messageSizeOverTime.size() > (msgcountinterval / pingclockinterval))
-                messageSizeOverTime.removeLast();
-            messageCountOverTime.prepend(0);
-            if (messageCountOverTime.size() > (msgcountinterval / pingclockinterval))
-                messageCountOverTime.removeLast();
-        }
+    const int idleClientTimeout = server->getIdleClientTimeout();
+    if (idleClientTimeout > 0 && isSubjectToIdleTimeout(userInfo)) {
+        if (idleClientWarningSent)
+            deadline = qMin(deadline, lastActionReceived + idleClientTimeout + 1);
+        else
+            deadline = qMin(deadline, lastActionReceived + qCeil(idleClientTimeout * .9));
     }
 
-    interval = server->getCommandCountingInterval();
-    if (interval > 0) {
-        if (pingclockinterval > 0) {
-            commandCountOverTime.prepend(0);
-            if (commandCountOverTime.size() > (cmdcountinterval / pingclockinterval))
-                commandCountOverTime.removeLast();
-        }
-    }
+    timeoutTimerId = timerWheel->scheduleAt(deadline, [this] { checkTimeouts(); });
+}
+
+void Server_ProtocolHandler::checkTimeouts()
+{
+    timeoutTimerId = 0;
+    if (deleted)
+        return;
 
-    if (timeRunning - lastDataReceived > server->getMaxPlayerInactivityTime())
+    const qint64 now = currentTick();
+    if (now - lastDataReceived > server->getMaxPlayerInactivityTime()) {
         prepareDestroy();
+        return;
+    }
 
-    // PrivLevel users, Moderators, and Admins are not subject to the server idle timeout policy
-    const bool hasPrivLevel = userInfo && QString::fromStdString(userInfo->privlevel()).toLower() != "none";
-    const bool isModOrAdmin =
-        userInfo && (userInfo->user_level() & (ServerInfo_User::IsModerator | ServerInfo_User::IsAdmin));
-    if (!hasPrivLevel && !isModOrAdmin) {
+    if (isSubjectToIdleTimeout(userInfo)) {
         if ((server->getIdleClientTimeout() > 0) && (idleClientWarningSent)) {
-            if (timeRunning - lastActionReceived > server->getIdleClientTimeout()) {
+            if (now - lastActionReceived > server->getIdleClientTimeout()) {
                 prepareDestroy();
+                return;
             }
         }
 
-        if (((timeRunning - lastActionReceived) >= qCeil(server->getIdleClientTimeout() * .9)) &&
-            (!idleClientWarningSent) && (server->getIdleClientTimeout() > 0)) {
+        if (((now - lastActionReceived) >= qCeil(server->getIdleClientTimeout() * .9)) && (!idleClientWarningSent) &&
+            (server->getIdleClientTimeout() > 0)) {
             Event_NotifyUser event;
             event.set_type(Event_NotifyUser::IDLEWARNING);
             SessionEvent *se = prepareSessionEvent(event);
@@ -428,7 +478,7 @@ void Server_ProtocolHandler::pingClockTimeout()
         }
     }
 
-    ++timeRunning;
+    scheduleTimeoutCheck();
 }
 
 Response::ResponseCode Server_ProtocolHandler::cmdPing(const Command_Ping & /*cmd*/, ResponseContainer & /*rc*/)
@@ -554,6 +604,9 @@ Response::ResponseCode Server_ProtocolHandler::cmdLogin(const Command_Login &cmd
             re->add_missing_features(i.key().toStdString().c_str());
     }
 
+    if (receivedClientFeatures.contains("compression") && server->getCompressionThreshold() > 0)
+        compressionThreshold = qMax(server->getCompressionThreshold(), ServerMessageFrame::minCompressedPayloadSize);
+
     joinPersistentGames(rc);
     databaseInterface->removeForgotPassword(userName);
     rc.setResponseExtension(re);
@@ -692,51 +745,63 @@ Response::ResponseCode Server_ProtocolHandler::cmdJoinRoom(const Command_JoinRoo
         if (!(room->userMayJoin(*userInfo)))
             return Response::RespUserLevelTooLow;
 
-    room->addClient(this);
+    room->addClient(this, cmd.has_game_filter() ? &cmd.game_filter() : nullptr);
     rooms.insert(room->getId(), room);
 
-    QReadLocker chatHistoryLocker(&room->historyLock);
-    QList<ServerInfo_ChatMessage> chatHistory = room->getChatHistory();
-    ServerInfo_ChatMessage chatMessage;
-    for (int i = 0; i < chatHistory.size(); ++i) {
-        chatMessage = chatHistory.at(i);
-        Event_RoomSay roomChatHistory;
-        roomChatHistory.set_message(chatMessage.sender_name() + ": " + chatMessage.message());
-        roomChatHistory.set_message_type(Event_RoomSay::ChatHistory);
-        roomChatHistory.set_time_of(
-            QDateTime::fromString(QString::fromStdString(chatMessage.time())).toMSecsSinceEpoch());
-        rc.enqueuePostResponseItem(ServerMessage::ROOM_EVENT, room->prepareRoomEvent(roomChatHistory));
-    }
+    rc.enqueuePostResponseFrames(room->getChatHistoryFrames());
 
     Event_RoomSay joinMessageEvent;
     joinMessageEvent.set_message(room->getJoinMessage().toStdString());
     joinMessageEvent.set_message_type(Event_RoomSay::Welcome);
     rc.enqueuePostResponseItem(ServerMessage::ROOM_EVENT, room->prepareRoomEvent(joinMessageEvent));
 
-    auto *re = new Response_JoinRoom;
-    room->getInfo(*re->mutable_room_info(), true);
-
-    rc.setResponseExtension(re);
+    rc.setEncodedResponseExtension(room->getEncodedJoinResponse(QString::fromStdString(userInfo->name())));
     return Response::RespOk;
 }
 
-Response::ResponseCode Server_ProtocolHandler::cmdListUsers(const Command_ListUsers & /*cmd*/, ResponseContainer &rc)
+Response::ResponseCode Server_ProtocolHandler::cmdListUsers(const Command_ListUsers &cmd, ResponseContainer &rc)
 {
     if (authState == NotLoggedIn)
         return Response::RespLoginNeeded;
 
-    auto *re = new Response_ListUsers;
-    server->clientsLock.lockForRead();
-    QMapIterator<QString, Server_ProtocolHandler *> userIterator = server->getUsers();
-    while (userIterator.hasNext())
-        re->add_user_list()->CopyFrom(userIterator.next().value()->copyUserInfo(false));
-    QMapIterator<QString, Server_AbstractUserInterface *> extIterator = server->getExternalUsers();
-    while (extIterator.hasNext())
-        re->add_user_list()->CopyFrom(extIterator.next().value()->copyUserInfo(false));
-
-    acceptsUserListChanges = true;
+    QSet<QString> userNames;
+    for (const auto &userName : cmd.user_names())
+        userNames.insert(QString::fromStdString(userName));
+    const QSet<QString> *onlyUserNames = cmd.only_named_users() ? &userNames : nullptr;
+
+    // Changes that happen while the response is put together may reach the client before it, the versions tell
+    // the client which of them the response already includes.
+    server->clientsLock.lockForWrite();
+    acceptsUserListChanges = cmd.subscribe();
+    userListOnlyNamedUsers = cmd.only_named_users();
+    userListNames = userNames;
     server->clientsLock.unlock();
 
+    auto *re = new Response_ListUsers;
+    QReadLocker locker(&server->clientsLock);
+    const Server_UserDirectory &userDirectory = server->getUserDirectory();
+    re->set_epoch(userDirectory.getEpoch());
+    re->set_version(userDirectory.getVersion());
+
+    Server_UserDirectory::Changes changes;
+    if (cmd.has_since_version() &&
+        userDirectory.getChangesSince(cmd.since_epoch(), cmd.since_version(), onlyUserNames, changes)) {
+        re->set_is_delta(true);
+        for (const ServerInfo_User &user : changes.users)
+            re->add_user_list()->CopyFrom(user);
+        for (const QString &userName : changes.leftUserNames)
+            re->add_left_user_names(userName.toStdString());
+    } else {
+        bool hasMore;
+        const QList<ServerInfo_User> users = userDirectory.getPage(QString::fromStdString(cmd.start_after()),
+                                                                   static_cast<int>(cmd.page_size()), onlyUserNames,
+                                                                   hasMore);
+        for (const ServerInfo_User &user : users)
+            re->add_user_list()->CopyFrom(user);
+        re->set_has_more(hasMore);
+    }
+    locker.unlock();
+
     rc.setResponseExtension(re);
     return Response::RespOk;
 }
@@ -751,30 +816,7 @@ Server_ProtocolHandler::cmdLeaveRoom(const Command_LeaveRoom & /*cmd*/, Server_R
 
 bool Server_ProtocolHandler::addSaidMessageSize(int size)
 {
-    if (server->getMessageCountingInterval() <= 0) {
-        return true;
-    }
-
-    int totalSize = 0, totalCount = 0;
-    if (messageSizeOverTime.isEmpty()) {
-        messageSizeOverTime.prepend(0);
-    }
-
-    messageSizeOverTime[0] += size;
-    for (int messageSize : messageSizeOverTime) {
-        totalSize += messageSize;
-    }
-
-    if (messageCountOverTime.isEmpty()) {
-        messageCountOverTime.prepend(0);
-    }
-
-    messageCountOverTime[0] += 1;
-    for (int messageCount : messageCountOverTime) {
-        totalCount += messageCount;
-    }
-
-    return totalSize <= server->getMaxMessageSizePerInterval() && totalCount <= server->getMaxMessageCountPerInterval();
+    return server->getRateLimiter().allowMessage(floodBuckets, addressFloodBuckets.data(), size);
 }
 
 Response::ResponseCode
@@ -796,6 +838,21 @@ Server_ProtocolHandler::cmdRoomSay(const Command_RoomSay &cmd, Server_Room *room
     return Response::RespOk;
 }
 
+Response::ResponseCode Server_ProtocolHandler::cmdSetGameFilter(const Command_SetGameFilter &cmd,
+                                                                Server_Room *room,
+                                                                ResponseContainer & /*rc*/)
+{
+    room->setGameFilter(this, cmd.has_game_filter() ? &cmd.game_filter() : nullptr);
+    return Response::RespOk;
+}
+
+Response::ResponseCode Server_ProtocolHandler::cmdNextGamePage(const Command_NextGamePage & /*cmd*/,
+                                                               Server_Room *room,
+                                                               ResponseContainer & /*rc*/)
+{
+    return room->showNextGamePage(this) ? Response::RespOk : Response::RespContextError;
+}
+
 Response::ResponseCode
 Server_ProtocolHandler::cmdCreateGame(const Command_CreateGame &cmd, Server_Room *room, ResponseContainer &rc)
 {
@@ -860,6 +917,6 @@ Server_ProtocolHandler::cmdJoinGame(const Command_JoinGame &cmd, Server_Room *ro
 
 void Server_ProtocolHandler::resetIdleTimer()
 {
-    lastActionReceived = timeRunning;
+    lastActionReceived = currentTick();
     idleClientWarningSent = false;
 }
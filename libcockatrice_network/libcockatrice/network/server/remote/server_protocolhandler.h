@@ -5,6 +5,7 @@
 #include "server_abstractuserinterface.h"
 
 #include <QObject>
+#include <QSet>
 #include <libcockatrice/protocol/pb/response.pb.h>
 #include <libcockatrice/protocol/pb/server_message.pb.h>
 
@@ -22,6 +23,7 @@ class SessionEvent;
 class GameEventContainer;
 class RoomEvent;
 class ResponseContainer;
+class ServerMessageFrame;
 
 class CommandContainer;
 class SessionCommand;
@@ -39,6 +41,8 @@ class Command_ListRooms;
 class Command_JoinRoom;
 class Command_LeaveRoom;
 class Command_RoomSay;
+class Command_SetGameFilter;
+class Command_NextGamePage;
 class Command_CreateGame;
 class Command_JoinGame;
 
@@ -53,17 +57,25 @@ protected:
     AuthenticationResult authState;
     bool usingRealPassword;
     bool acceptsUserListChanges;
+    bool userListOnlyNamedUsers; // only the changes of userListNames are sent
+    QSet<QString> userListNames;
     bool acceptsRoomListChanges;
     bool idleClientWarningSent;
+    int compressionThreshold; // payloads this large are sent compressed, 0 if the client can't decode them
     virtual void logDebugMessage(const QString & /* message */)
     {
     }
 
 private:
-    QList<int> messageSizeOverTime, messageCountOverTime, commandCountOverTime;
-    int timeRunning, lastDataReceived, lastActionReceived;
+    Server_RateLimiter::Buckets floodBuckets;
+    QSharedPointer<Server_RateLimiter::Buckets> addressFloodBuckets; // null unless per-address limits are set
+    // times are ping clock ticks of timerWheel
+    QSharedPointer<Server_TimerWheel> timerWheel;
+    quint64 timeoutTimerId;
+    qint64 lastDataReceived, lastActionReceived;
 
     virtual void transmitProtocolItem(const ServerMessage &item) = 0;
+    virtual void transmitProtocolFrame(const ServerMessageFrame &frame);
 
     Response::ResponseCode cmdPing(const Command_Ping &cmd, ResponseContainer &rc);
     Response::ResponseCode cmdLogin(const Command_Login &cmd, ResponseContainer &rc);
@@ -75,6 +87,9 @@ private:
     Response::ResponseCode cmdListUsers(const Command_ListUsers &cmd, ResponseContainer &rc);
     Response::ResponseCode cmdLeaveRoom(const Command_LeaveRoom &cmd, Server_Room *room, ResponseContainer &rc);
     Response::ResponseCode cmdRoomSay(const Command_RoomSay &cmd, Server_Room *room, ResponseContainer &rc);
+    Response::ResponseCode
+    cmdSetGameFilter(const Command_SetGameFilter &cmd, Server_Room *room, ResponseContainer &rc);
+    Response::ResponseCode cmdNextGamePage(const Command_NextGamePage &cmd, Server_Room *room, ResponseContainer &rc);
     Response::ResponseCode cmdCreateGame(const Command_CreateGame &cmd, Server_Room *room, ResponseContainer &rc);
     Response::ResponseCode cmdJoinGame(const Command_JoinGame &cmd, Server_Room *room, ResponseContainer &rc);
 
@@ -86,6 +101,14 @@ private:
     }
     Response::ResponseCode processRoomCommandContainer(const CommandContainer &cont, ResponseContainer &rc);
     Response::ResponseCode processGameCommandContainer(const CommandContainer &cont, ResponseContainer &rc);
+    /// Runs the last @p commandCount commands of @p cont. Takes the room and game locks, so it may run on any thread.
+    static Response::ResponseCode executeGameCommands(Server *server,
+                                                      const CommandContainer &cont,
+                                                      int roomId,
+                                                      int playerId,
+                                                      qint64 sessionId,
+                                                      int commandCount,
+                                                      ResponseContainer &rc);
     Response::ResponseCode processModeratorCommandContainer(const CommandContainer &cont, ResponseContainer &rc);
     virtual Response::ResponseCode
     processExtendedModeratorCommand(int /* cmdType */, const ModeratorCommand & /* cmd */, ResponseContainer & /* rc */)
@@ -100,8 +123,12 @@ private:
     }
 
     void resetIdleTimer();
-private slots:
-    void pingClockTimeout();
+    [[nodiscard]] qint64 currentTick() const
+    {
+        return timerWheel ? timerWheel->getCurrentTick() : 0;
+    }
+    void scheduleTimeoutCheck();
+    void checkTimeouts();
 public slots:
     void prepareDestroy();
 
@@ -109,9 +136,10 @@ public:
     Server_ProtocolHandler(Server *_server, Server_DatabaseInterface *_databaseInterface, QObject *parent = 0);
     ~Server_ProtocolHandler();
 
-    bool getAcceptsUserListChanges() const
+    /// Lock Server::clientsLock before calling this, the subscription is changed with it locked for writing.
+    bool getAcceptsUserListChanges(const QString &userName) const
     {
-        return acceptsUserListChanges;
+        return acceptsUserListChanges && (!userListOnlyNamedUsers || userListNames.contains(userName));
     }
     bool getAcceptsRoomListChanges() const
     {
@@ -126,8 +154,12 @@ public:
 
     int getLastCommandTime() const
     {
-        return timeRunning - lastDataReceived;
+        return static_cast<int>(currentTick() - lastDataReceived);
     }
+    /// Starts the inactivity and idle checks on the timer wheel of the calling thread, which must be ours.
+    void startTimeoutChecks();
+    /// Looks up the flood control buckets shared with the other sessions from our address.
+    void startFloodControl();
     bool addSaidMessageSize(int size);
     void processCommandContainer(const CommandContainer &cont);
 
@@ -135,6 +167,7 @@ public:
     void sendProtocolItem(const SessionEvent &item);
     void sendProtocolItem(const GameEventContainer &item);
     void sendProtocolItem(const RoomEvent &item);
+    void sendProtocolItem(const ServerMessageFrame &frame);
 };
 
 #endif
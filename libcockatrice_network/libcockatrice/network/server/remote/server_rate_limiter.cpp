@@ -0,0 +1,150 @@
+#include "server_rate_limiter.h"
+
+Server_RateLimiter::Buckets::Buckets()
+{
+    for (int kind = 0; kind < KindCount; ++kind) {
+        level[kind] = 0;
+        lastRefill[kind] = -1;
+    }
+}
+
+Server_RateLimiter::Server_RateLimiter()
+{
+    limits.exemptCommands = defaultExemptCommands();
+    clock.start();
+}
+
+Server_RateLimiter::CommandSet Server_RateLimiter::defaultExemptCommands()
+{
+    CommandSet commands;
+    for (GameCommand::GameCommandType type : {
+             // draw/undo card draw (example: drawing 10 cards one by one from the deck)
+             GameCommand::DRAW_CARDS, GameCommand::UNDO_DRAW,
+             // create, delete arrows (example: targeting with 10 cards during an attack)
+             GameCommand::CREATE_ARROW, GameCommand::DELETE_ARROW,
+             // set card attributes (example: tapping 10 cards at once)
+             GameCommand::SET_CARD_ATTR,
+             // increment / decrement counter (example: -10 life points one by one)
+             GameCommand::INC_COUNTER,
+             // mulling lots of hands in a row
+             GameCommand::MULLIGAN,
+             // allows a user to sideboard without receiving flooding message
+             GameCommand::MOVE_CARD})
+        commands.set(type - GameCommand::GameCommandType_MIN);
+    return commands;
+}
+
+bool Server_RateLimiter::isAddressLimited() const
+{
+    for (const Limit &limit : limits.perAddress)
+        if (limit.isEnabled())
+            return true;
+    return false;
+}
+
+QSharedPointer<Server_RateLimiter::Buckets> Server_RateLimiter::getAddressBuckets(const QString &address)
+{
+    if (!isAddressLimited())
+        return {};
+
+    QMutexLocker locker(&addressBucketsMutex);
+    QSharedPointer<Buckets> buckets = addressBuckets.value(address).toStrongRef();
+    if (buckets)
+        return buckets;
+
+    // the entry goes away with the last session from this address, unless a new one has replaced it in the meantime
+    buckets = QSharedPointer<Buckets>(new Buckets, [this, address](Buckets *expired) {
+        QMutexLocker locker(&addressBucketsMutex);
+        auto entry = addressBuckets.find(address);
+        if (entry != addressBuckets.end() && entry->isNull())
+            addressBuckets.erase(entry);
+        delete expired;
+    });
+    addressBuckets.insert(address, buckets);
+    return buckets;
+}
+
+bool Server_RateLimiter::hasTokens(Buckets &buckets, const Limit &limit, Kind kind, qint64 amount, qint64 now)
+{
+    const qint64 capacity = limit.maximum * limit.intervalMsecs;
+    qint64 &level = buckets.level[kind];
+    if (buckets.lastRefill[kind] < 0)
+        level = capacity;
+    else
+        level = qMin(capacity, level + (now - buckets.lastRefill[kind]) * limit.maximum);
+    buckets.lastRefill[kind] = now;
+    return level >= amount * limit.intervalMsecs;
+}
+
+void Server_RateLimiter::takeTokens(Buckets &buckets, const Limit &limit, Kind kind, qint64 amount)
+{
+    buckets.level[kind] -= amount * limit.intervalMsecs;
+}
+
+bool Server_RateLimiter::allow(Buckets &sessionBuckets,
+                               Buckets *addressBuckets,
+                               const Kind *kinds,
+                               const qint64 *amounts,
+                               int count)
+{
+    const qint64 now = clock.elapsed();
+
+    // A message is only charged if every bucket it touches has room for it. The session lock is always taken
+    // before the address lock.
+    QMutexLocker sessionLocker(&sessionBuckets.mutex);
+    QMutexLocker addressLocker(addressBuckets ? &addressBuckets->mutex : nullptr);
+
+    bool allowed = true;
+    for (int i = 0; i < count; ++i) {
+        const Limit &sessionLimit = limits.perSession[kinds[i]];
+        if (sessionLimit.isEnabled() && !hasTokens(sessionBuckets, sessionLimit, kinds[i], amounts[i], now))
+            allowed = false;
+        const Limit &addressLimit = limits.perAddress[kinds[i]];
+        if (addressBuckets && addressLimit.isEnabled() &&
+            !hasTokens(*addressBuckets, addressLimit, kinds[i], amounts[i], now))
+            allowed = false;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (!allowed) {
+            droppedCount[kinds[i]].fetchAndAddRelaxed(static_cast<quint64>(amounts[i]));
+            continue;
+        }
+        allowedCount[kinds[i]].fetchAndAddRelaxed(static_cast<quint64>(amounts[i]));
+        if (limits.perSession[kinds[i]].isEnabled())
+            takeTokens(sessionBuckets, limits.perSession[kinds[i]], kinds[i], amounts[i]);
+        if (addressBuckets && limits.perAddress[kinds[i]].isEnabled())
+            takeTokens(*addressBuckets, limits.perAddress[kinds[i]], kinds[i], amounts[i]);
+    }
+    return allowed;
+}
+
+bool Server_RateLimiter::allowMessage(Buckets &sessionBuckets, Buckets *addressBuckets, int size)
+{
+    static const Kind kinds[] = {MessageCount, MessageSize};
+    const qint64 amounts[] = {1, size};
+    return allow(sessionBuckets, addressBuckets, kinds, amounts, 2);
+}
+
+bool Server_RateLimiter::allowGameCommand(Buckets &sessionBuckets,
+                                          Buckets *addressBuckets,
+                                          GameCommand::GameCommandType type)
+{
+    const int index = type - GameCommand::GameCommandType_MIN;
+    if (index >= 0 && index < static_cast<int>(limits.exemptCommands.size()) && limits.exemptCommands.test(index))
+        return true;
+
+    static const Kind kinds[] = {CommandCount};
+    const qint64 amounts[] = {1};
+    return allow(sessionBuckets, addressBuckets, kinds, amounts, 1);
+}
+
+Server_RateLimiter::Counters Server_RateLimiter::takeCounters()
+{
+    Counters counters;
+    for (int kind = 0; kind < KindCount; ++kind) {
+        counters.allowed[kind] = allowedCount[kind].fetchAndStoreRelaxed(0);
+        counters.dropped[kind] = droppedCount[kind].fetchAndStoreRelaxed(0);
+    }
+    return counters;
+}
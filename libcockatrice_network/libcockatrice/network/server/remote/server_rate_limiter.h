@@ -0,0 +1,105 @@
+#ifndef SERVER_RATE_LIMITER_H
+#define SERVER_RATE_LIMITER_H
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QWeakPointer>
+#include <bitset>
+#include <libcockatrice/protocol/pb/game_commands.pb.h>
+
+/**
+ * Flood control for chat messages and game commands.
+ *
+ * Every session has one token bucket for each kind of limit, and so can every address, shared by all sessions
+ * connecting from it. A bucket holds up to the maximum of its limit and is refilled continuously at a rate of the
+ * maximum per interval, so checking and charging a bucket is O(1) no matter how long the interval is.
+ *
+ * The limits are set once by Server::loadRateLimits(); buckets and counters may be used from any thread.
+ */
+class Server_RateLimiter
+{
+public:
+    enum Kind
+    {
+        MessageCount,
+        MessageSize,
+        CommandCount,
+        KindCount
+    };
+
+    struct Limit
+    {
+        int maximum = 0;          // tokens per interval, 0 drops everything
+        qint64 intervalMsecs = 0; // 0 disables the limit
+        [[nodiscard]] bool isEnabled() const
+        {
+            return intervalMsecs > 0;
+        }
+    };
+
+    using CommandSet = std::bitset<GameCommand::GameCommandType_MAX - GameCommand::GameCommandType_MIN + 1>;
+
+    struct Limits
+    {
+        Limit perSession[KindCount];
+        Limit perAddress[KindCount];
+        CommandSet exemptCommands; // game commands that are never counted
+    };
+
+    class Buckets
+    {
+        friend class Server_RateLimiter;
+        QMutex mutex;
+        qint64 level[KindCount];      // tokens times the interval in msecs, so refilling needs no division
+        qint64 lastRefill[KindCount]; // -1 until first used, the bucket starts out full
+
+    public:
+        Buckets();
+    };
+
+    struct Counters
+    {
+        quint64 allowed[KindCount] = {};
+        quint64 dropped[KindCount] = {};
+    };
+
+private:
+    Limits limits;
+    QElapsedTimer clock;
+    QAtomicInteger<quint64> allowedCount[KindCount], droppedCount[KindCount];
+    QMutex addressBucketsMutex;
+    QHash<QString, QWeakPointer<Buckets>> addressBuckets;
+
+    static bool hasTokens(Buckets &buckets, const Limit &limit, Kind kind, qint64 amount, qint64 now);
+    static void takeTokens(Buckets &buckets, const Limit &limit, Kind kind, qint64 amount);
+    bool allow(Buckets &sessionBuckets, Buckets *addressBuckets, const Kind *kinds, const qint64 *amounts, int count);
+
+public:
+    Server_RateLimiter();
+
+    static CommandSet defaultExemptCommands();
+    void setLimits(const Limits &_limits)
+    {
+        limits = _limits;
+    }
+    [[nodiscard]] const Limits &getLimits() const
+    {
+        return limits;
+    }
+    [[nodiscard]] bool isAddressLimited() const;
+
+    /// The buckets shared by all sessions from @p address, or a null pointer if no per-address limit is set.
+    QSharedPointer<Buckets> getAddressBuckets(const QString &address);
+
+    bool allowMessage(Buckets &sessionBuckets, Buckets *addressBuckets, int size);
+    bool allowGameCommand(Buckets &sessionBuckets, Buckets *addressBuckets, GameCommand::GameCommandType type);
+
+    /// Returns the number of allowed and dropped tokens of each kind since the last call.
+    Counters takeCounters();
+};
+
+#endif
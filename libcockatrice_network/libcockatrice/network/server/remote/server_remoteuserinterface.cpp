@@ -1,6 +1,7 @@
 #include "server_remoteuserinterface.h"
 
 #include "server.h"
+#include "server_message_frame.h"
 
 #include <libcockatrice/protocol/pb/serverinfo_user.pb.h>
 
@@ -23,3 +24,23 @@ void Server_RemoteUserInterface::sendProtocolItem(const RoomEvent &item)
 {
     server->sendIsl_RoomEvent(item, userInfo->server_id(), userInfo->session_id());
 }
+
+void Server_RemoteUserInterface::sendProtocolItem(const ServerMessageFrame &frame)
+{
+    // ISL peers re-frame the message themselves, so only the decoded message is forwarded.
+    const ServerMessage &msg = frame.getMessage();
+    switch (msg.message_type()) {
+        case ServerMessage::RESPONSE:
+            sendProtocolItem(msg.response());
+            break;
+        case ServerMessage::SESSION_EVENT:
+            sendProtocolItem(msg.session_event());
+            break;
+        case ServerMessage::GAME_EVENT_CONTAINER:
+            sendProtocolItem(msg.game_event_container());
+            break;
+        case ServerMessage::ROOM_EVENT:
+            sendProtocolItem(msg.room_event());
+            break;
+    }
+}
@@ -1,6 +1,9 @@
 #ifndef SERVER_RESPONSE_CONTAINERS_H
 #define SERVER_RESPONSE_CONTAINERS_H
 
+#include "server_message_frame.h"
+
+#include <QByteArray>
 #include <QList>
 #include <QPair>
 #include <libcockatrice/protocol/pb/server_message.pb.h>
@@ -90,6 +93,8 @@ class ResponseContainer
 private:
     int cmdId;
     ::google::protobuf::Message *responseExtension;
+    QByteArray encodedResponseExtension;
+    QList<ServerMessageFrame> postResponseFrames;
     QList<QPair<ServerMessage::MessageType, ::google::protobuf::Message *>> preResponseQueue, postResponseQueue;
 
 public:
@@ -108,6 +113,15 @@ public:
     {
         return responseExtension;
     }
+    /// Like setResponseExtension(), for an extension field already serialized together with its tag.
+    void setEncodedResponseExtension(const QByteArray &_encodedResponseExtension)
+    {
+        encodedResponseExtension = _encodedResponseExtension;
+    }
+    [[nodiscard]] const QByteArray &getEncodedResponseExtension() const
+    {
+        return encodedResponseExtension;
+    }
     void enqueuePreResponseItem(ServerMessage::MessageType type, ::google::protobuf::Message *item)
     {
         preResponseQueue.append(qMakePair(type, item));
@@ -126,6 +140,15 @@ public:
     {
         return postResponseQueue;
     }
+    /// Already encoded items, sent right after the response and before the post-response queue.
+    void enqueuePostResponseFrames(const QList<ServerMessageFrame> &frames)
+    {
+        postResponseFrames.append(frames);
+    }
+    [[nodiscard]] const QList<ServerMessageFrame> &getPostResponseFrames() const
+    {
+        return postResponseFrames;
+    }
 };
 
 #endif
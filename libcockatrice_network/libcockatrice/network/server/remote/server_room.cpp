@@ -1,10 +1,13 @@
 #include "server_room.h"
 
 #include "game/server_game.h"
+#include "server_message_frame.h"
 #include "server_protocolhandler.h"
 
 #include <QDateTime>
 #include <QDebug>
+#include <QTimer>
+#include <algorithm>
 #include <google/protobuf/descriptor.h>
 #include <libcockatrice/protocol/pb/commands.pb.h>
 #include <libcockatrice/protocol/pb/event_join_room.pb.h>
@@ -12,8 +15,8 @@
 #include <libcockatrice/protocol/pb/event_list_games.pb.h>
 #include <libcockatrice/protocol/pb/event_remove_messages.pb.h>
 #include <libcockatrice/protocol/pb/event_room_say.pb.h>
+#include <libcockatrice/protocol/pb/response_join_room.pb.h>
 #include <libcockatrice/protocol/pb/room_commands.pb.h>
-#include <libcockatrice/protocol/pb/serverinfo_chat_message.pb.h>
 #include <libcockatrice/protocol/pb/serverinfo_room.pb.h>
 #include <libcockatrice/utility/trice_limits.h>
 
@@ -29,11 +32,21 @@ Server_Room::Server_Room(int _id,
                          Server *parent)
     : QObject(parent), id(_id), chatHistorySize(_chatHistorySize), name(_name), description(_description),
       permissionLevel(_permissionLevel), privilegeLevel(_privilegeLevel), autoJoin(_autoJoin),
-      joinMessage(_joinMessage), gameTypes(_gameTypes), gamesLock(QReadWriteLock::Recursive)
+      joinMessage(_joinMessage), gameTypes(_gameTypes), chatHistoryStart(0), chatHistoryFramesValid(false),
+      snapshotVersion(0), encodedJoinResponseVersion(0), gamesLock(QReadWriteLock::Recursive)
 {
+    if (chatHistorySize > 0)
+        chatHistory.reserve(chatHistorySize);
+
+    gameListUpdateTimer = new QTimer(this);
+    gameListUpdateTimer->setSingleShot(true);
+    gameListUpdateTimer->setInterval(parent->getGameListUpdateInterval());
+    connect(gameListUpdateTimer, &QTimer::timeout, this, &Server_Room::sendGameListUpdates);
+
+    // gameListChanged is only emitted for new and for closed games.
     connect(
-        this, &Server_Room::gameListChanged, this, [this](auto gameInfo) { broadcastGameListUpdate(gameInfo); },
-        Qt::QueuedConnection);
+        this, &Server_Room::gameListChanged, this,
+        [this](auto gameInfo) { queueGameListUpdate(gameInfo, true, !gameInfo.closed()); }, Qt::QueuedConnection);
 }
 
 Server_Room::~Server_Room()
@@ -90,31 +103,25 @@ Server_Room::getInfo(ServerInfo_Room &result, bool complete, bool showGameTypes,
 
     gamesLock.lockForRead();
     result.set_game_count(games.size() + externalGames.size());
-    if (complete) {
-        QMapIterator<int, Server_Game *> gameIterator(games);
-        while (gameIterator.hasNext())
-            gameIterator.next().value()->getInfo(*result.add_game_list());
-        if (includeExternalData) {
-            QMapIterator<int, ServerInfo_Game> externalGameIterator(externalGames);
-            while (externalGameIterator.hasNext())
-                result.add_game_list()->CopyFrom(externalGameIterator.next().value());
-        }
-    }
     gamesLock.unlock();
 
     usersLock.lockForRead();
     result.set_player_count(users.size() + externalUsers.size());
+    usersLock.unlock();
+
     if (complete) {
-        QMapIterator<QString, Server_ProtocolHandler *> userIterator(users);
-        while (userIterator.hasNext())
-            result.add_user_list()->CopyFrom(userIterator.next().value()->copyUserInfo(false));
+        QMutexLocker snapshotLocker(&snapshotMutex);
+        for (const QByteArray &gameInfo : gameSnapshot)
+            result.add_game_list()->ParseFromArray(gameInfo.constData(), gameInfo.size());
+        for (const QByteArray &userInfo : userSnapshot)
+            result.add_user_list()->ParseFromArray(userInfo.constData(), userInfo.size());
         if (includeExternalData) {
-            QMapIterator<QString, ServerInfo_User_Container> externalUserIterator(externalUsers);
-            while (externalUserIterator.hasNext())
-                result.add_user_list()->CopyFrom(externalUserIterator.next().value().copyUserInfo(false));
+            for (const QByteArray &gameInfo : externalGameSnapshot)
+                result.add_game_list()->ParseFromArray(gameInfo.constData(), gameInfo.size());
+            for (const QByteArray &userInfo : externalUserSnapshot)
+                result.add_user_list()->ParseFromArray(userInfo.constData(), userInfo.size());
         }
     }
-    usersLock.unlock();
 
     if (complete || showGameTypes)
         for (int i = 0; i < gameTypes.size(); ++i) {
@@ -126,6 +133,326 @@ Server_Room::getInfo(ServerInfo_Room &result, bool complete, bool showGameTypes,
     return result;
 }
 
+quint64 Server_Room::getSnapshotVersion() const
+{
+    QMutexLocker locker(&snapshotMutex);
+    return snapshotVersion;
+}
+
+QByteArray Server_Room::getEncodedJoinResponse(const QString &userName) const
+{
+    if (!userName.isEmpty()) {
+        QMutexLocker listsLocker(&filteredGameListsMutex);
+        auto gameList = filteredGameLists.constFind(userName);
+        if (gameList != filteredGameLists.constEnd()) {
+            QList<int> gameIds = gameList->visibleGames.values();
+            std::sort(gameIds.begin(), gameIds.end());
+            QMutexLocker locker(&snapshotMutex);
+            return encodeJoinResponse(&gameIds);
+        }
+    }
+
+    QMutexLocker locker(&snapshotMutex);
+    if (encodedJoinResponse.isEmpty() || encodedJoinResponseVersion != snapshotVersion) {
+        encodedJoinResponse = encodeJoinResponse(nullptr);
+        encodedJoinResponseVersion = snapshotVersion;
+    }
+    return encodedJoinResponse;
+}
+
+QByteArray Server_Room::encodeJoinResponse(const QList<int> *gameIds) const
+{
+    ServerInfo_Room head;
+    head.set_room_id(id);
+    head.set_name(name.toStdString());
+    head.set_description(description.toStdString());
+    head.set_auto_join(autoJoin);
+    head.set_permissionlevel(permissionLevel.toStdString());
+    head.set_privilegelevel(privilegeLevel.toStdString());
+    head.set_game_count(gameSnapshot.size() + externalGameSnapshot.size());
+    head.set_player_count(userSnapshot.size() + externalUserSnapshot.size());
+    for (int i = 0; i < gameTypes.size(); ++i) {
+        ServerInfo_GameType *gameTypeInfo = head.add_gametype_list();
+        gameTypeInfo->set_game_type_id(i);
+        gameTypeInfo->set_description(gameTypes[i].toStdString());
+    }
+
+    // Fields may come in any order, so the lists can simply follow the other fields.
+    QByteArray roomInfo = QByteArray::fromStdString(head.SerializeAsString());
+    if (gameIds) {
+        for (int gameId : *gameIds) {
+            const QByteArray gameInfo = gameSnapshot.value(gameId, externalGameSnapshot.value(gameId));
+            if (!gameInfo.isEmpty())
+                ServerMessageFrame::appendEncodedField(roomInfo, ServerInfo_Room::kGameListFieldNumber, gameInfo);
+        }
+    } else {
+        for (const auto *snapshot : {&gameSnapshot, &externalGameSnapshot})
+            for (const QByteArray &gameInfo : *snapshot)
+                ServerMessageFrame::appendEncodedField(roomInfo, ServerInfo_Room::kGameListFieldNumber, gameInfo);
+    }
+    for (const auto *snapshot : {&userSnapshot, &externalUserSnapshot})
+        for (const QByteArray &userInfo : *snapshot)
+            ServerMessageFrame::appendEncodedField(roomInfo, ServerInfo_Room::kUserListFieldNumber, userInfo);
+
+    QByteArray joinRoom, result;
+    ServerMessageFrame::appendEncodedField(joinRoom, Response_JoinRoom::kRoomInfoFieldNumber, roomInfo);
+    ServerMessageFrame::appendEncodedField(result, Response_JoinRoom::kExtFieldNumber, joinRoom);
+    return result;
+}
+
+void Server_Room::setSnapshot(QMap<QString, QByteArray> &snapshot, const ServerInfo_User &userInfo)
+{
+    QMutexLocker locker(&snapshotMutex);
+    snapshot.insert(QString::fromStdString(userInfo.name()), QByteArray::fromStdString(userInfo.SerializeAsString()));
+    ++snapshotVersion;
+}
+
+template <typename Key> void Server_Room::removeSnapshot(QMap<Key, QByteArray> &snapshot, const Key &key)
+{
+    QMutexLocker locker(&snapshotMutex);
+    snapshot.remove(key);
+    ++snapshotVersion;
+}
+
+void Server_Room::applyGameListUpdate(const PendingGameListUpdate &update)
+{
+    // Called with snapshotMutex locked. Local games are only announced to ISL, updates from ISL are about
+    // external games.
+    QMap<int, QByteArray> &snapshot = update.sendToIsl ? gameSnapshot : externalGameSnapshot;
+    const ServerInfo_Game &changes = update.gameInfo;
+    const int gameId = changes.game_id();
+
+    auto gameInfo = gameInfos.find(gameId);
+    if (gameInfo != gameInfos.end())
+        indexGame(*gameInfo, false);
+    if (changes.closed()) {
+        if (gameInfo != gameInfos.end())
+            gameInfos.erase(gameInfo);
+        snapshot.remove(gameId);
+    } else {
+        if (gameInfo == gameInfos.end())
+            gameInfo = gameInfos.insert(gameId, ServerInfo_Game());
+        // Server_Game::gameInfoChanged only carries the fields that changed.
+        if (changes.game_types_size() > 0)
+            gameInfo->clear_game_types();
+        gameInfo->MergeFrom(changes);
+        indexGame(*gameInfo, true);
+        snapshot.insert(gameId, QByteArray::fromStdString(gameInfo->SerializeAsString()));
+    }
+    ++snapshotVersion;
+}
+
+void Server_Room::indexGame(const ServerInfo_Game &gameInfo, bool add)
+{
+    const int gameId = gameInfo.game_id();
+    for (int gameType : gameInfo.game_types()) {
+        if (add) {
+            gameIdsByType[gameType].insert(gameId);
+        } else {
+            auto gameIds = gameIdsByType.find(gameType);
+            if (gameIds != gameIdsByType.end() && gameIds->remove(gameId) && gameIds->isEmpty())
+                gameIdsByType.erase(gameIds);
+        }
+    }
+    if (add && gameInfo.started())
+        startedGameIds.insert(gameId);
+    else
+        startedGameIds.remove(gameId);
+}
+
+QList<int> Server_Room::findGames(const Server_GameFilter &filter,
+                                  qint64 now,
+                                  const QSet<int> &exclude,
+                                  int limit,
+                                  int firstGameId) const
+{
+    // Called with snapshotMutex locked. The indexes narrow the candidates down before the whole filter is checked.
+    QList<int> candidates;
+    if (filter.getGameTypeIds().isEmpty()) {
+        candidates = gameInfos.keys();
+    } else {
+        QSet<int> gameIds;
+        for (int gameType : filter.getGameTypeIds())
+            gameIds.unite(gameIdsByType.value(gameType));
+        candidates = gameIds.values();
+        std::sort(candidates.begin(), candidates.end());
+    }
+
+    QList<int> result;
+    for (int gameId : candidates) {
+        if (gameId < firstGameId || exclude.contains(gameId) ||
+            (filter.hidesStartedGames() && startedGameIds.contains(gameId)))
+            continue;
+        if (!filter.accepts(*gameInfos.constFind(gameId), now))
+            continue;
+        result.append(gameId);
+        if (limit > 0 && result.size() == limit)
+            break;
+    }
+    return result;
+}
+
+Server_Room::FilteredGameList Server_Room::createFilteredGameList(const ServerInfo_GameFilter &gameFilter,
+                                                                  Server_ProtocolHandler *client,
+                                                                  qint64 now) const
+{
+    // Called with snapshotMutex locked.
+    FilteredGameList gameList;
+    gameList.filter =
+        Server_GameFilter(gameFilter, client->getUserInfo()->user_level() & ServerInfo_User::IsRegistered);
+    const int pageSize = gameList.filter.getPageSize();
+    const QList<int> gameIds = findGames(gameList.filter, now, QSet<int>(), pageSize, 0);
+    gameList.visibleGames = QSet<int>(gameIds.begin(), gameIds.end());
+    gameList.truncated = pageSize > 0 && gameIds.size() == pageSize;
+    return gameList;
+}
+
+void Server_Room::sendFilteredGameListUpdates(Server_ProtocolHandler *client, FilteredGameList &gameList, qint64 now)
+{
+    // Called with usersLock and filteredGameListsMutex locked, after the pending updates have been applied.
+    Event_ListGames event;
+    const int pageSize = gameList.filter.getPageSize();
+
+    QMutexLocker locker(&snapshotMutex);
+    for (const PendingGameListUpdate &update : pendingGameListUpdates) {
+        const int gameId = update.gameInfo.game_id();
+        auto gameInfo = gameInfos.constFind(gameId);
+        const bool passes = gameInfo != gameInfos.constEnd() && gameList.filter.accepts(*gameInfo, now);
+        if (gameList.visibleGames.contains(gameId)) {
+            if (passes) {
+                event.add_game_list()->CopyFrom(update.gameInfo);
+            } else {
+                // games that no longer pass the filter are closed as far as the client is concerned
+                gameList.visibleGames.remove(gameId);
+                ServerInfo_Game *removedGame = event.add_game_list();
+                removedGame->set_room_id(id);
+                removedGame->set_game_id(gameId);
+                removedGame->set_closed(true);
+            }
+        } else if (passes && gameId >= gameList.firstGameId) {
+            if (pageSize == 0 || gameList.visibleGames.size() < pageSize) {
+                gameList.visibleGames.insert(gameId);
+                event.add_game_list()->CopyFrom(*gameInfo);
+            } else {
+                gameList.truncated = true;
+            }
+        }
+    }
+
+    // a later page that lost all of its games goes back to the first one, which may still have some
+    if (gameList.visibleGames.isEmpty() && gameList.firstGameId > 0) {
+        gameList.firstGameId = 0;
+        gameList.truncated = true;
+    }
+    if (gameList.truncated && gameList.visibleGames.size() < pageSize) {
+        const int missing = pageSize - gameList.visibleGames.size();
+        const QList<int> gameIds =
+            findGames(gameList.filter, now, gameList.visibleGames, missing, gameList.firstGameId);
+        for (int gameId : gameIds) {
+            gameList.visibleGames.insert(gameId);
+            event.add_game_list()->CopyFrom(*gameInfos.constFind(gameId));
+        }
+        gameList.truncated = gameIds.size() == missing;
+    }
+    locker.unlock();
+
+    if (event.game_list_size() > 0) {
+        RoomEvent *roomEvent = prepareRoomEvent(event);
+        client->sendProtocolItem(*roomEvent);
+        delete roomEvent;
+    }
+}
+
+void Server_Room::setGameFilter(Server_ProtocolHandler *client, const ServerInfo_GameFilter *gameFilter)
+{
+    const QString userName = QString::fromStdString(client->getUserInfo()->name());
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    QReadLocker usersLocker(&usersLock);
+    QMutexLocker listsLocker(&filteredGameListsMutex);
+    QMutexLocker snapshotLocker(&snapshotMutex);
+
+    auto oldGameList = filteredGameLists.constFind(userName);
+    const QList<int> allGameIds = gameInfos.keys();
+    const QSet<int> oldGames = oldGameList != filteredGameLists.constEnd()
+                                   ? oldGameList->visibleGames
+                                   : QSet<int>(allGameIds.begin(), allGameIds.end());
+    QSet<int> newGames;
+    if (gameFilter) {
+        FilteredGameList gameList = createFilteredGameList(*gameFilter, client, now);
+        newGames = gameList.visibleGames;
+        filteredGameLists.insert(userName, gameList);
+    } else {
+        newGames = QSet<int>(allGameIds.begin(), allGameIds.end());
+        filteredGameLists.remove(userName);
+    }
+
+    Event_ListGames event;
+    addGameListChanges(event, oldGames, newGames);
+    snapshotLocker.unlock();
+
+    // sent before filteredGameListsMutex is released, so that no later update can overtake it
+    if (event.game_list_size() > 0) {
+        RoomEvent *roomEvent = prepareRoomEvent(event);
+        client->sendProtocolItem(*roomEvent);
+        delete roomEvent;
+    }
+}
+
+bool Server_Room::showNextGamePage(Server_ProtocolHandler *client)
+{
+    const QString userName = QString::fromStdString(client->getUserInfo()->name());
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    QReadLocker usersLocker(&usersLock);
+    QMutexLocker listsLocker(&filteredGameListsMutex);
+    auto gameList = filteredGameLists.find(userName);
+    if (gameList == filteredGameLists.end())
+        return false;
+    const int pageSize = gameList->filter.getPageSize();
+    if (pageSize == 0)
+        return false;
+
+    QMutexLocker snapshotLocker(&snapshotMutex);
+    const QSet<int> oldGames = gameList->visibleGames;
+    int firstGameId = oldGames.isEmpty() ? 0 : *std::max_element(oldGames.begin(), oldGames.end()) + 1;
+    QList<int> gameIds = findGames(gameList->filter, now, QSet<int>(), pageSize, firstGameId);
+    if (gameIds.isEmpty() && firstGameId > 0) {
+        firstGameId = 0;
+        gameIds = findGames(gameList->filter, now, QSet<int>(), pageSize, firstGameId);
+    }
+    gameList->visibleGames = QSet<int>(gameIds.begin(), gameIds.end());
+    gameList->firstGameId = firstGameId;
+    gameList->truncated = gameIds.size() == pageSize;
+
+    Event_ListGames event;
+    addGameListChanges(event, oldGames, gameList->visibleGames);
+    snapshotLocker.unlock();
+
+    // sent before filteredGameListsMutex is released, like in setGameFilter()
+    if (event.game_list_size() > 0) {
+        RoomEvent *roomEvent = prepareRoomEvent(event);
+        client->sendProtocolItem(*roomEvent);
+        delete roomEvent;
+    }
+    return true;
+}
+
+void Server_Room::addGameListChanges(Event_ListGames &event, const QSet<int> &oldGames, const QSet<int> &newGames) const
+{
+    // Called with snapshotMutex locked.
+    for (int gameId : oldGames)
+        if (!newGames.contains(gameId)) {
+            ServerInfo_Game *removedGame = event.add_game_list();
+            removedGame->set_room_id(id);
+            removedGame->set_game_id(gameId);
+            removedGame->set_closed(true);
+        }
+    for (int gameId : newGames)
+        if (!oldGames.contains(gameId))
+            event.add_game_list()->CopyFrom(*gameInfos.constFind(gameId));
+}
+
 RoomEvent *Server_Room::prepareRoomEvent(const ::google::protobuf::Message &roomEvent)
 {
     auto *event = new RoomEvent;
@@ -136,7 +463,7 @@ RoomEvent *Server_Room::prepareRoomEvent(const ::google::protobuf::Message &room
     return event;
 }
 
-void Server_Room::addClient(Server_ProtocolHandler *client)
+void Server_Room::addClient(Server_ProtocolHandler *client, const ServerInfo_GameFilter *gameFilter)
 {
     Event_JoinRoom event;
     event.mutable_user_info()->CopyFrom(client->copyUserInfo(false));
@@ -147,6 +474,13 @@ void Server_Room::addClient(Server_ProtocolHandler *client)
 
     usersLock.lockForWrite();
     users.insert(QString::fromStdString(client->getUserInfo()->name()), client);
+    setSnapshot(userSnapshot, event.user_info());
+    if (gameFilter) {
+        QMutexLocker listsLocker(&filteredGameListsMutex);
+        QMutexLocker snapshotLocker(&snapshotMutex);
+        filteredGameLists.insert(QString::fromStdString(client->getUserInfo()->name()),
+                                 createFilteredGameList(*gameFilter, client, QDateTime::currentSecsSinceEpoch()));
+    }
     roomInfo.set_player_count(users.size() + externalUsers.size());
     usersLock.unlock();
 
@@ -159,10 +493,30 @@ void Server_Room::addClient(Server_ProtocolHandler *client)
     emit roomInfoChanged(roomInfo);
 }
 
+void Server_Room::updateClient(Server_ProtocolHandler *client)
+{
+    Event_JoinRoom event;
+    event.mutable_user_info()->CopyFrom(client->copyUserInfo(false));
+
+    usersLock.lockForRead();
+    const bool inRoom = users.value(QString::fromStdString(event.user_info().name())) == client;
+    if (inRoom)
+        setSnapshot(userSnapshot, event.user_info());
+    usersLock.unlock();
+
+    // announced like a join, the users in the room and on the other servers replace the entry they have
+    if (inRoom)
+        sendRoomEvent(prepareRoomEvent(event));
+}
+
 void Server_Room::removeClient(Server_ProtocolHandler *client)
 {
     usersLock.lockForWrite();
     users.remove(QString::fromStdString(client->getUserInfo()->name()));
+    removeSnapshot(userSnapshot, QString::fromStdString(client->getUserInfo()->name()));
+    filteredGameListsMutex.lock();
+    filteredGameLists.remove(QString::fromStdString(client->getUserInfo()->name()));
+    filteredGameListsMutex.unlock();
 
     ServerInfo_Room roomInfo;
     roomInfo.set_room_id(id);
@@ -195,6 +549,7 @@ void Server_Room::addExternalUser(const ServerInfo_User &userInfo)
 
     usersLock.lockForWrite();
     externalUsers.insert(QString::fromStdString(userInfo.name()), userInfoContainer);
+    setSnapshot(externalUserSnapshot, event.user_info());
     roomInfo.set_player_count(users.size() + externalUsers.size());
     usersLock.unlock();
 
@@ -210,6 +565,7 @@ void Server_Room::removeExternalUser(const QString &_name)
     usersLock.lockForWrite();
     if (externalUsers.contains(_name))
         externalUsers.remove(_name);
+    removeSnapshot(externalUserSnapshot, _name);
     roomInfo.set_player_count(users.size() + externalUsers.size());
     usersLock.unlock();
 
@@ -226,15 +582,18 @@ void Server_Room::updateExternalGameList(const ServerInfo_Game &gameInfo)
     ServerInfo_Room roomInfo;
     roomInfo.set_room_id(id);
 
+    bool isNew = false;
     gamesLock.lockForWrite();
-    if (!gameInfo.has_player_count() && externalGames.contains(gameInfo.game_id()))
+    if (!gameInfo.has_player_count() && externalGames.contains(gameInfo.game_id())) {
         externalGames.remove(gameInfo.game_id());
-    else
+    } else {
+        isNew = !externalGames.contains(gameInfo.game_id());
         externalGames.insert(gameInfo.game_id(), gameInfo);
+    }
     roomInfo.set_game_count(games.size() + externalGames.size());
     gamesLock.unlock();
 
-    broadcastGameListUpdate(gameInfo, false);
+    queueGameListUpdate(gameInfo, false, isNew);
     emit roomInfoChanged(roomInfo);
 }
 
@@ -284,21 +643,18 @@ void Server_Room::say(const QString &userName, const QString &userMessage, bool
     event.set_message(userMessage.toStdString());
     sendRoomEvent(prepareRoomEvent(event), sendToIsl);
 
-    if (chatHistorySize != 0) {
-        ServerInfo_ChatMessage chatMessage;
-        QDateTime dateTime = dateTime.currentDateTimeUtc();
-        QString dateTimeString = dateTime.toString();
-        chatMessage.set_time(dateTimeString.toStdString());
-        chatMessage.set_sender_name(userName.toStdString());
-        chatMessage.set_message(userMessage.simplified().toStdString());
-
-        historyLock.lockForWrite();
-        if (chatHistory.size() >= chatHistorySize) {
-            chatHistory.removeAt(0);
-        }
+    if (chatHistorySize > 0) {
+        ChatHistoryMessage chatMessage{QDateTime::currentMSecsSinceEpoch(), userName.toStdString(),
+                                       userMessage.simplified().toStdString(), ServerMessageFrame()};
 
-        chatHistory.push_back(std::move(chatMessage));
-        historyLock.unlock();
+        QWriteLocker locker(&historyLock);
+        if (chatHistory.size() < chatHistorySize) {
+            chatHistory.append(std::move(chatMessage));
+        } else {
+            chatHistory[chatHistoryStart] = std::move(chatMessage);
+            chatHistoryStart = (chatHistoryStart + 1) % chatHistorySize;
+        }
+        chatHistoryFramesValid = false;
     }
 }
 
@@ -310,27 +666,62 @@ void Server_Room::removeSaidMessages(const QString &userName, int amount, bool s
     event.set_amount(amount);
     sendRoomEvent(prepareRoomEvent(event), sendToIsl);
 
-    if (chatHistorySize != 0) {
+    if (chatHistorySize > 0) {
         int removed = 0;
-        historyLock.lockForWrite();
+        QWriteLocker locker(&historyLock);
         // redact [amount] of the most recent messages from this user from history
-        for (auto message = chatHistory.rbegin(); message != chatHistory.rend() && removed != amount; ++message) {
-            if (message->sender_name() == stdStringUserName) {
-                message->clear_message();
+        for (int i = chatHistory.size() - 1; i >= 0 && removed != amount; --i) {
+            ChatHistoryMessage &message = chatHistory[(chatHistoryStart + i) % chatHistory.size()];
+            if (message.senderName == stdStringUserName) {
+                message.message.clear();
+                message.frame = ServerMessageFrame();
                 ++removed;
             }
         }
-        historyLock.unlock();
+        if (removed)
+            chatHistoryFramesValid = false;
+    }
+}
+
+QList<ServerMessageFrame> Server_Room::getChatHistoryFrames()
+{
+    {
+        QReadLocker locker(&historyLock);
+        if (chatHistoryFramesValid)
+            return chatHistoryFrames;
+    }
+
+    QWriteLocker locker(&historyLock);
+    if (!chatHistoryFramesValid) {
+        chatHistoryFrames.clear();
+        chatHistoryFrames.reserve(chatHistory.size());
+        for (int i = 0; i < chatHistory.size(); ++i) {
+            ChatHistoryMessage &message = chatHistory[(chatHistoryStart + i) % chatHistory.size()];
+            if (message.frame.isNull()) {
+                RoomEvent event;
+                event.set_room_id(id);
+                Event_RoomSay *roomSay = event.MutableExtension(Event_RoomSay::ext);
+                roomSay->set_message(message.senderName + ": " + message.message);
+                roomSay->set_message_type(Event_RoomSay::ChatHistory);
+                roomSay->set_time_of(static_cast<quint64>(message.timeOf));
+                message.frame = ServerMessageFrame(event);
+            }
+            chatHistoryFrames.append(message.frame);
+        }
+        chatHistoryFramesValid = true;
     }
+    return chatHistoryFrames;
 }
 
 void Server_Room::sendRoomEvent(RoomEvent *event, bool sendToIsl)
 {
+    // Encode once; every recipient's output queue shares the same buffer.
+    const ServerMessageFrame frame(*event);
     usersLock.lockForRead();
     {
         QMapIterator<QString, Server_ProtocolHandler *> userIterator(users);
         while (userIterator.hasNext())
-            userIterator.next().value()->sendProtocolItem(*event);
+            userIterator.next().value()->sendProtocolItem(frame);
     }
     usersLock.unlock();
 
@@ -340,11 +731,73 @@ void Server_Room::sendRoomEvent(RoomEvent *event, bool sendToIsl)
     delete event;
 }
 
-void Server_Room::broadcastGameListUpdate(const ServerInfo_Game &gameInfo, bool sendToIsl)
+void Server_Room::queueGameListUpdate(const ServerInfo_Game &gameInfo, bool sendToIsl, bool isNew)
 {
+    auto pending = pendingGameListUpdates.find(gameInfo.game_id());
+    if (pending == pendingGameListUpdates.end())
+        pendingGameListUpdates.insert(gameInfo.game_id(), {gameInfo, sendToIsl, isNew});
+    else if (!gameInfo.closed())
+        pending->gameInfo.MergeFrom(gameInfo);
+    else if (pending->isNew)
+        pendingGameListUpdates.erase(pending); // nobody has seen this game yet
+    else
+        pending->gameInfo = gameInfo;
+
+    if (gameListUpdateTimer->interval() <= 0)
+        sendGameListUpdates();
+    else if (!gameListUpdateTimer->isActive())
+        gameListUpdateTimer->start();
+}
+
+void Server_Room::sendGameListUpdates()
+{
+    if (pendingGameListUpdates.isEmpty())
+        return;
+
+    // The snapshot for joining users changes together with the game lists of the users already in the room,
+    // so a new user never misses an update or gets one for a game it doesn't know about.
     Event_ListGames event;
-    event.add_game_list()->CopyFrom(gameInfo);
-    sendRoomEvent(prepareRoomEvent(event), sendToIsl);
+    int islUpdateCount = 0;
+    snapshotMutex.lock();
+    for (const PendingGameListUpdate &update : pendingGameListUpdates) {
+        event.add_game_list()->CopyFrom(update.gameInfo);
+        applyGameListUpdate(update);
+        if (update.sendToIsl)
+            ++islUpdateCount;
+    }
+    snapshotMutex.unlock();
+
+    const bool islGetsAll = islUpdateCount == pendingGameListUpdates.size();
+    if (!islGetsAll && islUpdateCount > 0) {
+        Event_ListGames islEvent;
+        for (const PendingGameListUpdate &update : pendingGameListUpdates)
+            if (update.sendToIsl)
+                islEvent.add_game_list()->CopyFrom(update.gameInfo);
+        RoomEvent *roomEvent = prepareRoomEvent(islEvent);
+        getServer()->sendIsl_RoomEvent(*roomEvent);
+        delete roomEvent;
+    }
+
+    // users without a filter share one encoded event, the others get the changes to their own list
+    RoomEvent *roomEvent = prepareRoomEvent(event);
+    const ServerMessageFrame frame(*roomEvent);
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    usersLock.lockForRead();
+    filteredGameListsMutex.lock();
+    for (auto user = users.constBegin(); user != users.constEnd(); ++user) {
+        auto gameList = filteredGameLists.find(user.key());
+        if (gameList == filteredGameLists.end())
+            (*user)->sendProtocolItem(frame);
+        else
+            sendFilteredGameListUpdates(*user, *gameList, now);
+    }
+    filteredGameListsMutex.unlock();
+    usersLock.unlock();
+
+    if (islGetsAll)
+        getServer()->sendIsl_RoomEvent(*roomEvent);
+    delete roomEvent;
+    pendingGameListUpdates.clear();
 }
 
 void Server_Room::addGame(Server_Game *game)
@@ -353,7 +806,10 @@ void Server_Room::addGame(Server_Game *game)
     roomInfo.set_room_id(id);
 
     gamesLock.lockForWrite();
-    connect(game, &Server_Game::gameInfoChanged, this, [this](auto gameInfo) { broadcastGameListUpdate(gameInfo); });
+    // queued like gameListChanged, so that the changes of a new game never overtake the game itself
+    connect(
+        game, &Server_Game::gameInfoChanged, this, [this](auto gameInfo) { queueGameListUpdate(gameInfo); },
+        Qt::QueuedConnection);
 
     game->gameMutex.lock();
     games.insert(game->getGameId(), game);
@@ -1,25 +1,31 @@
 #ifndef SERVER_ROOM_H
 #define SERVER_ROOM_H
 
+#include "server_game_filter.h"
+#include "server_message_frame.h"
 #include "serverinfo_user_container.h"
 
+#include <QHash>
 #include <QMap>
 #include <QMutex>
 #include <QObject>
 #include <QReadWriteLock>
+#include <QSet>
+#include <QVector>
 #include <libcockatrice/protocol/pb/response.pb.h>
-#include <libcockatrice/protocol/pb/serverinfo_chat_message.pb.h>
+#include <libcockatrice/protocol/pb/serverinfo_game.pb.h>
 
 class Server_DatabaseInterface;
 class Server_ProtocolHandler;
 class RoomEvent;
 class ServerInfo_User;
 class ServerInfo_Room;
-class ServerInfo_Game;
 class Server_Game;
 class Server;
+class QTimer;
 
 class Command_JoinGame;
+class Event_ListGames;
 class ResponseContainer;
 class Server_AbstractUserInterface;
 
@@ -44,9 +50,72 @@ private:
     QMap<int, ServerInfo_Game> externalGames;
     QMap<QString, Server_ProtocolHandler *> users;
     QMap<QString, ServerInfo_User_Container> externalUsers;
-    QList<ServerInfo_ChatMessage> chatHistory;
+
+    struct ChatHistoryMessage
+    {
+        qint64 timeOf; // msecs since epoch
+        std::string senderName;
+        std::string message;
+        ServerMessageFrame frame; // the replayed Event_RoomSay, encoded on first use
+    };
+    // Ring buffer of the last chatHistorySize messages, oldest at chatHistoryStart once it is full. Joining users
+    // are sent chatHistoryFrames, which is rebuilt after every change.
+    QVector<ChatHistoryMessage> chatHistory;
+    int chatHistoryStart;
+    QList<ServerMessageFrame> chatHistoryFrames;
+    bool chatHistoryFramesValid;
+
+    // Serialized copies of the game and user lists, updated along with them, so that joining users neither lock
+    // every game nor encode the whole room again. snapshotMutex is always locked last.
+    mutable QMutex snapshotMutex;
+    QMap<int, QByteArray> gameSnapshot, externalGameSnapshot;
+    QMap<QString, QByteArray> userSnapshot, externalUserSnapshot;
+    quint64 snapshotVersion;
+    mutable quint64 encodedJoinResponseVersion;
+    mutable QByteArray encodedJoinResponse;
+
+    // Game list changes are collected for server/game_list_update_interval msecs and sent to the room in one
+    // event. Later changes of the same game are merged into the pending one.
+    struct PendingGameListUpdate
+    {
+        ServerInfo_Game gameInfo;
+        bool sendToIsl; // false for external games
+        bool isNew;     // not announced yet, so closing it again cancels the update
+    };
+    QMap<int, PendingGameListUpdate> pendingGameListUpdates;
+    QTimer *gameListUpdateTimer;
+
+    // Every game as the users in the room know it, indexed for the filtered game lists. Guarded by snapshotMutex.
+    QMap<int, ServerInfo_Game> gameInfos;
+    QHash<int, QSet<int>> gameIdsByType;
+    QSet<int> startedGameIds;
+
+    // Users who registered a game list filter only get the games that pass it, at most a page at a time.
+    struct FilteredGameList
+    {
+        Server_GameFilter filter;
+        QSet<int> visibleGames;
+        int firstGameId = 0;    // the page holds the passing games from this game id on
+        bool truncated = false; // more games passed the filter than fit on the page
+    };
+    mutable QMutex filteredGameListsMutex; // locked after usersLock and before snapshotMutex
+    QHash<QString, FilteredGameList> filteredGameLists;
+
+    void setSnapshot(QMap<QString, QByteArray> &snapshot, const ServerInfo_User &userInfo);
+    template <typename Key> void removeSnapshot(QMap<Key, QByteArray> &snapshot, const Key &key);
+    QByteArray encodeJoinResponse(const QList<int> *gameIds) const;
+    void applyGameListUpdate(const PendingGameListUpdate &update);
+    void indexGame(const ServerInfo_Game &gameInfo, bool add);
+    QList<int>
+    findGames(const Server_GameFilter &filter, qint64 now, const QSet<int> &exclude, int limit, int firstGameId) const;
+    FilteredGameList createFilteredGameList(const ServerInfo_GameFilter &gameFilter,
+                                            Server_ProtocolHandler *client,
+                                            qint64 now) const;
+    void sendFilteredGameListUpdates(Server_ProtocolHandler *client, FilteredGameList &gameList, qint64 now);
+    void addGameListChanges(Event_ListGames &event, const QSet<int> &oldGames, const QSet<int> &newGames) const;
 private slots:
-    void broadcastGameListUpdate(const ServerInfo_Game &gameInfo, bool sendToIsl = true);
+    void queueGameListUpdate(const ServerInfo_Game &gameInfo, bool sendToIsl = true, bool isNew = false);
+    void sendGameListUpdates();
 
 public:
     mutable QReadWriteLock usersLock;
@@ -107,15 +176,23 @@ public:
     Server *getServer() const;
     const ServerInfo_Room &
     getInfo(ServerInfo_Room &result, bool complete, bool showGameTypes = false, bool includeExternalData = true) const;
+    /// Changes whenever a game or user is added, removed or updated.
+    quint64 getSnapshotVersion() const;
+    /**
+     * The Response_JoinRoom extension field with the complete room info, ready to be appended to a serialized
+     * Response. It is encoded once per snapshot version from the already serialized games and users, unless
+     * @p userName registered a game list filter and only gets the games on its page.
+     */
+    QByteArray getEncodedJoinResponse(const QString &userName = QString()) const;
     int getGamesCreatedByUser(const QString &name) const;
     QList<ServerInfo_Game> getGamesOfUser(const QString &name) const;
-    QList<ServerInfo_ChatMessage> &getChatHistory()
-    {
-        return chatHistory;
-    }
+    /// The pre-encoded chat history events for a joining user, oldest first.
+    QList<ServerMessageFrame> getChatHistoryFrames();
 
-    void addClient(Server_ProtocolHandler *client);
+    void addClient(Server_ProtocolHandler *client, const ServerInfo_GameFilter *gameFilter = nullptr);
     void removeClient(Server_ProtocolHandler *client);
+    /// Lists the current info of @p client again if it is in the room.
+    void updateClient(Server_ProtocolHandler *client);
 
     void addExternalUser(const ServerInfo_User &userInfo);
     void removeExternalUser(const QString &_name);
@@ -124,6 +201,17 @@ public:
         return externalUsers;
     }
     void updateExternalGameList(const ServerInfo_Game &gameInfo);
+    /**
+     * Replaces the game list filter of @p client, or removes it if @p gameFilter is null, and sends the client the
+     * games that entered and left its list.
+     */
+    void setGameFilter(Server_ProtocolHandler *client, const ServerInfo_GameFilter *gameFilter);
+    /**
+     * Moves the game list of @p client to the next page of the games that pass its filter, or back to the first
+     * page after the last one, and sends the client the games that entered and left its list. Returns false if the
+     * client registered no filter with a page size.
+     */
+    bool showNextGamePage(Server_ProtocolHandler *client);
 
     Response::ResponseCode processJoinGameCommand(const Command_JoinGame &cmd,
                                                   ResponseContainer &rc,
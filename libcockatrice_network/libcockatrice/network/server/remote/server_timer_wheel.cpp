@@ -0,0 +1,118 @@
+#include "server_timer_wheel.h"
+
+#include <QThread>
+#include <QTimer>
+
+Server_TimerWheel::Server_TimerWheel(int tickInterval, QObject *parent)
+    : QObject(parent), currentTick(0), nextSlotTick(0), nextTimerId(0), runningTimerId(0),
+      runningThread(nullptr)
+{
+    if (tickInterval > 0) {
+        auto *clock = new QTimer(this);
+        connect(clock, &QTimer::timeout, this, &Server_TimerWheel::advance);
+        clock->start(tickInterval);
+    }
+}
+
+void Server_TimerWheel::insert(quint64 timerId, qint64 deadline)
+{
+    // a callback running on the current tick can't be put into the slot that is being emptied
+    const qint64 tick = nextSlotTick;
+    if (deadline < tick)
+        deadline = tick;
+
+    const qint64 delta = deadline - tick;
+    int level = 0;
+    while (level < levelCount - 1 && delta >= (Q_INT64_C(1) << (slotBits * (level + 1))))
+        ++level;
+    if (level == levelCount - 1) {
+        // deadlines beyond the outermost wheel wait in its last slot and get re-inserted from there
+        const qint64 horizon = tick + (Q_INT64_C(1) << (slotBits * levelCount)) - 1;
+        if (deadline > horizon)
+            deadline = horizon;
+    }
+    wheelSlots[level][(deadline >> (slotBits * level)) & (slotCount - 1)].append(timerId);
+}
+
+void Server_TimerWheel::cascade(int level, qint64 tick)
+{
+    QList<quint64> &slot = wheelSlots[level][(tick >> (slotBits * level)) & (slotCount - 1)];
+    const QList<quint64> timerIds = std::move(slot);
+    slot.clear();
+    for (quint64 timerId : timerIds) {
+        auto entry = entries.constFind(timerId);
+        if (entry != entries.constEnd())
+            insert(timerId, entry->deadline);
+    }
+}
+
+quint64 Server_TimerWheel::scheduleAt(qint64 deadline, Callback callback)
+{
+    QMutexLocker locker(&mutex);
+    const quint64 timerId = ++nextTimerId;
+    entries.insert(timerId, {deadline, std::move(callback)});
+    insert(timerId, deadline);
+    return timerId;
+}
+
+void Server_TimerWheel::cancel(quint64 timerId)
+{
+    QMutexLocker locker(&mutex);
+    entries.remove(timerId);
+    // a callback cancelling itself would wait forever
+    while (runningTimerId == timerId && runningThread != QThread::currentThread())
+        callbackFinished.wait(&mutex);
+}
+
+void Server_TimerWheel::advance()
+{
+    QList<quint64> dueTimerIds;
+    {
+        QMutexLocker locker(&mutex);
+        const qint64 tick = currentTick.loadRelaxed();
+
+        // move the outer slots that start at this tick inwards, outermost first
+        for (int level = levelCount - 1; level > 0; --level)
+            if ((tick & ((Q_INT64_C(1) << (slotBits * level)) - 1)) == 0)
+                cascade(level, tick);
+
+        QList<quint64> &slot = wheelSlots[0][tick & (slotCount - 1)];
+        const QList<quint64> timerIds = std::move(slot);
+        slot.clear();
+        for (quint64 timerId : timerIds) {
+            auto entry = entries.constFind(timerId);
+            if (entry == entries.constEnd())
+                continue;
+            if (entry->deadline <= tick)
+                dueTimerIds.append(timerId);
+            else
+                insert(timerId, entry->deadline);
+        }
+        nextSlotTick = tick + 1;
+    }
+
+    // Callbacks run without the lock, so they can schedule follow-ups. A callback cancelled by an earlier one in
+    // the same tick is skipped.
+    for (quint64 timerId : std::as_const(dueTimerIds)) {
+        Callback callback;
+        {
+            QMutexLocker locker(&mutex);
+            auto entry = entries.find(timerId);
+            if (entry == entries.end())
+                continue;
+            callback = std::move(entry->callback);
+            entries.erase(entry);
+            runningTimerId = timerId;
+            runningThread = QThread::currentThread();
+        }
+        callback();
+        callback = nullptr;
+
+        QMutexLocker locker(&mutex);
+        runningTimerId = 0;
+        runningThread = nullptr;
+        callbackFinished.wakeAll();
+    }
+
+    currentTick.fetchAndAddRelaxed(1);
+}
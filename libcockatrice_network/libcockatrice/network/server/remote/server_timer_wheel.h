@@ -0,0 +1,83 @@
+#ifndef SERVER_TIMER_WHEEL_H
+#define SERVER_TIMER_WHEEL_H
+
+#include <QAtomicInteger>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QWaitCondition>
+#include <functional>
+
+class QThread;
+class QTimer;
+
+/**
+ * A hierarchical timer wheel that counts clock ticks for every object living in one thread.
+ *
+ * Instead of waking up every session and game on each tick, callers schedule a callback for the tick at which
+ * something can expire, and only those callbacks run. Scheduling and cancelling are O(1); a tick costs one slot
+ * of the innermost wheel, plus moving the entries of an outer slot inwards every 64 or 4096 ticks.
+ *
+ * A wheel is either advanced by an external signal (the server ping clock) or by its own timer. Callbacks run
+ * in the thread the wheel lives in; schedule() and cancel() may be called from any thread.
+ */
+class Server_TimerWheel : public QObject
+{
+    Q_OBJECT
+public:
+    enum Clock
+    {
+        PingClock,  // ticks on Server::pingClockTimeout(), every server/clientkeepalive seconds
+        SecondClock // ticks once a second
+    };
+    using Callback = std::function<void()>;
+
+private:
+    static const int slotBits = 6;
+    static const int slotCount = 1 << slotBits;
+    static const int levelCount = 3;
+
+    struct Entry
+    {
+        qint64 deadline;
+        Callback callback;
+    };
+
+    QMutex mutex;
+    QAtomicInteger<qint64> currentTick;
+    qint64 nextSlotTick; // the first tick whose slot has not been emptied yet
+    quint64 nextTimerId;
+    QHash<quint64, Entry> entries;                    // cancelled timers are only removed here
+    QList<quint64> wheelSlots[levelCount][slotCount]; // and skipped when their slot comes up
+    quint64 runningTimerId;                           // the timer whose callback is running, or 0
+    QThread *runningThread;
+    QWaitCondition callbackFinished;
+
+    void insert(quint64 timerId, qint64 deadline);
+    void cascade(int level, qint64 tick);
+
+public:
+    explicit Server_TimerWheel(int tickInterval = 0, QObject *parent = nullptr);
+
+    /// The number of ticks that have passed since the wheel was created.
+    [[nodiscard]] qint64 getCurrentTick() const
+    {
+        return currentTick.loadRelaxed();
+    }
+    /**
+     * Runs @p callback once, on the tick where getCurrentTick() equals @p deadline, or on the next tick if that
+     * one has already passed. Returns an id for cancel(), never 0.
+     */
+    quint64 scheduleAt(qint64 deadline, Callback callback);
+    /**
+     * Makes sure the callback of @p timerId doesn't run anymore. If it is running in another thread right now, waits
+     * until it has returned, so that the objects it uses can be destroyed afterwards.
+     */
+    void cancel(quint64 timerId);
+
+public slots:
+    void advance();
+};
+
+#endif
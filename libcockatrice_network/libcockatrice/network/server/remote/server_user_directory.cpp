@@ -0,0 +1,105 @@
+#include "server_user_directory.h"
+
+#include <QRandomGenerator>
+#include <algorithm>
+
+Server_UserDirectory::Server_UserDirectory(int _historySize)
+    : historySize(qMax(_historySize, 0)), epoch(QRandomGenerator::global()->generate64()), version(0)
+{
+}
+
+void Server_UserDirectory::setHistorySize(int _historySize)
+{
+    historySize = qMax(_historySize, 0);
+    while (history.size() > historySize)
+        history.dequeue();
+}
+
+void Server_UserDirectory::addChange(const QString &userName)
+{
+    ++version;
+    if (historySize == 0)
+        return;
+    if (history.size() == historySize)
+        history.dequeue();
+    history.enqueue({version, userName});
+}
+
+quint64 Server_UserDirectory::addUser(const ServerInfo_User &userInfo)
+{
+    const QString userName = QString::fromStdString(userInfo.name());
+    users.insert(userName, userInfo);
+    addChange(userName);
+    return version;
+}
+
+quint64 Server_UserDirectory::removeUser(const QString &userName)
+{
+    if (users.remove(userName))
+        addChange(userName);
+    return version;
+}
+
+QList<ServerInfo_User> Server_UserDirectory::getPage(const QString &startAfter,
+                                                     int pageSize,
+                                                     const QSet<QString> *userNames,
+                                                     bool &hasMore) const
+{
+    QList<ServerInfo_User> result;
+    hasMore = false;
+    if (userNames) {
+        QStringList names(userNames->begin(), userNames->end());
+        std::sort(names.begin(), names.end());
+        for (auto name = std::upper_bound(names.cbegin(), names.cend(), startAfter); name != names.cend(); ++name) {
+            auto user = users.constFind(*name);
+            if (user == users.constEnd())
+                continue;
+            if (pageSize > 0 && result.size() == pageSize) {
+                hasMore = true;
+                break;
+            }
+            result.append(*user);
+        }
+        return result;
+    }
+
+    for (auto user = users.upperBound(startAfter); user != users.constEnd(); ++user) {
+        if (pageSize > 0 && result.size() == pageSize) {
+            hasMore = true;
+            break;
+        }
+        result.append(*user);
+    }
+    return result;
+}
+
+bool Server_UserDirectory::getChangesSince(quint64 sinceEpoch,
+                                           quint64 sinceVersion,
+                                           const QSet<QString> *userNames,
+                                           Changes &changes) const
+{
+    // the version of another server, or of this one before a restart, may well be lower than ours
+    if (sinceEpoch != epoch || sinceVersion > version)
+        return false;
+    if (sinceVersion == version)
+        return true;
+    // the change right after sinceVersion has to be known
+    if (history.isEmpty() || history.first().version > sinceVersion + 1)
+        return false;
+
+    QSet<QString> changedNames;
+    for (auto change = history.crbegin(); change != history.crend() && change->version > sinceVersion; ++change)
+        if (!userNames || userNames->contains(change->userName))
+            changedNames.insert(change->userName);
+
+    QStringList sortedNames(changedNames.begin(), changedNames.end());
+    std::sort(sortedNames.begin(), sortedNames.end());
+    for (const QString &userName : sortedNames) {
+        auto user = users.constFind(userName);
+        if (user == users.constEnd())
+            changes.leftUserNames.append(userName);
+        else
+            changes.users.append(*user);
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef SERVER_USER_DIRECTORY_H
+#define SERVER_USER_DIRECTORY_H
+
+#include <QList>
+#include <QMap>
+#include <QQueue>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <libcockatrice/protocol/pb/serverinfo_user.pb.h>
+
+/**
+ * The users online on this server and the ones announced by other servers over ISL, as sent to clients with
+ * Command_ListUsers.
+ *
+ * Every login and logout increases the version of the directory. The names that changed are kept for the last
+ * historySize versions, so a client that knows an older version only needs to be sent what changed since then,
+ * e.g. after reconnecting. Versions start over in every directory, so each one has a random epoch as well, and a
+ * version only means something together with the epoch it was handed out in.
+ *
+ * The directory is not locked itself, Server guards it with clientsLock.
+ */
+class Server_UserDirectory
+{
+public:
+    struct Changes
+    {
+        QList<ServerInfo_User> users; // logged in, or logged in again since the version
+        QStringList leftUserNames;    // logged out since the version
+    };
+
+private:
+    struct Change
+    {
+        quint64 version;
+        QString userName;
+    };
+
+    QMap<QString, ServerInfo_User> users;
+    QQueue<Change> history;
+    int historySize;
+    quint64 epoch;
+    quint64 version;
+
+    void addChange(const QString &userName);
+
+public:
+    explicit Server_UserDirectory(int _historySize = 1000);
+
+    void setHistorySize(int _historySize);
+    [[nodiscard]] quint64 getEpoch() const
+    {
+        return epoch;
+    }
+    [[nodiscard]] quint64 getVersion() const
+    {
+        return version;
+    }
+    [[nodiscard]] int size() const
+    {
+        return users.size();
+    }
+
+    /// Adds or replaces @p userInfo, returns the new version.
+    quint64 addUser(const ServerInfo_User &userInfo);
+    /// Removes the user if present, returns the new version.
+    quint64 removeUser(const QString &userName);
+
+    /**
+     * Up to @p pageSize users (all if 0) sorted by name, starting after @p startAfter. If @p userNames is not null,
+     * only these users are listed. @p hasMore tells whether another page follows.
+     */
+    QList<ServerInfo_User>
+    getPage(const QString &startAfter, int pageSize, const QSet<QString> *userNames, bool &hasMore) const;
+    /**
+     * What changed after @p sinceVersion of @p sinceEpoch, limited to @p userNames if not null. Returns false if the
+     * epoch is another one, the history does not reach back that far or the version is unknown; the client then has
+     * to fetch the whole list again.
+     */
+    bool getChangesSince(quint64 sinceEpoch,
+                         quint64 sinceVersion,
+                         const QSet<QString> *userNames,
+                         Changes &changes) const;
+};
+
+#endif
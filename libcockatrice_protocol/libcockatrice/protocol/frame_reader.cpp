@@ -0,0 +1,74 @@
+#include "frame_reader.h"
+
+#include <cstring>
+
+// Below this many consumed bytes the buffer is never compacted; moving a few KB is cheaper than reallocating.
+static const qsizetype minCompactOffset = 4096;
+
+FrameReader::FrameReader() : readOffset(0), pendingLength(-1), pendingCompressed(false)
+{
+}
+
+QByteArray FrameReader::compressPayload(const QByteArray &payload)
+{
+    return qCompress(payload);
+}
+
+QByteArray FrameReader::uncompressPayload(const char *data, int length)
+{
+    return qUncompress(reinterpret_cast<const uchar *>(data), length);
+}
+
+void FrameReader::append(const QByteArray &data)
+{
+    if (readOffset == buffer.size()) {
+        // Everything has been consumed: share the incoming array instead of copying it.
+        buffer = data;
+        readOffset = 0;
+        return;
+    }
+    if (readOffset >= minCompactOffset && readOffset * 2 >= buffer.size()) {
+        buffer.remove(0, readOffset);
+        readOffset = 0;
+    }
+    buffer.append(data);
+}
+
+bool FrameReader::readFrame(const char *&payload, int &length, bool *compressed)
+{
+    if (pendingLength < 0) {
+        if (bytesAvailable() < headerSize)
+            return false;
+        const auto *header = reinterpret_cast<const unsigned char *>(buffer.constData() + readOffset);
+        const quint32 value = (((quint32)header[0]) << 24) + (((quint32)header[1]) << 16) +
+                              (((quint32)header[2]) << 8) + ((quint32)header[3]);
+        pendingLength = value & ~compressedFlag;
+        pendingCompressed = value & compressedFlag;
+        readOffset += headerSize;
+    }
+    if (bytesAvailable() < pendingLength)
+        return false;
+
+    payload = buffer.constData() + readOffset;
+    length = static_cast<int>(pendingLength);
+    if (compressed)
+        *compressed = pendingCompressed;
+    readOffset += pendingLength;
+    pendingLength = -1;
+    pendingCompressed = false;
+    return true;
+}
+
+bool FrameReader::startsWith(const char *prefix) const
+{
+    const auto prefixLength = static_cast<qsizetype>(strlen(prefix));
+    return bytesAvailable() >= prefixLength && memcmp(buffer.constData() + readOffset, prefix, prefixLength) == 0;
+}
+
+void FrameReader::clear()
+{
+    buffer.clear();
+    readOffset = 0;
+    pendingLength = -1;
+    pendingCompressed = false;
+}
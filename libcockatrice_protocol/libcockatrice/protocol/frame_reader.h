@@ -0,0 +1,60 @@
+/**
+ * @file frame_reader.h
+ * @ingroup Messages
+ * @brief Decoder for the 4-byte length-prefixed framing used on TCP connections.
+ */
+
+#ifndef FRAME_READER_H
+#define FRAME_READER_H
+
+#include <QByteArray>
+
+/**
+ * Accumulates incoming socket data and hands out complete frames as views into its buffer.
+ *
+ * Consumed data is tracked with a read offset instead of being removed from the front of the buffer, so pipelined
+ * frames are decoded without moving the remaining bytes each time. The buffer is compacted only when new data is
+ * appended and the consumed prefix makes up at least half of it.
+ *
+ * If the highest bit of a length prefix is set, the payload is compressed with compressPayload(). Servers only send
+ * such frames to clients that listed the "compression" feature on login.
+ */
+class FrameReader
+{
+private:
+    QByteArray buffer;
+    qsizetype readOffset;
+    qint64 pendingLength; // payload length of the frame in progress, or -1 if its header hasn't been read yet
+    bool pendingCompressed;
+
+public:
+    static const int headerSize = 4;
+    static const quint32 compressedFlag = 0x80000000u;
+
+    FrameReader();
+
+    /// zlib stream preceded by the big-endian size of the uncompressed data, as written by qCompress().
+    static QByteArray compressPayload(const QByteArray &payload);
+    /// Returns an empty array if @p data is not a valid compressed payload.
+    static QByteArray uncompressPayload(const char *data, int length);
+
+    void append(const QByteArray &data);
+    /**
+     * Extracts the next complete frame, if there is one.
+     * The payload pointer stays valid until the next call to append() or clear().
+     */
+    bool readFrame(const char *&payload, int &length, bool *compressed = nullptr);
+    /// The next frame has no length prefix and is exactly @p length bytes long.
+    void expectRawFrame(int length)
+    {
+        pendingLength = length;
+    }
+    [[nodiscard]] bool startsWith(const char *prefix) const;
+    [[nodiscard]] qsizetype bytesAvailable() const
+    {
+        return buffer.size() - readOffset;
+    }
+    void clear();
+};
+
+#endif
@@ -0,0 +1,26 @@
+#include "replay_codec.h"
+
+#include <cstring>
+
+QByteArray ReplayCodec::encode(const QByteArray &replay)
+{
+    QByteArray data(magic, sizeof(magic));
+    data.append(formatVersion);
+    data.append(qCompress(replay));
+    return data;
+}
+
+bool ReplayCodec::isEncoded(const QByteArray &data)
+{
+    return data.size() >= headerSize && std::memcmp(data.constData(), magic, sizeof(magic)) == 0;
+}
+
+QByteArray ReplayCodec::decode(const QByteArray &data)
+{
+    if (!isEncoded(data))
+        return data;
+    if (data[sizeof(magic)] != formatVersion)
+        return {};
+    return qUncompress(reinterpret_cast<const uchar *>(data.constData()) + headerSize,
+                       static_cast<int>(data.size() - headerSize));
+}
@@ -0,0 +1,35 @@
+/**
+ * @file replay_codec.h
+ * @ingroup Messages
+ * @brief Storage format of replays in the server database.
+ */
+
+#ifndef REPLAY_CODEC_H
+#define REPLAY_CODEC_H
+
+#include <QByteArray>
+
+/**
+ * Compresses serialized GameReplay messages for storage and download.
+ *
+ * An encoded replay starts with the magic "CoRZ" and a format version byte, followed by the replay compressed with
+ * qCompress(), i.e. the big-endian size of the replay and a zlib stream. A serialized GameReplay can't start with
+ * the magic, as 'C' would be the tag of a group field 8, so replays stored before the format existed are told apart
+ * from encoded ones and are decoded as they are.
+ */
+class ReplayCodec
+{
+public:
+    static constexpr char magic[4] = {'C', 'o', 'R', 'Z'};
+    static constexpr char formatVersion = 1;
+    static constexpr int headerSize = 5;
+    /// The largest part of a stored replay the server sends in one Response_ReplayDownload.
+    static constexpr int downloadChunkSize = 256 * 1024;
+
+    static QByteArray encode(const QByteArray &replay);
+    [[nodiscard]] static bool isEncoded(const QByteArray &data);
+    /// Returns the serialized GameReplay, or an empty array if @p data is encoded in an unknown or broken format.
+    static QByteArray decode(const QByteArray &data);
+};
+
+#endif
@@ -2,6 +2,12 @@
 
 #include <QDebug>
 
+void RNG_Abstract::fill(std::span<unsigned int> numbers, int min, int max)
+{
+    for (unsigned int &number : numbers)
+        number = rand(min, max);
+}
+
 QVector<int> RNG_Abstract::makeNumbersVector(int n, int min, int max)
 {
     const int bins = max - min + 1;
@@ -3,6 +3,8 @@
 
 #include <QObject>
 #include <QVector>
+#include <span>
+#include <utility>
 
 class RNG_Abstract : public QObject
 {
@@ -12,6 +14,14 @@ public:
     {
     }
     virtual unsigned int rand(int min, int max) = 0;
+    /// Fills @p numbers with random numbers from [min, max], distributed like the results of rand(min, max).
+    virtual void fill(std::span<unsigned int> numbers, int min, int max);
+    /// Shuffles [@p begin, @p end) uniformly with the Fisher-Yates algorithm.
+    template <typename Iterator> void shuffle(Iterator begin, Iterator end)
+    {
+        for (int i = static_cast<int>(end - begin) - 1; i > 0; --i)
+            std::swap(begin[rand(0, i)], begin[i]);
+    }
     QVector<int> makeNumbersVector(int n, int min, int max);
     [[nodiscard]] double testRandom(const QVector<int> &numbers) const;
 };
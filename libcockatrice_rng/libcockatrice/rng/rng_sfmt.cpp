@@ -1,6 +1,6 @@
 #include "rng_sfmt.h"
 
-#include <QDateTime>
+#include <QRandomGenerator>
 #include <algorithm>
 #include <climits>
 #include <stdexcept>
@@ -13,8 +13,35 @@
 
 RNG_SFMT::RNG_SFMT(QObject *parent) : RNG_Abstract(parent)
 {
-    // initialize the random number generator with a 32bit integer seed (timestamp)
-    sfmt_init_gen_rand(&sfmt, QDateTime::currentDateTime().toSecsSinceEpoch());
+    // initialize the seed generator with 256 bits from the operating system
+    uint32_t key[8];
+    QRandomGenerator::system()->fillRange(key);
+    sfmt_init_by_array(&seedGenerator, key, 8);
+}
+
+RNG_SFMT::RNG_SFMT(uint32_t seed, QObject *parent) : RNG_Abstract(parent)
+{
+    sfmt_init_gen_rand(&seedGenerator, seed);
+}
+
+/**
+ * The stream of the calling thread, which is created and seeded on first use and deleted by QThreadStorage
+ * when the thread exits.
+ */
+RNG_SFMT::Stream &RNG_SFMT::stream()
+{
+    if (!streams.hasLocalData()) {
+        uint32_t key[8];
+        {
+            QMutexLocker locker(&seedMutex);
+            for (uint32_t &word : key)
+                word = sfmt_genrand_uint32(&seedGenerator);
+        }
+        auto *newStream = new Stream;
+        sfmt_init_by_array(&newStream->sfmt, key, 8);
+        streams.setLocalData(newStream);
+    }
+    return *streams.localData();
 }
 
 /**
@@ -50,11 +77,30 @@ unsigned int RNG_SFMT::rand(int min, int max)
     // This is the only time when min > max is (sort of) legal.
     // Not handling this will cause the application to crash.
     if (min == 0 && max < 0) {
-        return cdf(0, -max);
+        return cdf(stream(), 0, -max);
     }
 
     // No special cases are left, except !(min > max) which is caught in the cdf itself.
-    return cdf(min, max);
+    return cdf(stream(), min, max);
+}
+
+/**
+ * Draws all numbers from the stream of the calling thread, with the same special cases as rand().
+ */
+void RNG_SFMT::fill(std::span<unsigned int> numbers, int min, int max)
+{
+    // rand() throws or does not draw a number at all
+    if (min < 0 || min == max) {
+        RNG_Abstract::fill(numbers, min, max);
+        return;
+    }
+
+    const bool negated = min == 0 && max < 0;
+    const unsigned int lower = negated ? 0 : min;
+    const unsigned int upper = negated ? -max : max;
+    Stream &threadStream = stream();
+    for (unsigned int &number : numbers)
+        number = cdf(threadStream, lower, upper);
 }
 
 /**
@@ -99,7 +145,7 @@ unsigned int RNG_SFMT::rand(int min, int max)
  * Otherwise you will probably skew the outcome of the rand() method or worsen the
  * performance of the application.
  */
-unsigned int RNG_SFMT::cdf(unsigned int min, unsigned int max)
+unsigned int RNG_SFMT::cdf(Stream &stream, unsigned int min, unsigned int max)
 {
     // This all makes no sense if min > max, which should never happen.
     if (min > max) {
@@ -123,13 +169,10 @@ unsigned int RNG_SFMT::cdf(unsigned int min, unsigned int max)
     const uint64_t limit = diameter * buckets;
 
     uint64_t rand;
-    // To make the random number generation thread-safe, a mutex is created around
-    // the generation. Outside of the loop of course, to avoid lock/unlock overhead.
-    mutex.lock();
+    // The stream belongs to the calling thread, so no lock is needed.
     do {
-        rand = sfmt_genrand_uint64(&sfmt);
+        rand = stream.nextRandom();
     } while (rand >= limit);
-    mutex.unlock();
 
     // Now determine the bucket containing the SFMT() random number and after adding
     // the lower bound, a random number from [min, max] can be returned.
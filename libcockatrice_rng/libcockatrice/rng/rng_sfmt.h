@@ -5,6 +5,7 @@
 #include "sfmt/SFMT.h"
 
 #include <QMutex>
+#include <QThreadStorage>
 #include <climits>
 
 /**
@@ -24,20 +25,48 @@
  * These are mapped to values from the interval [min, max] without bias by using Knuth's
  * "Algorithm S (Selection sampling technique)" from "The Art of Computer Programming 3rd
  * Edition Volume 2 / Seminumerical Algorithms".
+ *
+ * Every thread draws from its own SFMT stream, so threads never wait for each other. The streams are
+ * seeded with init_by_array() from a seed generator that is only locked when a thread uses the RNG
+ * for the first time; the seed generator itself is seeded from the system's entropy source. Each stream
+ * generates its numbers in blocks with sfmt_fill_array64(), which uses the SIMD code path.
  */
 
 class RNG_SFMT : public RNG_Abstract
 {
     Q_OBJECT
 private:
-    QMutex mutex;
-    sfmt_t sfmt;
+    struct Stream
+    {
+        static const int bufferSize = 4 * SFMT_N64;
+        sfmt_t sfmt;
+        alignas(16) uint64_t buffer[bufferSize];
+        int next = bufferSize; // the first unused number in buffer
+
+        uint64_t nextRandom()
+        {
+            if (next == bufferSize) {
+                sfmt_fill_array64(&sfmt, buffer, bufferSize);
+                next = 0;
+            }
+            return buffer[next++];
+        }
+    };
+
+    QMutex seedMutex;
+    sfmt_t seedGenerator; // only used to seed the streams
+    QThreadStorage<Stream *> streams;
+
+    Stream &stream();
     // The discrete cumulative distribution function for the RNG
-    unsigned int cdf(unsigned int min, unsigned int max);
+    static unsigned int cdf(Stream &stream, unsigned int min, unsigned int max);
 
 public:
     explicit RNG_SFMT(QObject *parent = nullptr);
+    /// Seeds the streams deterministically from @p seed, for tests.
+    explicit RNG_SFMT(uint32_t seed, QObject *parent = nullptr);
     unsigned int rand(int min, int max) override;
+    void fill(std::span<unsigned int> numbers, int min, int max) override;
 };
 
 #endif
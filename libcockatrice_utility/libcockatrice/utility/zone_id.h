@@ -0,0 +1,61 @@
+#ifndef ZONE_ID_H
+#define ZONE_ID_H
+
+#include <QString>
+#include <string>
+
+/**
+ * The zones every player has, interned as small integers. The server and the client keep these zones in an array
+ * indexed by their id and compare ids instead of names; names are only converted where they are read from or
+ * written to protobuf messages. Zones with any other name have the id Other and are still looked up by name.
+ */
+namespace ZoneId
+{
+enum Id
+{
+    Other = -1,
+    Deck,
+    Sideboard,
+    Table,
+    Hand,
+    Stack,
+    Graveyard,
+    Exile,
+    Count
+};
+
+/// The protocol name of @p id, which must not be Other.
+inline const std::string &stdName(Id id)
+{
+    static const std::string names[Count] = {"deck", "sb", "table", "hand", "stack", "grave", "rfg"};
+    return names[id];
+}
+
+inline QString name(Id id)
+{
+    return QString::fromStdString(stdName(id));
+}
+
+/// The id of the zone called @p name, or Other if it is not one of the zones every player has.
+inline Id fromName(const std::string &name)
+{
+    for (int id = 0; id < Count; ++id) {
+        if (stdName(static_cast<Id>(id)) == name) {
+            return static_cast<Id>(id);
+        }
+    }
+    return Other;
+}
+
+inline Id fromName(const QString &name)
+{
+    for (int id = 0; id < Count; ++id) {
+        if (name == QLatin1String(stdName(static_cast<Id>(id)).c_str())) {
+            return static_cast<Id>(id);
+        }
+    }
+    return Other;
+}
+} // namespace ZoneId
+
+#endif // ZONE_ID_H
@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+"""Measures how fast servatrice accepts and initializes new tcp connections.
+
+Opens many connections at once and waits on each one until the server identification event arrives, which is only
+sent after the session has been set up in its pool. Compare runs with server/reuse_port enabled and disabled.
+
+The server must not limit connections from the benchmarking host: either add it to security/trusted_sources or set
+security/max_users_per_address=0. Raise the open file limit (ulimit -n) on both sides for large runs.
+"""
+
+import argparse, asyncio, struct, sys, time
+
+XML_HELLO_LENGTH = 60
+EMPTY_FRAME = b"\x00\x00\x00\x00"
+
+
+async def connect(host, port, timeout):
+    reader, writer = await asyncio.wait_for(asyncio.open_connection(host, port), timeout)
+    try:
+        await asyncio.wait_for(reader.readexactly(XML_HELLO_LENGTH), timeout)
+        # like the client, switch to protobuf with an empty frame; the session only starts with the first one
+        writer.write(EMPTY_FRAME)
+        await asyncio.wait_for(writer.drain(), timeout)
+        header = await asyncio.wait_for(reader.readexactly(4), timeout)
+        (length,) = struct.unpack(">I", header)
+        await asyncio.wait_for(reader.readexactly(length), timeout)
+        return writer
+    except BaseException:
+        writer.close()
+        raise
+
+
+async def run(host, port, connections, timeout):
+    start = time.monotonic()
+    results = await asyncio.gather(*(connect(host, port, timeout) for _ in range(connections)),
+                                   return_exceptions=True)
+    elapsed = time.monotonic() - start
+
+    accepted = [r for r in results if not isinstance(r, BaseException)]
+    failed = len(results) - len(accepted)
+    for writer in accepted:
+        writer.close()
+
+    print("accepted %d of %d connections in %.3fs (%.0f connections/s)" %
+          (len(accepted), connections, elapsed, len(accepted) / elapsed if elapsed > 0 else 0))
+    if failed:
+        print("%d connections failed" % failed, file=sys.stderr)
+    return failed == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="localhost")
+    parser.add_argument("--port", type=int, default=4747)
+    parser.add_argument("--connections", type=int, default=10000)
+    parser.add_argument("--timeout", type=float, default=30, help="seconds to wait for each connection")
+    args = parser.parse_args()
+
+    ok = asyncio.run(run(args.host, args.port, args.connections, args.timeout))
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -124,6 +124,10 @@ int main(int argc, char *argv[])
     QCommandLineOption testHashFunctionOpt("test-hash", "Test password hash function");
     parser.addOption(testHashFunctionOpt);
 
+    QCommandLineOption compressReplaysOpt("compress-replays",
+                                          "Compress the replays stored by older versions in the database and exit");
+    parser.addOption(compressReplaysOpt);
+
     QCommandLineOption logToConsoleOpt("log-to-console", "Write server logs to console");
     parser.addOption(logToConsoleOpt);
 
@@ -134,6 +138,7 @@ int main(int argc, char *argv[])
 
     bool testRandom = parser.isSet(testRandomOpt);
     bool testHashFunction = parser.isSet(testHashFunctionOpt);
+    bool compressReplays = parser.isSet(compressReplaysOpt);
     bool logToConsole = parser.isSet(logToConsoleOpt);
     QString configPath = parser.value(configPathOpt);
 
@@ -178,6 +183,10 @@ int main(int argc, char *argv[])
     if (testRandom || testHashFunction) {
         return 0;
     }
+    if (compressReplays) {
+        auto *server = new Servatrice();
+        return server->compressStoredReplays() ? 0 : 1;
+    }
 
     smtpClient = new SmtpClient();
 
@@ -36,6 +36,7 @@
 #include <QSqlQuery>
 #include <QString>
 #include <QStringList>
+#include <QThread>
 #include <QTimer>
 #include <QUrl>
 #include <iostream>
@@ -46,6 +47,14 @@
 #include <libcockatrice/protocol/pb/event_server_shutdown.pb.h>
 #include <server_room.h>
 
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
 Servatrice_GameServer::Servatrice_GameServer(Servatrice *_server,
                                              int _numberPools,
                                              const QSqlDatabase &_sqlDatabase,
@@ -54,6 +63,7 @@ Servatrice_GameServer::Servatrice_GameServer(Servatrice *_server,
 {
     for (int i = 0; i < _numberPools; ++i) {
         auto newDatabaseInterface = new Servatrice_DatabaseInterface(i, server);
+        newDatabaseInterface->startExecutor(_sqlDatabase, server->getDatabaseExecutorQueueSize());
         auto newPool = new Servatrice_ConnectionPool(newDatabaseInterface);
 
         auto newThread = new QThread;
@@ -75,6 +85,8 @@ Servatrice_GameServer::~Servatrice_GameServer()
     for (int i = 0; i < connectionPools.size(); ++i) {
         logger->logMessage(QString("Closing pool %1...").arg(i));
         QThread *poolThread = connectionPools[i]->thread();
+        if (i < poolListeners.size())
+            poolListeners[i]->deleteLater();
         connectionPools[i]->deleteLater(); // pool destructor calls thread()->quit()
         poolThread->wait();
         poolThread->deleteLater();
@@ -86,7 +98,6 @@ void Servatrice_GameServer::incomingConnection(qintptr socketDescriptor)
     Servatrice_ConnectionPool *pool = findLeastUsedConnectionPool();
 
     auto ssi = new TcpServerSocketInterface(server, pool->getDatabaseInterface());
-    connect(ssi, SIGNAL(incTxBytes(qint64)), this, SLOT(incTxBytes(qint64)));
     ssi->moveToThread(pool->thread());
     pool->addClient();
     connect(ssi, SIGNAL(destroyed()), pool, SLOT(removeClient()));
@@ -94,6 +105,95 @@ void Servatrice_GameServer::incomingConnection(qintptr socketDescriptor)
     QMetaObject::invokeMethod(ssi, "initConnection", Qt::QueuedConnection, Q_ARG(int, socketDescriptor));
 }
 
+#ifdef Q_OS_LINUX
+/**
+ * Opens a listening socket with SO_REUSEPORT set, so that every pool can bind its own socket to the same port.
+ * Returns the descriptor, or -1 with errno set on failure.
+ */
+static int openReusePortSocket(const QHostAddress &address, quint16 port)
+{
+    sockaddr_storage storage{};
+    socklen_t storageLength;
+    const bool dualStack = address == QHostAddress::Any;
+    if (dualStack || address.protocol() == QAbstractSocket::IPv6Protocol) {
+        auto *addr6 = reinterpret_cast<sockaddr_in6 *>(&storage);
+        addr6->sin6_family = AF_INET6;
+        addr6->sin6_port = htons(port);
+        if (dualStack) {
+            addr6->sin6_addr = in6addr_any;
+        } else {
+            const Q_IPV6ADDR ip = address.toIPv6Address();
+            memcpy(&addr6->sin6_addr, ip.c, sizeof(ip.c));
+        }
+        storageLength = sizeof(sockaddr_in6);
+    } else {
+        auto *addr4 = reinterpret_cast<sockaddr_in *>(&storage);
+        addr4->sin_family = AF_INET;
+        addr4->sin_port = htons(port);
+        addr4->sin_addr.s_addr = htonl(address.toIPv4Address());
+        storageLength = sizeof(sockaddr_in);
+    }
+
+    const int fd = ::socket(storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+        return -1;
+
+    const int on = 1;
+    const int off = 0;
+    if ((dualStack && setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) != 0) ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0 ||
+        bind(fd, reinterpret_cast<sockaddr *>(&storage), storageLength) != 0 || listen(fd, SOMAXCONN) != 0) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+#endif
+
+bool Servatrice_GameServer::listenPerPool(const QHostAddress &address, quint16 port)
+{
+#ifdef Q_OS_LINUX
+    for (Servatrice_ConnectionPool *pool : connectionPools) {
+        const int listenDescriptor = openReusePortSocket(address, port);
+        if (listenDescriptor == -1) {
+            qDebug() << "Could not open listening socket:" << strerror(errno);
+            return false;
+        }
+
+        auto listener = new Servatrice_PoolListener(server, pool);
+        listener->setMaxPendingConnections(maxPendingConnections());
+        listener->moveToThread(pool->thread());
+        poolListeners.append(listener);
+
+        // the socket notifier has to be created in the pool's thread
+        bool listening = false;
+        QMetaObject::invokeMethod(listener, "listenOnDescriptor", Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(bool, listening), Q_ARG(int, listenDescriptor));
+        if (!listening) {
+            ::close(listenDescriptor);
+            return false;
+        }
+    }
+    return true;
+#else
+    Q_UNUSED(address);
+    Q_UNUSED(port);
+    qDebug() << "Per-pool listening sockets (server/reuse_port) are only supported on Linux";
+    return false;
+#endif
+}
+
+void Servatrice_GameServer::closeListeners()
+{
+    close();
+    // each pool listener's socket notifier lives in the pool's thread
+    for (Servatrice_PoolListener *listener : poolListeners)
+        QMetaObject::invokeMethod(listener, [listener] { listener->close(); }, Qt::BlockingQueuedConnection);
+}
+
 Servatrice_ConnectionPool *Servatrice_GameServer::findLeastUsedConnectionPool()
 {
     int minClientCount = -1;
@@ -111,23 +211,76 @@ Servatrice_ConnectionPool *Servatrice_GameServer::findLeastUsedConnectionPool()
     return connectionPools[poolIndex];
 }
 
+bool Servatrice_PoolListener::listenOnDescriptor(int listenDescriptor)
+{
+    if (setSocketDescriptor(listenDescriptor))
+        return true;
+    qDebug() << "Pool listener: Error:" << errorString();
+    return false;
+}
+
+void Servatrice_PoolListener::incomingConnection(qintptr socketDescriptor)
+{
+    // Already running in the pool's thread, so unlike Servatrice_GameServer there is nothing to move or defer.
+    auto ssi = new TcpServerSocketInterface(server, pool->getDatabaseInterface());
+    pool->addClient();
+    connect(ssi, SIGNAL(destroyed()), pool, SLOT(removeClient()));
+
+    ssi->initConnection(static_cast<int>(socketDescriptor));
+}
+
 #define WEBSOCKET_POOL_NUMBER 999
+#define GAME_THREAD_POOL_NUMBER 1999
+
+Servatrice_WebsocketPoolServer::Servatrice_WebsocketPoolServer(Servatrice *_server,
+                                                               Servatrice_ConnectionPool *_pool,
+                                                               QObject *parent)
+    : QWebSocketServer("Servatrice", QWebSocketServer::NonSecureMode, parent), server(_server), pool(_pool)
+{
+    connect(this, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+}
+
+void Servatrice_WebsocketPoolServer::handleSocketDescriptor(int socketDescriptor)
+{
+    auto socket = new QTcpSocket;
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        delete socket;
+        return;
+    }
+    // takes ownership of the socket and emits newConnection() once the handshake is done
+    handleConnection(socket);
+}
+
+void Servatrice_WebsocketPoolServer::onNewConnection()
+{
+    while (hasPendingConnections()) {
+        auto ssi = new WebsocketServerSocketInterface(server, pool->getDatabaseInterface());
+        pool->addClient();
+        connect(ssi, SIGNAL(destroyed()), pool, SLOT(removeClient()));
+
+        QMetaObject::invokeMethod(ssi, "initConnection", Qt::QueuedConnection,
+                                  Q_ARG(void *, nextPendingConnection()));
+    }
+}
 
 Servatrice_WebsocketGameServer::Servatrice_WebsocketGameServer(Servatrice *_server,
                                                                int _numberPools,
                                                                const QSqlDatabase &_sqlDatabase,
                                                                QObject *parent)
-    : QWebSocketServer("Servatrice", QWebSocketServer::NonSecureMode, parent), server(_server)
+    : QTcpServer(parent), server(_server)
 {
     for (int i = 0; i < _numberPools; ++i) {
         int poolNumber = WEBSOCKET_POOL_NUMBER + i;
         auto newDatabaseInterface = new Servatrice_DatabaseInterface(poolNumber, server);
+        newDatabaseInterface->startExecutor(_sqlDatabase, server->getDatabaseExecutorQueueSize());
         auto newPool = new Servatrice_ConnectionPool(newDatabaseInterface);
+        auto newPoolServer = new Servatrice_WebsocketPoolServer(server, newPool);
 
         auto newThread = new QThread;
         newThread->setObjectName("pool_" + QString::number(poolNumber));
         newPool->moveToThread(newThread);
         newDatabaseInterface->moveToThread(newThread);
+        newPoolServer->moveToThread(newThread);
         server->addDatabaseInterface(newThread, newDatabaseInterface);
 
         newThread->start();
@@ -135,8 +288,7 @@ Servatrice_WebsocketGameServer::Servatrice_WebsocketGameServer(Servatrice *_serv
                                   Q_ARG(QSqlDatabase, _sqlDatabase));
 
         connectionPools.append(newPool);
-
-        connect(this, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+        poolServers.append(newPoolServer);
     }
 }
 
@@ -145,30 +297,22 @@ Servatrice_WebsocketGameServer::~Servatrice_WebsocketGameServer()
     for (int i = 0; i < connectionPools.size(); ++i) {
         logger->logMessage(QString("Closing websocket pool %1...").arg(i));
         QThread *poolThread = connectionPools[i]->thread();
+        poolServers[i]->deleteLater();
         connectionPools[i]->deleteLater(); // pool destructor calls thread()->quit()
         poolThread->wait();
         poolThread->deleteLater();
     }
 }
 
-void Servatrice_WebsocketGameServer::onNewConnection()
+void Servatrice_WebsocketGameServer::incomingConnection(qintptr socketDescriptor)
 {
-    Servatrice_ConnectionPool *pool = findLeastUsedConnectionPool();
-
-    auto ssi = new WebsocketServerSocketInterface(server, pool->getDatabaseInterface());
-    connect(ssi, SIGNAL(incTxBytes(quint64)), this, SLOT(incTxBytes(quint64)));
-    /*
-     * Due to a Qt limitation, websockets can't be moved to another thread.
-     * This will hopefully change in Qt6 if QtWebSocket will be integrated in QtNetwork
-     */
-    // ssi->moveToThread(pool->thread());
-    pool->addClient();
-    connect(ssi, SIGNAL(destroyed()), pool, SLOT(removeClient()));
-
-    QMetaObject::invokeMethod(ssi, "initConnection", Qt::QueuedConnection, Q_ARG(void *, nextPendingConnection()));
+    // The handshake and the session both run in the pool's thread; see Servatrice_GameServer::incomingConnection.
+    const int poolIndex = findLeastUsedConnectionPool();
+    QMetaObject::invokeMethod(poolServers[poolIndex], "handleSocketDescriptor", Qt::QueuedConnection,
+                              Q_ARG(int, socketDescriptor));
 }
 
-Servatrice_ConnectionPool *Servatrice_WebsocketGameServer::findLeastUsedConnectionPool()
+int Servatrice_WebsocketGameServer::findLeastUsedConnectionPool()
 {
     int minClientCount = -1;
     int poolIndex = -1;
@@ -182,7 +326,7 @@ Servatrice_ConnectionPool *Servatrice_WebsocketGameServer::findLeastUsedConnecti
         debugStr.append(QString::number(clientCount));
     }
     qDebug().noquote() << "Pool utilisation:" << debugStr.join(", ");
-    return connectionPools[poolIndex];
+    return poolIndex;
 }
 
 void Servatrice_IslServer::incomingConnection(qintptr socketDescriptor)
@@ -199,15 +343,16 @@ void Servatrice_IslServer::incomingConnection(qintptr socketDescriptor)
 }
 
 Servatrice::Servatrice(QObject *parent)
-    : Server(parent), authenticationMethod(AuthenticationNone), uptime(0), txBytes(0), rxBytes(0),
-      shutdownTimer(nullptr)
+    : Server(parent), authenticationMethod(AuthenticationNone), uptime(0), txBytes(0), rxBytes(0), txWrites(0),
+      txFlushes(0), txFlushLatencyTotal(0), txFlushLatencyMax(0), txCompressedFrames(0),
+      txUncompressedBytes(0), txCompressedBytes(0), shutdownTimer(nullptr)
 {
     qRegisterMetaType<QSqlDatabase>("QSqlDatabase");
 }
 
 Servatrice::~Servatrice()
 {
-    gameServer->close();
+    gameServer->closeListeners();
 
     // we are destroying the clients outside their thread!
     for (auto *client : clients) {
@@ -218,10 +363,46 @@ Servatrice::~Servatrice()
         shutdownTimer->deleteLater();
     }
 
+    // the main thread may not get to the deferred delete, so the buffered log rows are written now
+    if (Servatrice_LogSink *logSink = servatriceDatabaseInterface->getLogSink())
+        logSink->flush();
     servatriceDatabaseInterface->deleteLater();
     prepareDestroy();
 }
 
+bool Servatrice::openDatabase()
+{
+    if (getDBTypeString() == "mysql") {
+        databaseType = DatabaseMySql;
+    } else {
+        databaseType = DatabaseNone;
+    }
+    servatriceDatabaseInterface = new Servatrice_DatabaseInterface(-1, this);
+    setDatabaseInterface(servatriceDatabaseInterface);
+
+    if (databaseType != DatabaseNone) {
+        dbPrefix = getDBPrefixString();
+        bool dbOpened = servatriceDatabaseInterface->initDatabase(
+            "QMYSQL", getDBHostNameString(), getDBDatabaseNameString(), getDBUserNameString(), getDBPasswordString());
+        if (!dbOpened) {
+            qDebug() << "Failed to open database";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Servatrice::compressStoredReplays()
+{
+    if (!openDatabase())
+        return false;
+    if (databaseType == DatabaseNone) {
+        qCritical() << "No database configured, there are no stored replays to compress";
+        return false;
+    }
+    return servatriceDatabaseInterface->compressStoredReplays();
+}
+
 bool Servatrice::initServer()
 {
 
@@ -251,6 +432,9 @@ bool Servatrice::initServer()
         qDebug() << "Maximum websocket user limit:" << getMaxWebSocketUserLimit();
     }
 
+    loadTrustedSources();
+    qDebug() << "Trusted sources:" << trustedSources.values();
+
     qDebug() << "Accept registered users only:" << getRegOnlyServerEnabled();
     qDebug() << "Registration enabled:" << getRegistrationEnabled();
     if (getRegistrationEnabled()) {
@@ -284,22 +468,10 @@ bool Servatrice::initServer()
         qDebug() << "Audit reset password attepts enabled:" << getEnableForgotPasswordAudit();
     }
 
-    if (getDBTypeString() == "mysql") {
-        databaseType = DatabaseMySql;
-    } else {
-        databaseType = DatabaseNone;
-    }
-    servatriceDatabaseInterface = new Servatrice_DatabaseInterface(-1, this);
-    setDatabaseInterface(servatriceDatabaseInterface);
+    if (!openDatabase())
+        return false;
 
     if (databaseType != DatabaseNone) {
-        dbPrefix = getDBPrefixString();
-        bool dbOpened = servatriceDatabaseInterface->initDatabase(
-            "QMYSQL", getDBHostNameString(), getDBDatabaseNameString(), getDBUserNameString(), getDBPasswordString());
-        if (!dbOpened) {
-            qDebug() << "Failed to open database";
-            return false;
-        }
         updateServerList();
         qDebug() << "Clearing previous sessions...";
         servatriceDatabaseInterface->clearSessionTables();
@@ -422,14 +594,27 @@ bool Servatrice::initServer()
         statusUpdateClock->start(getServerStatusUpdateTime());
     }
 
+    loadRateLimits();
+    loadUserDirectorySettings();
+
+    if (getNumberOfGameThreads() > 0) {
+        qDebug() << "Starting game executor with" << getNumberOfGameThreads() << "threads";
+        startGameExecutor(getNumberOfGameThreads());
+    }
+
     // SOCKET SERVER
     if (getNumberOfTCPPools() > 0) {
         gameServer =
             new Servatrice_GameServer(this, getNumberOfTCPPools(), servatriceDatabaseInterface->getDatabase(), this);
         gameServer->setMaxPendingConnections(1000);
         QHostAddress tcpHost = getServerTCPHost();
-        qDebug() << "Starting server on host" << tcpHost.toString() << "port" << getServerTCPPort();
-        if (gameServer->listen(tcpHost, static_cast<quint16>(getServerTCPPort())))
+        if (getTCPReusePortEnabled()) {
+            qDebug() << "Starting per-pool listeners on host" << tcpHost.toString() << "port" << getServerTCPPort();
+            if (gameServer->listenPerPool(tcpHost, static_cast<quint16>(getServerTCPPort())))
+                qDebug() << "Server listening.";
+            else
+                return false;
+        } else if (gameServer->listen(tcpHost, static_cast<quint16>(getServerTCPPort())))
             qDebug() << "Server listening.";
         else {
             qDebug() << "gameServer->listen(): Error:" << gameServer->errorString();
@@ -471,6 +656,17 @@ void Servatrice::addDatabaseInterface(QThread *thread, Servatrice_DatabaseInterf
     databaseInterfaces.insert(thread, databaseInterface);
 }
 
+Server_DatabaseInterface *Servatrice::createGameThreadDatabaseInterface(int threadNumber, QThread *thread)
+{
+    auto newDatabaseInterface = new Servatrice_DatabaseInterface(GAME_THREAD_POOL_NUMBER + threadNumber, this);
+    newDatabaseInterface->startExecutor(servatriceDatabaseInterface->getDatabase(), getDatabaseExecutorQueueSize());
+    newDatabaseInterface->moveToThread(thread);
+    connect(thread, &QThread::finished, newDatabaseInterface, &QObject::deleteLater);
+    QMetaObject::invokeMethod(newDatabaseInterface, "initDatabase", Qt::BlockingQueuedConnection,
+                              Q_ARG(QSqlDatabase, servatriceDatabaseInterface->getDatabase()));
+    return newDatabaseInterface;
+}
+
 void Servatrice::updateServerList()
 {
     qDebug() << "Updating server list...";
@@ -509,25 +705,44 @@ QList<ServerProperties> Servatrice::getServerList() const
 
 int Servatrice::getUsersWithAddress(const QHostAddress &address) const
 {
-    int result = 0;
     QReadLocker locker(&clientsLock);
-    for (auto client : clients)
-        if (static_cast<AbstractServerSocketInterface *>(client)->getPeerAddress() == address)
-            ++result;
-
-    return result;
+    return getClientsWithAddress(address.toString()).size();
 }
 
 QList<AbstractServerSocketInterface *> Servatrice::getUsersWithAddressAsList(const QHostAddress &address) const
 {
     QList<AbstractServerSocketInterface *> result;
     QReadLocker locker(&clientsLock);
-    for (auto client : clients)
-        if (static_cast<AbstractServerSocketInterface *>(client)->getPeerAddress() == address)
-            result.append(static_cast<AbstractServerSocketInterface *>(client));
+    for (auto client : getClientsWithAddress(address.toString()))
+        result.append(static_cast<AbstractServerSocketInterface *>(client));
     return result;
 }
 
+void Servatrice::loadTrustedSources()
+{
+    trustedSources.clear();
+    const QStringList sources =
+        settingsCache->value("security/trusted_sources", "127.0.0.1,::1").toString().split(",", Qt::SkipEmptyParts);
+    for (const QString &source : sources) {
+        const QHostAddress address(source.trimmed());
+        if (address.isNull())
+            qDebug() << "Ignoring invalid trusted source:" << source;
+        else
+            trustedSources.insert(address);
+    }
+}
+
+bool Servatrice::isTrustedSource(const QHostAddress &address) const
+{
+    if (trustedSources.contains(address))
+        return true;
+
+    // IPv4 clients of a dual-stack listener show up as IPv4-mapped IPv6 addresses
+    bool isIPv4 = false;
+    const quint32 ipv4 = address.toIPv4Address(&isIPv4);
+    return isIPv4 && trustedSources.contains(QHostAddress(ipv4));
+}
+
 void Servatrice::updateLoginMessage()
 {
     if (!servatriceDatabaseInterface->checkSql())
@@ -585,8 +800,66 @@ void Servatrice::statusUpdate()
 
     txBytesMutex.lock();
     quint64 tx = txBytes;
+    quint64 txw = txWrites;
+    quint64 txf = txFlushes;
+    qint64 txLatencyTotal = txFlushLatencyTotal;
+    qint64 txLatencyMax = txFlushLatencyMax;
+    quint64 txcf = txCompressedFrames;
+    quint64 txub = txUncompressedBytes;
+    quint64 txcb = txCompressedBytes;
     txBytes = 0;
+    txWrites = 0;
+    txFlushes = 0;
+    txFlushLatencyTotal = 0;
+    txFlushLatencyMax = 0;
+    txCompressedFrames = 0;
+    txUncompressedBytes = 0;
+    txCompressedBytes = 0;
     txBytesMutex.unlock();
+    if (txw > 0 && txf > 0) {
+        qDebug() << "Network tx:" << tx << "bytes in" << txw << "writes (" << tx / txw << "bytes/write ), flush latency"
+                 << txLatencyTotal / static_cast<qint64>(txf) << "us avg," << txLatencyMax << "us max";
+    }
+    if (txcf > 0) {
+        qDebug() << "Network tx compression:" << txcf << "frames," << txub << "bytes sent as" << txcb << "bytes ("
+                 << txcb * 100 / txub << "% )";
+    }
+    const Server_RateLimiter::Counters flood = getRateLimiter().takeCounters();
+    if (flood.dropped[Server_RateLimiter::MessageCount] > 0 || flood.dropped[Server_RateLimiter::CommandCount] > 0) {
+        qDebug() << "Flood control: dropped" << flood.dropped[Server_RateLimiter::MessageCount] << "of"
+                 << flood.allowed[Server_RateLimiter::MessageCount] + flood.dropped[Server_RateLimiter::MessageCount]
+                 << "messages (" << flood.dropped[Server_RateLimiter::MessageSize] << "bytes ),"
+                 << flood.dropped[Server_RateLimiter::CommandCount] << "of"
+                 << flood.allowed[Server_RateLimiter::CommandCount] + flood.dropped[Server_RateLimiter::CommandCount]
+                 << "counted game commands";
+    }
+    for (Server_DatabaseInterface *databaseInterface : databaseInterfaces) {
+        auto *servatriceInterface = static_cast<Servatrice_DatabaseInterface *>(databaseInterface);
+        if (Servatrice_LogSink *logSink = servatriceInterface->getLogSink()) {
+            const Servatrice_LogSink::Stats log = logSink->takeStats();
+            if (log.writtenRows > 0 || log.droppedRows > 0 || log.failedRows > 0)
+                qDebug() << "Message log:" << log.writtenRows << "rows in" << log.batches << "batches,"
+                         << log.droppedRows << "dropped," << log.failedRows << "failed, buffer peak"
+                         << log.peakBufferedBytes << "bytes";
+        }
+        Servatrice_DatabaseExecutor *executor = servatriceInterface->getExecutor();
+        if (!executor)
+            continue;
+        const Servatrice_DatabaseExecutor::Stats db = executor->takeStats();
+        QStringList queues;
+        quint64 jobs = 0;
+        for (int priority = 0; priority < Servatrice_DatabaseExecutor::PriorityCount; ++priority) {
+            queues << QString("%1 queued (%2 peak), %3 run, %4 dropped")
+                          .arg(db.queued[priority])
+                          .arg(db.peakQueued[priority])
+                          .arg(db.executed[priority])
+                          .arg(db.dropped[priority]);
+            jobs += db.executed[priority] + db.dropped[priority];
+        }
+        if (jobs > 0)
+            qDebug().noquote() << "Database" << executor->getThread()->objectName()
+                               << "login/logging/statistics:" << queues.join(" / ");
+    }
     rxBytesMutex.lock();
     quint64 rx = rxBytes;
     rxBytes = 0;
@@ -668,10 +941,25 @@ void Servatrice::scheduleShutdown(const QString &reason, int minutes)
     shutdownTimeout();
 }
 
-void Servatrice::incTxBytes(quint64 num)
+void Servatrice::incTxBytes(quint64 num, quint64 writes, qint64 flushLatencyUsec)
 {
     txBytesMutex.lock();
     txBytes += num;
+    txWrites += writes;
+    if (flushLatencyUsec >= 0) {
+        ++txFlushes;
+        txFlushLatencyTotal += flushLatencyUsec;
+        txFlushLatencyMax = qMax(txFlushLatencyMax, flushLatencyUsec);
+    }
+    txBytesMutex.unlock();
+}
+
+void Servatrice::incCompressedTxBytes(quint64 frames, quint64 uncompressedBytes, quint64 compressedBytes)
+{
+    txBytesMutex.lock();
+    txCompressedFrames += frames;
+    txUncompressedBytes += uncompressedBytes;
+    txCompressedBytes += compressedBytes;
     txBytesMutex.unlock();
 }
 
@@ -813,6 +1101,11 @@ bool Servatrice::getStoreReplaysEnabled() const
     return settingsCache->value("game/store_replays", true).toBool();
 }
 
+int Servatrice::getReplayBufferSize() const
+{
+    return settingsCache->value("game/replay_buffer_size", 64 * 1024).toInt();
+}
+
 int Servatrice::getMaxTcpUserLimit() const
 {
     return settingsCache->value("security/max_users_tcp", 500).toInt();
@@ -892,6 +1185,11 @@ QString Servatrice::getDBPasswordString() const
     return settingsCache->value("database/password").toString();
 }
 
+int Servatrice::getDatabaseExecutorQueueSize() const
+{
+    return settingsCache->value("database/executor_queue_size", 10000).toInt();
+}
+
 QString Servatrice::getRoomsMethodString() const
 {
     if (QProcessEnvironment::systemEnvironment().contains("DATABASE_URL")) {
@@ -950,6 +1248,36 @@ int Servatrice::getMaxCommandCountPerInterval() const
     return settingsCache->value("security/max_command_count_per_interval", 20).toInt();
 }
 
+int Servatrice::getCompressionThreshold() const
+{
+    return settingsCache->value("server/compression_threshold", 1024).toInt();
+}
+
+int Servatrice::getGameListUpdateInterval() const
+{
+    return settingsCache->value("server/game_list_update_interval", 250).toInt();
+}
+
+int Servatrice::getUserListHistorySize() const
+{
+    return settingsCache->value("server/user_list_history_size", 1000).toInt();
+}
+
+int Servatrice::getMaxMessageCountPerAddressPerInterval() const
+{
+    return settingsCache->value("security/max_message_count_per_address_per_interval", 0).toInt();
+}
+
+int Servatrice::getMaxMessageSizePerAddressPerInterval() const
+{
+    return settingsCache->value("security/max_message_size_per_address_per_interval", 0).toInt();
+}
+
+int Servatrice::getMaxCommandCountPerAddressPerInterval() const
+{
+    return settingsCache->value("security/max_command_count_per_address_per_interval", 0).toInt();
+}
+
 int Servatrice::getServerStatusUpdateTime() const
 {
     return settingsCache->value("server/statusupdate", 15000).toInt();
@@ -965,6 +1293,16 @@ bool Servatrice::permitCreateGameAsJudge() const
     return settingsCache->value("game/allow_create_as_judge", false).toBool();
 }
 
+int Servatrice::getNumberOfGameThreads() const
+{
+    return settingsCache->value("server/game_threads", 0).toInt();
+}
+
+bool Servatrice::getTCPReusePortEnabled() const
+{
+    return settingsCache->value("server/reuse_port", false).toBool();
+}
+
 QHostAddress Servatrice::getServerTCPHost() const
 {
     QString host = settingsCache->value("server/host", "any").toString();
@@ -24,6 +24,7 @@
 #include <QMetaType>
 #include <QMutex>
 #include <QReadWriteLock>
+#include <QSet>
 #include <QSqlDatabase>
 #include <QSslCertificate>
 #include <QSslKey>
@@ -45,12 +46,37 @@ class AbstractServerSocketInterface;
 class IslInterface;
 class FeatureSet;
 
+/**
+ * Accepts TCP connections for a single pool when server/reuse_port is enabled.
+ * Every pool thread listens on the same port and the kernel spreads incoming connections across them.
+ */
+class Servatrice_PoolListener : public QTcpServer
+{
+    Q_OBJECT
+private:
+    Servatrice *server;
+    Servatrice_ConnectionPool *pool;
+
+public:
+    Servatrice_PoolListener(Servatrice *_server, Servatrice_ConnectionPool *_pool, QObject *parent = nullptr)
+        : QTcpServer(parent), server(_server), pool(_pool)
+    {
+    }
+
+public slots:
+    bool listenOnDescriptor(int listenDescriptor);
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+};
+
 class Servatrice_GameServer : public QTcpServer
 {
     Q_OBJECT
 private:
     Servatrice *server;
     QList<Servatrice_ConnectionPool *> connectionPools;
+    QList<Servatrice_PoolListener *> poolListeners;
 
 public:
     Servatrice_GameServer(Servatrice *_server,
@@ -59,17 +85,42 @@ public:
                           QObject *parent = nullptr);
     ~Servatrice_GameServer() override;
 
+    bool listenPerPool(const QHostAddress &address, quint16 port);
+    /// Stops accepting connections, on the shared listening socket and on the ones of the pools.
+    void closeListeners();
+
 protected:
     void incomingConnection(qintptr socketDescriptor) override;
     Servatrice_ConnectionPool *findLeastUsedConnectionPool();
 };
 
-class Servatrice_WebsocketGameServer : public QWebSocketServer
+/**
+ * Performs the WebSocket handshake for the connections of one pool.
+ * Lives in the pool's thread, so the upgraded sockets and their sessions are created there.
+ */
+class Servatrice_WebsocketPoolServer : public QWebSocketServer
+{
+    Q_OBJECT
+private:
+    Servatrice *server;
+    Servatrice_ConnectionPool *pool;
+
+public:
+    Servatrice_WebsocketPoolServer(Servatrice *_server, Servatrice_ConnectionPool *_pool, QObject *parent = nullptr);
+
+public slots:
+    void handleSocketDescriptor(int socketDescriptor);
+protected slots:
+    void onNewConnection();
+};
+
+class Servatrice_WebsocketGameServer : public QTcpServer
 {
     Q_OBJECT
 private:
     Servatrice *server;
     QList<Servatrice_ConnectionPool *> connectionPools;
+    QList<Servatrice_WebsocketPoolServer *> poolServers;
 
 public:
     Servatrice_WebsocketGameServer(Servatrice *_server,
@@ -79,9 +130,8 @@ public:
     ~Servatrice_WebsocketGameServer() override;
 
 protected:
-    Servatrice_ConnectionPool *findLeastUsedConnectionPool();
-protected slots:
-    void onNewConnection();
+    void incomingConnection(qintptr socketDescriptor) override;
+    int findLeastUsedConnectionPool();
 };
 
 class Servatrice_IslServer : public QTcpServer
@@ -143,6 +193,7 @@ private slots:
 
 protected:
     void doSendIslMessage(const IslMessage &msg, int _serverId) override;
+    Server_DatabaseInterface *createGameThreadDatabaseInterface(int threadNumber, QThread *thread) override;
 
 private:
     enum DatabaseType
@@ -166,6 +217,9 @@ private:
     int uptime;
     QMutex txBytesMutex, rxBytesMutex;
     quint64 txBytes, rxBytes;
+    quint64 txWrites, txFlushes;
+    qint64 txFlushLatencyTotal, txFlushLatencyMax; // microseconds
+    quint64 txCompressedFrames, txUncompressedBytes, txCompressedBytes;
 
     QString shutdownReason;
     int shutdownMinutes;
@@ -178,16 +232,23 @@ private:
 
     QMap<int, IslInterface *> islInterfaces;
 
+    QSet<QHostAddress> trustedSources;
+    void loadTrustedSources();
+
+    bool openDatabase();
     QString getDBPrefixString() const;
     QString getDBHostNameString() const;
     QString getDBDatabaseNameString() const;
     QString getDBUserNameString() const;
     QString getDBPasswordString() const;
+    int getDatabaseExecutorQueueSize() const;
     QString getRoomsMethodString() const;
     QString getISLNetworkSSLCertFile() const;
     QString getISLNetworkSSLKeyFile() const;
     int getServerStatusUpdateTime() const;
     int getNumberOfTCPPools() const;
+    bool getTCPReusePortEnabled() const;
+    int getNumberOfGameThreads() const;
     int getServerTCPPort() const;
     int getNumberOfWebSocketPools() const;
     int getServerWebSocketPort() const;
@@ -206,6 +267,8 @@ public:
     explicit Servatrice(QObject *parent = nullptr);
     ~Servatrice() override;
     bool initServer();
+    /// Opens the database and compresses the replays stored before ReplayCodec, instead of running the server.
+    bool compressStoredReplays();
     QMap<QString, bool> getServerRequiredFeatureList() const override
     {
         return serverRequiredFeatureList;
@@ -241,6 +304,7 @@ public:
     bool getRegOnlyServerEnabled() const override;
     bool getMaxUserLimitEnabled() const override;
     bool getStoreReplaysEnabled() const override;
+    int getReplayBufferSize() const override;
     bool getRegistrationEnabled() const;
     bool getRequireEmailForRegistrationEnabled() const;
     bool getRequireEmailActivationEnabled() const;
@@ -263,15 +327,23 @@ public:
     int getMaxGamesPerUser() const override;
     int getCommandCountingInterval() const override;
     int getMaxCommandCountPerInterval() const override;
+    int getCompressionThreshold() const override;
+    int getGameListUpdateInterval() const override;
+    int getUserListHistorySize() const override;
+    int getMaxMessageCountPerAddressPerInterval() const override;
+    int getMaxMessageSizePerAddressPerInterval() const override;
+    int getMaxCommandCountPerAddressPerInterval() const override;
     int getMaxUserTotal() const override;
     bool permitCreateGameAsJudge() const override;
     int getMaxTcpUserLimit() const;
     int getMaxWebSocketUserLimit() const;
     int getUsersWithAddress(const QHostAddress &address) const;
+    bool isTrustedSource(const QHostAddress &address) const;
     int getMaxAccountsPerEmail() const;
     int getForgotPasswordTokenLife() const;
     QList<AbstractServerSocketInterface *> getUsersWithAddressAsList(const QHostAddress &address) const;
-    void incTxBytes(quint64 num);
+    void incTxBytes(quint64 num, quint64 writes = 1, qint64 flushLatencyUsec = -1);
+    void incCompressedTxBytes(quint64 frames, quint64 uncompressedBytes, quint64 compressedBytes);
     void incRxBytes(quint64 num);
     void addDatabaseInterface(QThread *thread, Servatrice_DatabaseInterface *databaseInterface);
 
@@ -0,0 +1,79 @@
+#include "servatrice_database_executor.h"
+
+#include <QDebug>
+#include <QObject>
+#include <QThread>
+
+Servatrice_DatabaseExecutor::Servatrice_DatabaseExecutor(const QString &name, int _maxQueuedJobs)
+    : maxQueuedJobs(_maxQueuedJobs), runScheduled(false)
+{
+    thread = new QThread;
+    thread->setObjectName(name);
+    worker = new QObject;
+    worker->moveToThread(thread);
+    QObject::connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    thread->start();
+}
+
+Servatrice_DatabaseExecutor::~Servatrice_DatabaseExecutor()
+{
+    // the writes posted so far are not lost
+    QMetaObject::invokeMethod(worker, [this] { runJobs(); }, Qt::BlockingQueuedConnection);
+    thread->quit();
+    thread->wait();
+    delete thread;
+}
+
+bool Servatrice_DatabaseExecutor::post(Priority priority, Job job)
+{
+    {
+        QMutexLocker locker(&mutex);
+        QQueue<Job> &queue = queues[priority];
+        if (priority != PriorityLogin && queue.size() >= maxQueuedJobs) {
+            if (stats.dropped[priority]++ == 0)
+                qWarning() << "Servatrice_DatabaseExecutor:" << thread->objectName() << "queue" << priority
+                           << "is full, dropping jobs";
+            return false;
+        }
+        queue.enqueue(std::move(job));
+        stats.peakQueued[priority] = qMax(stats.peakQueued[priority], static_cast<int>(queue.size()));
+        if (runScheduled)
+            return true;
+        runScheduled = true;
+    }
+    QMetaObject::invokeMethod(worker, [this] { runJobs(); }, Qt::QueuedConnection);
+    return true;
+}
+
+void Servatrice_DatabaseExecutor::runJobs()
+{
+    forever {
+        Job job;
+        {
+            QMutexLocker locker(&mutex);
+            int priority = 0;
+            while (priority < PriorityCount && queues[priority].isEmpty())
+                ++priority;
+            if (priority == PriorityCount) {
+                runScheduled = false;
+                return;
+            }
+            job = queues[priority].dequeue();
+            ++stats.executed[priority];
+        }
+        job();
+    }
+}
+
+Servatrice_DatabaseExecutor::Stats Servatrice_DatabaseExecutor::takeStats()
+{
+    QMutexLocker locker(&mutex);
+    Stats result = stats;
+    for (int priority = 0; priority < PriorityCount; ++priority) {
+        result.queued[priority] = static_cast<int>(queues[priority].size());
+        stats.peakQueued[priority] = result.queued[priority];
+        stats.executed[priority] = 0;
+        stats.dropped[priority] = 0;
+    }
+    return result;
+}
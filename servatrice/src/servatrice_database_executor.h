@@ -0,0 +1,89 @@
+#ifndef SERVATRICE_DATABASE_EXECUTOR_H
+#define SERVATRICE_DATABASE_EXECUTOR_H
+
+#include <QFuture>
+#include <QFutureInterface>
+#include <QMutex>
+#include <QQueue>
+#include <functional>
+
+class QObject;
+class QThread;
+
+/**
+ * Runs the database work of one connection pool on a dedicated thread.
+ *
+ * Jobs wait in one queue per priority and the worker always takes the oldest job of the most important non-empty
+ * queue, so a login doesn't wait behind a burst of chat log writes. Posting never blocks: when the queue of a
+ * lower priority is full the new job is dropped and counted instead. The login queue is not bounded, its login data
+ * and audit records must not get lost. Jobs still queued when the executor is destroyed are run before its thread
+ * stops.
+ *
+ * A job runs with no lock held; it typically calls a database interface that lives in getThread().
+ */
+class Servatrice_DatabaseExecutor
+{
+public:
+    enum Priority
+    {
+        PriorityLogin, // never dropped
+        PriorityLogging,
+        PriorityStatistics,
+        PriorityCount
+    };
+    using Job = std::function<void()>;
+
+    struct Stats
+    {
+        int queued[PriorityCount] = {};
+        int peakQueued[PriorityCount] = {};   // since the last takeStats()
+        quint64 executed[PriorityCount] = {}; // since the last takeStats()
+        quint64 dropped[PriorityCount] = {};  // since the last takeStats()
+    };
+
+private:
+    mutable QMutex mutex;
+    QQueue<Job> queues[PriorityCount];
+    int maxQueuedJobs;
+    bool runScheduled;
+    Stats stats;
+    QThread *thread;
+    QObject *worker;
+
+    void runJobs();
+
+public:
+    Servatrice_DatabaseExecutor(const QString &name, int _maxQueuedJobs);
+    ~Servatrice_DatabaseExecutor();
+    Servatrice_DatabaseExecutor(const Servatrice_DatabaseExecutor &) = delete;
+    Servatrice_DatabaseExecutor &operator=(const Servatrice_DatabaseExecutor &) = delete;
+
+    [[nodiscard]] QThread *getThread() const
+    {
+        return thread;
+    }
+
+    /// Queues a job, returns false if its queue is full and the job was dropped; PriorityLogin jobs always queue.
+    bool post(Priority priority, Job job);
+
+    /// Queues a query and returns its result as a future, which is canceled if the job was dropped.
+    template <typename T> QFuture<T> submit(Priority priority, std::function<T()> query)
+    {
+        QFutureInterface<T> promise;
+        promise.reportStarted();
+        const bool queued = post(priority, [promise, query]() mutable {
+            promise.reportResult(query());
+            promise.reportFinished();
+        });
+        if (!queued) {
+            promise.reportCanceled();
+            promise.reportFinished();
+        }
+        return promise.future();
+    }
+
+    /// Returns the counters and resets the ones that cover the time since the last call.
+    Stats takeStats();
+};
+
+#endif
@@ -7,19 +7,31 @@
 #include <QChar>
 #include <QDateTime>
 #include <QDebug>
+#include <QScopeGuard>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QThread>
+#include <game/server_replay_writer.h>
 #include <libcockatrice/deck_list/deck_list.h>
-#include <libcockatrice/protocol/pb/game_replay.pb.h>
+#include <libcockatrice/protocol/replay_codec.h>
 #include <libcockatrice/utility/passwordhasher.h>
 
 Servatrice_DatabaseInterface::Servatrice_DatabaseInterface(int _instanceId, Servatrice *_server)
-    : instanceId(_instanceId), sqlDatabase(QSqlDatabase()), server(_server)
+    : instanceId(_instanceId), sqlDatabase(QSqlDatabase()), server(_server),
+      storageQueries([this](const QString &queryText) { return prepareQuery(queryText); },
+                     [this](QSqlQuery *query) { return execSqlQuery(query); }),
+      reconnectPending(false), executor(nullptr), executorInterface(nullptr), isExecutorInterface(false),
+      logSink(nullptr)
 {
 }
 
 Servatrice_DatabaseInterface::~Servatrice_DatabaseInterface()
 {
+    // runs the writes that are still queued, the executor interface is deleted when its thread has finished
+    delete executor;
+    // writes the buffered log rows while the connection is still open
+    delete logSink;
+
     // reset all prepared statements
     qDeleteAll(preparedStatements);
     preparedStatements.clear();
@@ -30,11 +42,29 @@ Servatrice_DatabaseInterface::~Servatrice_DatabaseInterface()
 void Servatrice_DatabaseInterface::initDatabase(const QSqlDatabase &_sqlDatabase)
 {
     if (_sqlDatabase.isValid()) {
-        sqlDatabase = QSqlDatabase::cloneDatabase(_sqlDatabase, "pool_" + QString::number(instanceId));
+        const QString connectionName = "pool_" + QString::number(instanceId) + (isExecutorInterface ? "_db" : "");
+        sqlDatabase = QSqlDatabase::cloneDatabase(_sqlDatabase, connectionName);
         openDatabase();
+        // with an executor, the log is written by the executor interface
+        if (!executor)
+            startLogSink();
     }
 }
 
+void Servatrice_DatabaseInterface::startExecutor(const QSqlDatabase &_sqlDatabase, int maxQueuedJobs)
+{
+    if (executor || !_sqlDatabase.isValid() || maxQueuedJobs <= 0)
+        return;
+
+    executor = new Servatrice_DatabaseExecutor("db_" + QString::number(instanceId), maxQueuedJobs);
+    executorInterface = new Servatrice_DatabaseInterface(instanceId, server);
+    executorInterface->isExecutorInterface = true;
+    executorInterface->moveToThread(executor->getThread());
+    QObject::connect(executor->getThread(), &QThread::finished, executorInterface, &QObject::deleteLater);
+    QMetaObject::invokeMethod(executorInterface, "initDatabase", Qt::BlockingQueuedConnection,
+                              Q_ARG(QSqlDatabase, _sqlDatabase));
+}
+
 bool Servatrice_DatabaseInterface::initDatabase(const QString &type,
                                                 const QString &hostName,
                                                 const QString &databaseName,
@@ -47,7 +77,20 @@ bool Servatrice_DatabaseInterface::initDatabase(const QString &type,
     sqlDatabase.setUserName(userName);
     sqlDatabase.setPassword(password);
 
-    return openDatabase();
+    const bool opened = openDatabase();
+    startLogSink();
+    return opened;
+}
+
+void Servatrice_DatabaseInterface::startLogSink()
+{
+    const QString overflowPolicy = settingsCache->value("logging/overflow_policy", "drop_newest").toString();
+    logSink = new Servatrice_LogSink(
+        [this](const QList<Servatrice_LogSink::Entry> &entries) { return insertLogMessages(entries); },
+        settingsCache->value("logging/flush_interval", 1000).toInt(),
+        settingsCache->value("logging/batch_rows", 500).toInt(),
+        settingsCache->value("logging/buffer_size", 4 * 1024 * 1024).toLongLong(),
+        overflowPolicy == "drop_oldest" ? Servatrice_LogSink::DropOldest : Servatrice_LogSink::DropNewest, this);
 }
 
 bool Servatrice_DatabaseInterface::openDatabase()
@@ -127,6 +170,11 @@ bool Servatrice_DatabaseInterface::checkSql()
 
 QSqlQuery *Servatrice_DatabaseInterface::prepareQuery(const QString &queryText)
 {
+    if (reconnectPending) {
+        reconnectPending = false;
+        openDatabase();
+    }
+
     if (preparedStatements.contains(queryText)) {
         return preparedStatements.value(queryText);
     }
@@ -146,8 +194,8 @@ bool Servatrice_DatabaseInterface::execSqlQuery(QSqlQuery *query)
         return true;
     const QString poolStr = instanceId == -1 ? QString("main") : QString("pool %1").arg(instanceId);
     qCritical() << QString("[%1] Error executing query: %2").arg(poolStr).arg(query->lastError().text());
-    sqlDatabase.close();
-    openDatabase();
+    // reconnecting here would delete the query while the caller still reads its error, so it waits for the next one
+    reconnectPending = true;
     return false;
 }
 
@@ -830,8 +878,17 @@ void Servatrice_DatabaseInterface::storeGameInformation(const QString &roomName,
                                                         const ServerInfo_Game &gameInfo,
                                                         const QSet<QString> &allPlayersEver,
                                                         const QSet<QString> &allSpectatorsEver,
-                                                        const QList<GameReplay *> &replayList)
+                                                        const QList<Server_ReplayWriter *> &replayList)
 {
+    // When the queue is full the game is stored right here instead: a slow database then holds up the clients of this
+    // thread for a moment, but the game and its replays aren't lost.
+    if (executor && executor->post(Servatrice_DatabaseExecutor::PriorityStatistics, [=, target = executorInterface] {
+            target->storeGameInformation(roomName, roomGameTypes, gameInfo, allPlayersEver, allSpectatorsEver,
+                                         replayList);
+        }))
+        return;
+    const auto deleteReplays = qScopeGuard([&replayList] { qDeleteAll(replayList); });
+
     if (!checkSql())
         return;
 
@@ -856,23 +913,6 @@ void Servatrice_DatabaseInterface::storeGameInformation(const QString &roomName,
         replayNames.append(QString::fromStdString(gameInfo.description()));
     }
 
-    QVariantList replayIds, replayGameIds, replayDurations, replayBlobs;
-    for (int i = 0; i < replayList.size(); ++i) {
-        QByteArray blob;
-#if GOOGLE_PROTOBUF_VERSION > 3001000
-        const unsigned int size = static_cast<unsigned int>(replayList[i]->ByteSizeLong());
-#else
-        const unsigned int size = static_cast<unsigned int>(replayList[i]->ByteSize());
-#endif
-        blob.resize(size);
-        replayList[i]->SerializeToArray(blob.data(), size);
-
-        replayIds.append(QVariant((qulonglong)replayList[i]->replay_id()));
-        replayGameIds.append(gameInfo.game_id());
-        replayDurations.append(replayList[i]->duration_seconds());
-        replayBlobs.append(blob);
-    }
-
     {
         QSqlQuery *query = prepareQuery("update {prefix}_games set room_name=:room_name, descr=:descr, "
                                         "creator_name=:creator_name, password=:password, game_types=:game_types, "
@@ -894,14 +934,15 @@ void Servatrice_DatabaseInterface::storeGameInformation(const QString &roomName,
         query->bindValue(":player_name", playerNames);
         query->execBatch();
     }
-    {
+    // one replay at a time, so only one of them is read back into memory at once
+    for (Server_ReplayWriter *replay : replayList) {
         QSqlQuery *query = prepareQuery(
             "update {prefix}_replays set id_game=:id_game, duration=:duration, replay=:replay where id=:id_replay");
-        query->bindValue(":id_replay", replayIds);
-        query->bindValue(":id_game", replayGameIds);
-        query->bindValue(":duration", replayDurations);
-        query->bindValue(":replay", replayBlobs);
-        query->execBatch();
+        query->bindValue(":id_replay", (qulonglong)replay->getReplayId());
+        query->bindValue(":id_game", gameInfo.game_id());
+        query->bindValue(":duration", replay->getDurationSeconds());
+        query->bindValue(":replay", ReplayCodec::encode(replay->readReplay()));
+        execSqlQuery(query);
     }
     {
         QSqlQuery *query = prepareQuery("insert into {prefix}_replays_access (id_game, id_player, replay_name) values "
@@ -913,6 +954,51 @@ void Servatrice_DatabaseInterface::storeGameInformation(const QString &roomName,
     }
 }
 
+bool Servatrice_DatabaseInterface::compressStoredReplays()
+{
+    if (!checkSql())
+        return false;
+
+    // a few rows at a time, so neither the server nor the database holds all replays at once
+    const int rowsPerBatch = 100;
+    int lastId = 0, compressedCount = 0;
+    qint64 bytesBefore = 0, bytesAfter = 0;
+    forever {
+        QList<QPair<int, QByteArray>> rows;
+        QSqlQuery *query =
+            prepareQuery("select id, replay from {prefix}_replays where id > :id order by id limit :rows");
+        query->bindValue(":id", lastId);
+        query->bindValue(":rows", rowsPerBatch);
+        if (!execSqlQuery(query))
+            return false;
+        while (query->next())
+            rows.append({query->value(0).toInt(), query->value(1).toByteArray()});
+        if (rows.isEmpty())
+            break;
+
+        for (const auto &row : rows) {
+            lastId = row.first;
+            // the rows of running games are still empty
+            if (row.second.isEmpty() || ReplayCodec::isEncoded(row.second))
+                continue;
+
+            const QByteArray encoded = ReplayCodec::encode(row.second);
+            QSqlQuery *update = prepareQuery("update {prefix}_replays set replay = :replay where id = :id");
+            update->bindValue(":replay", encoded);
+            update->bindValue(":id", row.first);
+            if (!execSqlQuery(update))
+                return false;
+            ++compressedCount;
+            bytesBefore += row.second.size();
+            bytesAfter += encoded.size();
+        }
+        qDebug() << "Compressed" << compressedCount << "replays up to id" << lastId;
+    }
+
+    qDebug() << "Compressed" << compressedCount << "replays from" << bytesBefore << "to" << bytesAfter << "bytes";
+    return true;
+}
+
 DeckList *Servatrice_DatabaseInterface::getDeckFromDatabase(int deckId, int userId)
 {
     checkSql();
@@ -942,22 +1028,22 @@ void Servatrice_DatabaseInterface::logMessage(const int senderId,
     QString targetTypeString;
     switch (targetType) {
         case MessageTargetRoom:
-            if (!settingsCache->value("logging/log_user_msg_room", 0).toBool())
+            if (!settingsCache->logUserMessagesRoom)
                 return;
             targetTypeString = "room";
             break;
         case MessageTargetGame:
-            if (!settingsCache->value("logging/log_user_msg_game", 0).toBool())
+            if (!settingsCache->logUserMessagesGame)
                 return;
             targetTypeString = "game";
             break;
         case MessageTargetChat:
-            if (!settingsCache->value("logging/log_user_msg_chat", 0).toBool())
+            if (!settingsCache->logUserMessagesChat)
                 return;
             targetTypeString = "chat";
             break;
         case MessageTargetIslRoom:
-            if (!settingsCache->value("logging/log_user_msg_isl", 0).toBool())
+            if (!settingsCache->logUserMessagesIsl)
                 return;
             targetTypeString = "room";
             break;
@@ -965,17 +1051,62 @@ void Servatrice_DatabaseInterface::logMessage(const int senderId,
             return;
     }
 
-    QSqlQuery *query = prepareQuery("insert into {prefix}_log (log_time, sender_id, sender_name, sender_ip, "
-                                    "log_message, target_type, target_id, target_name) values (now(), :sender_id, "
-                                    ":sender_name, :sender_ip, :log_message, :target_type, :target_id, :target_name)");
-    query->bindValue(":sender_id", senderId < 1 ? QVariant() : senderId);
-    query->bindValue(":sender_name", senderName);
-    query->bindValue(":sender_ip", senderIp);
-    query->bindValue(":log_message", logMessage);
-    query->bindValue(":target_type", targetTypeString);
-    query->bindValue(":target_id", (targetType == MessageTargetChat && targetId < 1) ? QVariant() : targetId);
-    query->bindValue(":target_name", targetName);
-    execSqlQuery(query);
+    const Servatrice_LogSink::Entry entry{QDateTime::currentDateTimeUtc(),
+                                          senderId < 1 ? QVariant() : senderId,
+                                          senderName,
+                                          senderIp,
+                                          logMessage,
+                                          targetTypeString,
+                                          (targetType == MessageTargetChat && targetId < 1) ? QVariant() : targetId,
+                                          targetName};
+    if (Servatrice_LogSink *sink = getLogSink())
+        sink->append(entry);
+    else
+        insertLogMessages({entry});
+}
+
+bool Servatrice_DatabaseInterface::insertLogMessages(const QList<Servatrice_LogSink::Entry> &entries)
+{
+    if (!checkSql())
+        return false;
+
+    // log_time is in the database's clock like the other times and the log search, so the rows store how long ago
+    // their message was said rather than the host's time
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const bool inTransaction = entries.size() > 1 && sqlDatabase.transaction();
+    int inserted = 0;
+    while (inserted < entries.size()) {
+        // statements for 32, 16, 8, ... rows, so only a handful of them is ever prepared
+        int rows = maxLogRowsPerInsert;
+        while (rows > entries.size() - inserted)
+            rows /= 2;
+
+        QStringList values;
+        for (int i = 0; i < rows; ++i)
+            values.append("(now() - interval ? second, ?, ?, ?, ?, ?, ?, ?)");
+        QSqlQuery *query = prepareQuery("insert into {prefix}_log (log_time, sender_id, sender_name, sender_ip, "
+                                        "log_message, target_type, target_id, target_name) values " +
+                                        values.join(", "));
+        for (int i = 0; i < rows; ++i) {
+            const Servatrice_LogSink::Entry &entry = entries[inserted + i];
+            const int column = i * 8;
+            query->bindValue(column, qMax(entry.time.secsTo(now), qint64(0)));
+            query->bindValue(column + 1, entry.senderId);
+            query->bindValue(column + 2, entry.senderName);
+            query->bindValue(column + 3, entry.senderIp);
+            query->bindValue(column + 4, entry.message);
+            query->bindValue(column + 5, entry.targetType);
+            query->bindValue(column + 6, entry.targetId);
+            query->bindValue(column + 7, entry.targetName);
+        }
+        if (!execSqlQuery(query)) {
+            if (inTransaction)
+                sqlDatabase.rollback();
+            return false;
+        }
+        inserted += rows;
+    }
+    return !inTransaction || sqlDatabase.commit();
 }
 
 bool Servatrice_DatabaseInterface::changeUserPassword(const QString &user,
@@ -1075,6 +1206,12 @@ void Servatrice_DatabaseInterface::updateUsersClientID(const QString &userName,
 
 void Servatrice_DatabaseInterface::updateUsersLastLoginData(const QString &userName, const QString &clientVersion)
 {
+    if (executor) {
+        executor->post(Servatrice_DatabaseExecutor::PriorityLogin, [=, target = executorInterface] {
+            target->updateUsersLastLoginData(userName, clientVersion);
+        });
+        return;
+    }
 
     if (!checkSql())
         return;
@@ -1119,6 +1256,31 @@ void Servatrice_DatabaseInterface::updateUsersLastLoginData(const QString &userN
     }
 }
 
+bool Servatrice_DatabaseInterface::addUsersBan(const QString &userName,
+                                               const QString &ipAddress,
+                                               int adminId,
+                                               int minutes,
+                                               const QString &reason,
+                                               const QString &visibleReason,
+                                               const QString &clientId)
+{
+    // not on the executor: the ban has to be in place before the user is kicked and can log in again
+    if (!checkSql())
+        return false;
+
+    QSqlQuery *query = prepareQuery(
+        "insert into {prefix}_bans (user_name, ip_address, id_admin, time_from, minutes, reason, visible_reason, "
+        "clientid) values(:user_name, :ip_address, :id_admin, NOW(), :minutes, :reason, :visible_reason, :client_id)");
+    query->bindValue(":user_name", userName);
+    query->bindValue(":ip_address", ipAddress);
+    query->bindValue(":id_admin", adminId);
+    query->bindValue(":minutes", minutes);
+    query->bindValue(":reason", reason);
+    query->bindValue(":visible_reason", visibleReason);
+    query->bindValue(":client_id", clientId);
+    return execSqlQuery(query);
+}
+
 QList<ServerInfo_Ban> Servatrice_DatabaseInterface::getUserBanHistory(const QString userName)
 {
     QList<ServerInfo_Ban> results;
@@ -1433,6 +1595,13 @@ void Servatrice_DatabaseInterface::addAuditRecord(const QString &user,
                                                   const QString &details,
                                                   const bool &results = false)
 {
+    if (executor) {
+        executor->post(Servatrice_DatabaseExecutor::PriorityLogin, [=, target = executorInterface] {
+            target->addAuditRecord(user, ipaddress, clientid, action, details, results);
+        });
+        return;
+    }
+
     if (!checkSql())
         return;
 
@@ -1,6 +1,10 @@
 #ifndef SERVATRICE_DATABASE_INTERFACE_H
 #define SERVATRICE_DATABASE_INTERFACE_H
 
+#include "servatrice_database_executor.h"
+#include "servatrice_log_sink.h"
+#include "servatrice_storage_queries.h"
+
 #include <QChar>
 #include <QHash>
 #include <QObject>
@@ -22,6 +26,13 @@ private:
     QSqlDatabase sqlDatabase;
     QHash<QString, QSqlQuery *> preparedStatements;
     Servatrice *server;
+    Servatrice_StorageQueries storageQueries;
+    bool reconnectPending;
+    // the writes that nobody waits for run on the executor, against a second connection that lives in its thread
+    Servatrice_DatabaseExecutor *executor;
+    Servatrice_DatabaseInterface *executorInterface;
+    bool isExecutorInterface;
+    Servatrice_LogSink *logSink; // on the interface that writes the message log, i.e. the executor interface if any
     ServerInfo_User evalUserQueryResult(const QSqlQuery *query, bool complete, bool withId = false);
     /** Must be called after checkSql and server is known to be in auth mode. */
     bool checkUserIsIdBanned(const QString &clientId, QString &banReason, int &banSecondsRemaining);
@@ -29,6 +40,9 @@ private:
     bool checkUserIsIpBanned(const QString &ipAddress, QString &banReason, int &banSecondsRemaining);
     /** Must be called after checkSql and server is known to be in auth mode. */
     bool checkUserIsNameBanned(QString const &userName, QString &banReason, int &banSecondsRemaining);
+    static const int maxLogRowsPerInsert = 32;
+    void startLogSink();
+    bool insertLogMessages(const QList<Servatrice_LogSink::Entry> &entries);
 
 protected:
     AuthenticationResult checkUserPassword(Server_ProtocolHandler *handler,
@@ -51,6 +65,16 @@ public:
                       const QString &userName,
                       const QString &password);
     bool openDatabase();
+    /// Opens a second connection to the same database, used by an executor thread for the writes of this pool.
+    void startExecutor(const QSqlDatabase &_sqlDatabase, int maxQueuedJobs);
+    Servatrice_DatabaseExecutor *getExecutor() const
+    {
+        return executor;
+    }
+    Servatrice_LogSink *getLogSink() const
+    {
+        return executor ? executorInterface->logSink : logSink;
+    }
     bool checkSql();
     QSqlQuery *prepareQuery(const QString &queryText);
     bool execSqlQuery(QSqlQuery *query);
@@ -58,6 +82,11 @@ public:
     {
         return sqlDatabase;
     }
+    /// Replay list and deck storage reads, run on this connection.
+    Servatrice_StorageQueries &getStorageQueries()
+    {
+        return storageQueries;
+    }
 
     bool activeUserExists(const QString &user) override;
     bool userExists(const QString &user) override;
@@ -73,7 +102,9 @@ public:
                               const ServerInfo_Game &gameInfo,
                               const QSet<QString> &allPlayersEver,
                               const QSet<QString> &allSpectatorsEver,
-                              const QList<GameReplay *> &replayList) override;
+                              const QList<Server_ReplayWriter *> &replayList) override;
+    /// Encodes the replays stored before ReplayCodec, returns false on a database error.
+    bool compressStoredReplays();
     DeckList *getDeckFromDatabase(int deckId, int userId) override;
 
     int getNextGameId() override;
@@ -106,6 +137,14 @@ public:
     bool activateUser(const QString &userName, const QString &token) override;
     void updateUsersClientID(const QString &userName, const QString &userClientID) override;
     void updateUsersLastLoginData(const QString &userName, const QString &clientVersion) override;
+    /// Stores the ban right away, on the connection of the calling pool.
+    bool addUsersBan(const QString &userName,
+                     const QString &ipAddress,
+                     int adminId,
+                     int minutes,
+                     const QString &reason,
+                     const QString &visibleReason,
+                     const QString &clientId);
     void logMessage(const int senderId,
                     const QString &senderName,
                     const QString &senderIp,
@@ -0,0 +1,107 @@
+#include "servatrice_log_sink.h"
+
+#include <QTimer>
+
+Servatrice_LogSink::Servatrice_LogSink(Writer _writer,
+                                       int flushInterval,
+                                       int _batchRows,
+                                       qint64 _maxBufferedBytes,
+                                       OverflowPolicy _overflowPolicy,
+                                       QObject *parent)
+    : QObject(parent), writer(std::move(_writer)), batchRows(qMax(_batchRows, 1)),
+      maxBufferedBytes(_maxBufferedBytes), overflowPolicy(_overflowPolicy), bufferedBytes(0), flushScheduled(false)
+{
+    flushTimer = new QTimer(this);
+    flushTimer->setSingleShot(true);
+    flushTimer->setInterval(flushInterval);
+    connect(flushTimer, &QTimer::timeout, this, &Servatrice_LogSink::flush);
+}
+
+Servatrice_LogSink::~Servatrice_LogSink()
+{
+    flush();
+}
+
+qint64 Servatrice_LogSink::entrySize(const Entry &entry)
+{
+    const qint64 characters = entry.senderName.size() + entry.senderIp.size() + entry.message.size() +
+                              entry.targetType.size() + entry.targetName.size();
+    return static_cast<qint64>(sizeof(Entry)) + characters * static_cast<qint64>(sizeof(QChar));
+}
+
+bool Servatrice_LogSink::append(const Entry &entry)
+{
+    const qint64 size = entrySize(entry);
+    bool wasEmpty, flushNow = false;
+    {
+        QMutexLocker locker(&mutex);
+        if (bufferedBytes + size > maxBufferedBytes) {
+            if (overflowPolicy == DropNewest || size > maxBufferedBytes) {
+                ++stats.droppedRows;
+                return false;
+            }
+            while (bufferedBytes + size > maxBufferedBytes) {
+                bufferedBytes -= entrySize(buffer.takeFirst());
+                ++stats.droppedRows;
+            }
+        }
+        wasEmpty = buffer.isEmpty();
+        buffer.append(entry);
+        bufferedBytes += size;
+        stats.peakBufferedBytes = qMax(stats.peakBufferedBytes, bufferedBytes);
+        if (buffer.size() >= batchRows && !flushScheduled) {
+            flushScheduled = true;
+            flushNow = true;
+        }
+    }
+
+    // the timer belongs to the thread of the sink
+    if (flushNow)
+        QMetaObject::invokeMethod(this, &Servatrice_LogSink::flush, Qt::QueuedConnection);
+    else if (wasEmpty)
+        QMetaObject::invokeMethod(this, &Servatrice_LogSink::startFlushTimer, Qt::QueuedConnection);
+    return true;
+}
+
+void Servatrice_LogSink::startFlushTimer()
+{
+    if (!flushTimer->isActive())
+        flushTimer->start();
+}
+
+void Servatrice_LogSink::flush()
+{
+    flushTimer->stop();
+    forever {
+        QList<Entry> batch;
+        {
+            QMutexLocker locker(&mutex);
+            flushScheduled = false;
+            if (buffer.isEmpty())
+                return;
+            batch = buffer.mid(0, batchRows);
+            buffer.erase(buffer.begin(), buffer.begin() + batch.size());
+            for (const Entry &entry : batch)
+                bufferedBytes -= entrySize(entry);
+        }
+
+        const bool written = writer(batch);
+
+        QMutexLocker locker(&mutex);
+        if (written) {
+            stats.writtenRows += batch.size();
+            ++stats.batches;
+        } else {
+            stats.failedRows += batch.size();
+        }
+    }
+}
+
+Servatrice_LogSink::Stats Servatrice_LogSink::takeStats()
+{
+    QMutexLocker locker(&mutex);
+    Stats result = stats;
+    stats = Stats();
+    stats.peakBufferedBytes = bufferedBytes;
+    return result;
+}
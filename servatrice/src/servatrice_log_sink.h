@@ -0,0 +1,94 @@
+#ifndef SERVATRICE_LOG_SINK_H
+#define SERVATRICE_LOG_SINK_H
+
+#include <QDateTime>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVariant>
+#include <functional>
+
+class QTimer;
+
+/**
+ * Buffers the rows of the message log and writes them in batches.
+ *
+ * append() may be called from any thread and never waits for the database. The rows are handed to the writer in the
+ * thread of the sink, at most batchRows at a time, once that many are buffered or flushInterval milliseconds after
+ * the first of them arrived; the writer stores each batch in a single transaction. The buffer is bounded in bytes, and
+ * the overflow policy decides whether a full buffer drops the new row or the oldest ones. Whatever is still buffered
+ * is written when the sink is destroyed.
+ */
+class Servatrice_LogSink : public QObject
+{
+    Q_OBJECT
+public:
+    struct Entry
+    {
+        QDateTime time; // in UTC
+        QVariant senderId;
+        QString senderName;
+        QString senderIp;
+        QString message;
+        QString targetType;
+        QVariant targetId;
+        QString targetName;
+    };
+
+    enum OverflowPolicy
+    {
+        DropNewest,
+        DropOldest
+    };
+
+    struct Stats
+    {
+        quint64 writtenRows = 0;
+        quint64 batches = 0;
+        quint64 droppedRows = 0; // by the overflow policy
+        quint64 failedRows = 0;  // in batches the writer could not store
+        qint64 peakBufferedBytes = 0;
+    };
+
+    /// Stores a batch of rows, returns false if they are lost.
+    using Writer = std::function<bool(const QList<Entry> &)>;
+
+private:
+    Writer writer;
+    int batchRows;
+    qint64 maxBufferedBytes;
+    OverflowPolicy overflowPolicy;
+    QTimer *flushTimer;
+
+    mutable QMutex mutex;
+    QList<Entry> buffer;
+    qint64 bufferedBytes;
+    bool flushScheduled;
+    Stats stats;
+
+    static qint64 entrySize(const Entry &entry);
+
+private slots:
+    void startFlushTimer();
+
+public:
+    Servatrice_LogSink(Writer _writer,
+                       int flushInterval,
+                       int _batchRows,
+                       qint64 _maxBufferedBytes,
+                       OverflowPolicy _overflowPolicy,
+                       QObject *parent = nullptr);
+    ~Servatrice_LogSink() override;
+
+    /// Returns false if the row was dropped because the buffer is full.
+    bool append(const Entry &entry);
+    /// Returns the counters since the last call and resets them.
+    Stats takeStats();
+
+public slots:
+    /// Writes all buffered rows; runs in the thread of the sink.
+    void flush();
+};
+
+#endif
@@ -0,0 +1,220 @@
+#include "servatrice_storage_queries.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+#include <algorithm>
+#include <libcockatrice/protocol/pb/response_replay_list.pb.h>
+#include <libcockatrice/protocol/pb/serverinfo_deckstorage.pb.h>
+#include <libcockatrice/protocol/pb/serverinfo_replay.pb.h>
+#include <libcockatrice/protocol/pb/serverinfo_replay_match.pb.h>
+#include <libcockatrice/protocol/replay_codec.h>
+
+namespace
+{
+// the games whose replays the user can see; binds :id_player and :hide_before
+const QString visibleGamesCondition = "a.id_player = :id_player and (a.do_not_hide = 1 or b.time_started > "
+                                      ":hide_before)";
+
+struct DeckFolder
+{
+    int id;
+    QString name;
+};
+
+struct DeckFile
+{
+    int id;
+    QString name;
+    QDateTime uploadTime;
+};
+
+void addDeckFolder(ServerInfo_DeckStorage_Folder &folder,
+                   int folderId,
+                   const QMap<int, QList<DeckFolder>> &foldersByParent,
+                   const QHash<int, QList<DeckFile>> &filesByFolder,
+                   QSet<int> &visited)
+{
+    // a folder that is its own ancestor would recurse forever
+    if (visited.contains(folderId))
+        return;
+    visited.insert(folderId);
+
+    for (const DeckFolder &child : foldersByParent.value(folderId)) {
+        ServerInfo_DeckStorage_TreeItem *newItem = folder.add_items();
+        newItem->set_id(child.id);
+        newItem->set_name(child.name.toStdString());
+        addDeckFolder(*newItem->mutable_folder(), child.id, foldersByParent, filesByFolder, visited);
+    }
+    for (const DeckFile &file : filesByFolder.value(folderId)) {
+        ServerInfo_DeckStorage_TreeItem *newItem = folder.add_items();
+        newItem->set_id(file.id);
+        newItem->set_name(file.name.toStdString());
+        newItem->mutable_file()->set_creation_time(file.uploadTime.toSecsSinceEpoch());
+    }
+}
+} // namespace
+
+Servatrice_StorageQueries::Servatrice_StorageQueries(PrepareQuery _prepareQuery, ExecQuery _execQuery)
+    : prepareQuery(std::move(_prepareQuery)), execQuery(std::move(_execQuery))
+{
+}
+
+bool Servatrice_StorageQueries::getReplayList(int userId, Response_ReplayList &result)
+{
+    // time_started is written with the database's clock, so the cutoff is taken from it as well
+    QDateTime hideBefore;
+    {
+        QSqlQuery *query = prepareQuery("select current_timestamp");
+        if (!execQuery(query) || !query->next())
+            return false;
+        hideBefore = query->value(0).toDateTime().addDays(-replayListDays);
+    }
+
+    // the replay name comes from the access row, so it's kept next to each match
+    QHash<int, QList<QPair<ServerInfo_ReplayMatch *, std::string>>> matchesByGame;
+    {
+        QSqlQuery *query = prepareQuery(
+            "select a.id_game, a.replay_name, b.room_name, b.time_started, b.time_finished, b.descr, a.do_not_hide "
+            "from {prefix}_replays_access a left join {prefix}_games b on b.id = a.id_game where " +
+            visibleGamesCondition);
+        query->bindValue(":id_player", userId);
+        query->bindValue(":hide_before", hideBefore);
+        if (!execQuery(query))
+            return false;
+        while (query->next()) {
+            ServerInfo_ReplayMatch *matchInfo = result.add_match_list();
+
+            const int gameId = query->value(0).toInt();
+            matchInfo->set_game_id(gameId);
+            matchInfo->set_room_name(query->value(2).toString().toStdString());
+            const int timeStarted = query->value(3).toDateTime().toSecsSinceEpoch();
+            const int timeFinished = query->value(4).toDateTime().toSecsSinceEpoch();
+            matchInfo->set_time_started(timeStarted);
+            matchInfo->set_length(timeFinished - timeStarted);
+            matchInfo->set_game_name(query->value(5).toString().toStdString());
+            matchInfo->set_do_not_hide(query->value(6).toBool());
+            matchesByGame[gameId].append({matchInfo, query->value(1).toString().toStdString()});
+        }
+    }
+    if (matchesByGame.isEmpty())
+        return true;
+
+    const QString visibleGames = "select a.id_game from {prefix}_replays_access a left join {prefix}_games b on "
+                                 "b.id = a.id_game where " +
+                                 visibleGamesCondition;
+    {
+        QSqlQuery *query = prepareQuery("select id_game, player_name from {prefix}_games_players where id_game in (" +
+                                        visibleGames + ")");
+        query->bindValue(":id_player", userId);
+        query->bindValue(":hide_before", hideBefore);
+        if (!execQuery(query))
+            return false;
+        while (query->next()) {
+            const std::string playerName = query->value(1).toString().toStdString();
+            for (const auto &match : matchesByGame.value(query->value(0).toInt()))
+                match.first->add_player_names(playerName);
+        }
+    }
+    {
+        QSqlQuery *query = prepareQuery("select id_game, id, duration from {prefix}_replays where id_game in (" +
+                                        visibleGames + ") order by id");
+        query->bindValue(":id_player", userId);
+        query->bindValue(":hide_before", hideBefore);
+        if (!execQuery(query))
+            return false;
+        while (query->next()) {
+            for (const auto &match : matchesByGame.value(query->value(0).toInt())) {
+                ServerInfo_Replay *replayInfo = match.first->add_replay_list();
+                replayInfo->set_replay_id(query->value(1).toInt());
+                replayInfo->set_replay_name(match.second);
+                replayInfo->set_duration(query->value(2).toInt());
+            }
+        }
+    }
+    return true;
+}
+
+bool Servatrice_StorageQueries::getDeckTree(int userId, ServerInfo_DeckStorage_Folder &root)
+{
+    QMap<int, QList<DeckFolder>> foldersByParent;
+    {
+        QSqlQuery *query = prepareQuery(
+            "select id, id_parent, name from {prefix}_decklist_folders where id_user = :id_user order by id");
+        query->bindValue(":id_user", userId);
+        if (!execQuery(query))
+            return false;
+        while (query->next())
+            foldersByParent[query->value(1).toInt()].append({query->value(0).toInt(), query->value(2).toString()});
+    }
+
+    QHash<int, QList<DeckFile>> filesByFolder;
+    {
+        QSqlQuery *query = prepareQuery("select id, id_folder, name, upload_time from {prefix}_decklist_files where "
+                                        "id_user = :id_user order by id");
+        query->bindValue(":id_user", userId);
+        if (!execQuery(query))
+            return false;
+        while (query->next())
+            filesByFolder[query->value(1).toInt()].append(
+                {query->value(0).toInt(), query->value(2).toString(), query->value(3).toDateTime()});
+    }
+
+    QSet<int> visited;
+    addDeckFolder(root, 0, foldersByParent, filesByFolder, visited);
+    return true;
+}
+
+int Servatrice_StorageQueries::getDeckFolderId(int userId, const QString &path)
+{
+    const QStringList pathItems = path.split("/");
+    if (pathItems.first().isEmpty())
+        return 0;
+
+    QSqlQuery *query =
+        prepareQuery("select id, id_parent, name from {prefix}_decklist_folders where id_user = :id_user order by id");
+    query->bindValue(":id_user", userId);
+    if (!execQuery(query))
+        return -1;
+    QMap<int, QList<DeckFolder>> foldersByParent;
+    while (query->next())
+        foldersByParent[query->value(1).toInt()].append({query->value(0).toInt(), query->value(2).toString()});
+
+    int folderId = 0;
+    for (const QString &name : pathItems) {
+        if (name.isEmpty())
+            return 0;
+        // folder names are compared like the case insensitive collation of the database does
+        const QList<DeckFolder> children = foldersByParent.value(folderId);
+        const auto child = std::find_if(children.begin(), children.end(), [&name](const DeckFolder &folder) {
+            return folder.name.compare(name, Qt::CaseInsensitive) == 0;
+        });
+        if (child == children.end())
+            return -1;
+        folderId = child->id;
+    }
+    return folderId;
+}
+
+QString Servatrice_StorageQueries::getReplayShareHash(int gameId)
+{
+    QSqlQuery *query = prepareQuery("select replay from {prefix}_replays where id_game = :id_game limit 3");
+    query->bindValue(":id_game", gameId);
+    if (!execQuery(query))
+        return "";
+
+    QByteArray replaysBytes;
+    while (query->next())
+        replaysBytes.append(ReplayCodec::decode(query->value(0).toByteArray()).left(128));
+
+    auto hash =
+        QCryptographicHash::hash(replaysBytes, QCryptographicHash::Md5).toBase64(QByteArray::OmitTrailingEquals);
+    hash.truncate(10);
+    return hash;
+}
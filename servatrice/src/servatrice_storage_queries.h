@@ -0,0 +1,45 @@
+#ifndef SERVATRICE_STORAGE_QUERIES_H
+#define SERVATRICE_STORAGE_QUERIES_H
+
+#include <QString>
+#include <functional>
+
+class QSqlQuery;
+class Response_ReplayList;
+class ServerInfo_DeckStorage_Folder;
+
+/**
+ * Reads the replays and the deck storage of a user with a fixed number of queries, however many games, replays and
+ * folders there are, and puts the protobuf messages together in memory.
+ *
+ * Queries are prepared and run through the given functions, so the same code runs on a Servatrice_DatabaseInterface
+ * connection on the server and on an SQLite database in the tests. The queries only use SQL both understand.
+ */
+class Servatrice_StorageQueries
+{
+public:
+    using PrepareQuery = std::function<QSqlQuery *(const QString &queryText)>;
+    using ExecQuery = std::function<bool(QSqlQuery *query)>;
+
+    /// Replays of games that started longer ago than this are not listed, unless they are marked to be kept.
+    static const int replayListDays = 7;
+
+private:
+    PrepareQuery prepareQuery;
+    ExecQuery execQuery;
+
+public:
+    Servatrice_StorageQueries(PrepareQuery _prepareQuery, ExecQuery _execQuery);
+
+    /// Three queries: the matches, their players and their replays.
+    bool getReplayList(int userId, Response_ReplayList &result);
+    /// Two queries: all folders and all files of the user.
+    bool getDeckTree(int userId, ServerInfo_DeckStorage_Folder &root);
+    /// One query. Returns 0 for the root folder and -1 if the folder doesn't exist or the query failed.
+    int getDeckFolderId(int userId, const QString &path);
+    /// One query. Returns the hash in the share code of the game's replays, or an empty string if the query failed.
+    /// It is taken from the decoded replays, so it doesn't change when they are stored compressed.
+    QString getReplayShareHash(int gameId);
+};
+
+#endif
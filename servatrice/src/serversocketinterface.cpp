@@ -78,6 +78,7 @@
 #include <libcockatrice/protocol/pb/serverinfo_deckstorage.pb.h>
 #include <libcockatrice/protocol/pb/serverinfo_replay.pb.h>
 #include <libcockatrice/protocol/pb/serverinfo_user.pb.h>
+#include <libcockatrice/protocol/replay_codec.h>
 #include <libcockatrice/utility/trice_limits.h>
 #include <server_response_containers.h>
 #include <server_room.h>
@@ -85,6 +86,10 @@
 
 static const int protocolVersion = 14;
 
+// Frames are copied into the per-connection send buffer until it holds this many bytes.
+// Larger frames (e.g. game state dumps) are handed to the socket as they are.
+static const int maxCoalescedWriteSize = 64 * 1024;
+
 AbstractServerSocketInterface::AbstractServerSocketInterface(Servatrice *_server,
                                                              Servatrice_DatabaseInterface *_databaseInterface,
                                                              QObject *parent)
@@ -106,13 +111,16 @@ bool AbstractServerSocketInterface::initSession()
     if (servatrice->getAuthenticationMethod() == Servatrice::AuthenticationSql) {
         identEvent.set_server_options(Event_ServerIdentification::SupportsPasswordHash);
     }
+    if (servatrice->getCompressionThreshold() > 0) {
+        identEvent.set_compression_threshold(static_cast<quint32>(
+            qMax(servatrice->getCompressionThreshold(), ServerMessageFrame::minCompressedPayloadSize)));
+    }
     SessionEvent *identSe = prepareSessionEvent(identEvent);
     sendProtocolItem(*identSe);
     delete identSe;
 
     // allow unlimited number of connections from the trusted sources
-    QString trustedSources = settingsCache->value("security/trusted_sources", "127.0.0.1,::1").toString();
-    if (trustedSources.contains(getAddress(), Qt::CaseInsensitive))
+    if (servatrice->isTrustedSource(getPeerAddress()))
         return true;
 
     int maxUsers = servatrice->getMaxUsersPerAddress();
@@ -141,12 +149,30 @@ void AbstractServerSocketInterface::catchSocketDisconnected()
 }
 
 void AbstractServerSocketInterface::transmitProtocolItem(const ServerMessage &item)
+{
+    transmitProtocolFrame(ServerMessageFrame(item));
+}
+
+void AbstractServerSocketInterface::transmitProtocolFrame(const ServerMessageFrame &frame)
 {
     outputQueueMutex.lock();
-    outputQueue.append(item);
+    const bool wasEmpty = outputQueue.isEmpty();
+    if (wasEmpty)
+        outputQueueTimer.start();
+    outputQueue.append(frame);
     outputQueueMutex.unlock();
 
-    emit outputQueueChanged();
+    // A flush is already pending if the queue was not empty; it will pick this item up as well.
+    if (wasEmpty)
+        emit outputQueueChanged();
+}
+
+const QByteArray *AbstractServerSocketInterface::getCompressedFrame(const ServerMessageFrame &frame) const
+{
+    if (compressionThreshold <= 0 || frame.getPayloadSize() < compressionThreshold)
+        return nullptr;
+    const QByteArray &compressed = frame.getCompressedFrame();
+    return &compressed == &frame.getFrame() ? nullptr : &compressed;
 }
 
 void AbstractServerSocketInterface::logDebugMessage(const QString &message)
@@ -342,73 +368,9 @@ Response::ResponseCode AbstractServerSocketInterface::cmdRemoveFromList(const Co
     return Response::RespOk;
 }
 
-int AbstractServerSocketInterface::getDeckPathId(int basePathId, QStringList path)
-{
-    if (path.isEmpty())
-        return 0;
-    if (path[0].isEmpty())
-        return 0;
-
-    QSqlQuery *query = sqlInterface->prepareQuery("select id from {prefix}_decklist_folders where id_parent = "
-                                                  ":id_parent and name = :name and id_user = :id_user");
-    query->bindValue(":id_parent", basePathId);
-    query->bindValue(":name", path.takeFirst());
-    query->bindValue(":id_user", userInfo->id());
-    if (!sqlInterface->execSqlQuery(query))
-        return -1;
-    if (!query->next())
-        return -1;
-    int id = query->value(0).toInt();
-    if (path.isEmpty())
-        return id;
-    else
-        return getDeckPathId(id, path);
-}
-
 int AbstractServerSocketInterface::getDeckPathId(const QString &path)
 {
-    return getDeckPathId(0, path.split("/"));
-}
-
-bool AbstractServerSocketInterface::deckListHelper(int folderId, ServerInfo_DeckStorage_Folder *folder)
-{
-    QSqlQuery *query = sqlInterface->prepareQuery(
-        "select id, name from {prefix}_decklist_folders where id_parent = :id_parent and id_user = :id_user");
-    query->bindValue(":id_parent", folderId);
-    query->bindValue(":id_user", userInfo->id());
-    if (!sqlInterface->execSqlQuery(query))
-        return false;
-
-    QMap<int, QString> results;
-    while (query->next())
-        results[query->value(0).toInt()] = query->value(1).toString();
-
-    for (int key : results.keys()) {
-        ServerInfo_DeckStorage_TreeItem *newItem = folder->add_items();
-        newItem->set_id(key);
-        newItem->set_name(results.value(key).toStdString());
-
-        if (!deckListHelper(newItem->id(), newItem->mutable_folder()))
-            return false;
-    }
-
-    query = sqlInterface->prepareQuery("select id, name, upload_time from {prefix}_decklist_files where id_folder = "
-                                       ":id_folder and id_user = :id_user");
-    query->bindValue(":id_folder", folderId);
-    query->bindValue(":id_user", userInfo->id());
-    if (!sqlInterface->execSqlQuery(query))
-        return false;
-
-    while (query->next()) {
-        ServerInfo_DeckStorage_TreeItem *newItem = folder->add_items();
-        newItem->set_id(query->value(0).toInt());
-        newItem->set_name(query->value(1).toString().toStdString());
-
-        ServerInfo_DeckStorage_File *newFile = newItem->mutable_file();
-        newFile->set_creation_time(query->value(2).toDateTime().toSecsSinceEpoch());
-    }
-
-    return true;
+    return sqlInterface->getStorageQueries().getDeckFolderId(userInfo->id(), path);
 }
 
 // CHECK AUTHENTICATION!
@@ -425,7 +387,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdDeckList(const Command_
     Response_DeckList *re = new Response_DeckList;
     ServerInfo_DeckStorage_Folder *root = re->mutable_root();
 
-    if (!deckListHelper(0, root))
+    if (!sqlInterface->getStorageQueries().getDeckTree(userInfo->id(), *root))
         return Response::RespContextError;
 
     rc.setResponseExtension(re);
@@ -622,49 +584,8 @@ Response::ResponseCode AbstractServerSocketInterface::cmdReplayList(const Comman
     if (authState != PasswordRight)
         return Response::RespFunctionNotAllowed;
 
-    Response_ReplayList *re = new Response_ReplayList;
-
-    QSqlQuery *query1 = sqlInterface->prepareQuery(
-        "select a.id_game, a.replay_name, b.room_name, b.time_started, b.time_finished, b.descr, a.do_not_hide from "
-        "{prefix}_replays_access a left join {prefix}_games b on b.id = a.id_game where a.id_player = :id_player and "
-        "(a.do_not_hide = 1 or date_add(b.time_started, interval 7 day) > now())");
-    query1->bindValue(":id_player", userInfo->id());
-    sqlInterface->execSqlQuery(query1);
-    while (query1->next()) {
-        ServerInfo_ReplayMatch *matchInfo = re->add_match_list();
-
-        const int gameId = query1->value(0).toInt();
-        matchInfo->set_game_id(gameId);
-        matchInfo->set_room_name(query1->value(2).toString().toStdString());
-        const int timeStarted = query1->value(3).toDateTime().toSecsSinceEpoch();
-        const int timeFinished = query1->value(4).toDateTime().toSecsSinceEpoch();
-        matchInfo->set_time_started(timeStarted);
-        matchInfo->set_length(timeFinished - timeStarted);
-        matchInfo->set_game_name(query1->value(5).toString().toStdString());
-        const QString replayName = query1->value(1).toString();
-        matchInfo->set_do_not_hide(query1->value(6).toBool());
-
-        {
-            QSqlQuery *query2 =
-                sqlInterface->prepareQuery("select player_name from {prefix}_games_players where id_game = :id_game");
-            query2->bindValue(":id_game", gameId);
-            sqlInterface->execSqlQuery(query2);
-            while (query2->next())
-                matchInfo->add_player_names(query2->value(0).toString().toStdString());
-        }
-        {
-            QSqlQuery *query3 =
-                sqlInterface->prepareQuery("select id, duration from {prefix}_replays where id_game = :id_game");
-            query3->bindValue(":id_game", gameId);
-            sqlInterface->execSqlQuery(query3);
-            while (query3->next()) {
-                ServerInfo_Replay *replayInfo = matchInfo->add_replay_list();
-                replayInfo->set_replay_id(query3->value(0).toInt());
-                replayInfo->set_replay_name(replayName.toStdString());
-                replayInfo->set_duration(query3->value(1).toInt());
-            }
-        }
-    }
+    auto *re = new Response_ReplayList;
+    sqlInterface->getStorageQueries().getReplayList(userInfo->id(), *re);
 
     rc.setResponseExtension(re);
     return Response::RespOk;
@@ -688,6 +609,31 @@ Response::ResponseCode AbstractServerSocketInterface::cmdReplayDownload(const Co
             return Response::RespAccessDenied;
     }
 
+    if (cmd.has_length()) {
+        // the client puts the stored replay together and decodes it, only the requested part is read from the row
+        QSqlQuery *query = sqlInterface->prepareQuery(
+            "select substring(replay, :start, :length), length(replay) from {prefix}_replays where id = :id_replay");
+        query->bindValue(":start", static_cast<qulonglong>(cmd.offset()) + 1);
+        query->bindValue(":length", qMin(cmd.length(), static_cast<quint32>(ReplayCodec::downloadChunkSize)));
+        query->bindValue(":id_replay", cmd.replay_id());
+        if (!sqlInterface->execSqlQuery(query))
+            return Response::RespInternalError;
+        if (!query->next())
+            return Response::RespNameNotFound;
+
+        const quint32 totalSize = query->value(1).toUInt();
+        if (cmd.offset() > totalSize)
+            return Response::RespContextError;
+        const QByteArray data = query->value(0).toByteArray();
+
+        auto *re = new Response_ReplayDownload;
+        re->set_replay_data(data.data(), data.size());
+        re->set_offset(cmd.offset());
+        re->set_total_size(totalSize);
+        rc.setResponseExtension(re);
+        return Response::RespOk;
+    }
+
     QSqlQuery *query = sqlInterface->prepareQuery("select replay from {prefix}_replays where id = :id_replay");
     query->bindValue(":id_replay", cmd.replay_id());
     if (!sqlInterface->execSqlQuery(query))
@@ -695,7 +641,11 @@ Response::ResponseCode AbstractServerSocketInterface::cmdReplayDownload(const Co
     if (!query->next())
         return Response::RespNameNotFound;
 
-    QByteArray data = query->value(0).toByteArray();
+    // clients that don't ask for parts expect the plain GameReplay
+    const QByteArray stored = query->value(0).toByteArray();
+    QByteArray data = ReplayCodec::decode(stored);
+    if (data.isEmpty() && !stored.isEmpty())
+        return Response::RespInternalError;
 
     Response_ReplayDownload *re = new Response_ReplayDownload;
     re->set_replay_data(data.data(), data.size());
@@ -747,7 +697,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdReplayDeleteMatch(const
  * Generates a hash for the given replay folder, used for auth when replay sharing.
  * This is a separate function in case we change the hash implementation in the future.
  *
- * Currently, we append together the first 128 bytes of the first 3 replays in the game.
+ * Currently, we append together the first 128 bytes of the first 3 decoded replays in the game.
  * Then we md5 hash it, base64 encode it, and truncate the result to 10 characters.
  *
  * @param gameId The replay match to hash
@@ -755,24 +705,7 @@ Response::ResponseCode AbstractServerSocketInterface::cmdReplayDeleteMatch(const
  */
 QString AbstractServerSocketInterface::createHashForReplay(int gameId)
 {
-    QSqlQuery *query =
-        sqlInterface->prepareQuery("select replay from {prefix}_replays where id_game = :id_game limit 3");
-    query->bindValue(":id_game", gameId);
-
-    if (!sqlInterface->execSqlQuery(query))
-        return "";
-
-    QByteArray replaysBytes;
-    while (query->next()) {
-        QByteArray replay = query->value(0).toByteArray();
-        replay.truncate(128);
-        replaysBytes.append(replay);
-    }
-
-    auto hash =
-        QCryptographicHash::hash(replaysBytes, QCryptographicHash::Md5).toBase64(QByteArray::OmitTrailingEquals);
-    hash.truncate(10);
-    return hash;
+    return sqlInterface->getStorageQueries().getReplayShareHash(gameId);
 }
 
 Response::ResponseCode AbstractServerSocketInterface::cmdReplayGetCode(const Command_ReplayGetCode &cmd,
@@ -1066,22 +999,13 @@ Response::ResponseCode AbstractServerSocketInterface::cmdBanFromServer(const Com
     if (amountRemove != 0) {
         removeSaidMessages(userName, amountRemove);
     }
-    QString trustedSources = settingsCache->value("server/trusted_sources", "127.0.0.1,::1").toString();
     int minutes = cmd.minutes();
-    if (trustedSources.contains(address, Qt::CaseInsensitive))
+    if (!address.isEmpty() && servatrice->isTrustedSource(QHostAddress(address)))
         address = "";
 
-    QSqlQuery *query = sqlInterface->prepareQuery(
-        "insert into {prefix}_bans (user_name, ip_address, id_admin, time_from, minutes, reason, visible_reason, "
-        "clientid) values(:user_name, :ip_address, :id_admin, NOW(), :minutes, :reason, :visible_reason, :client_id)");
-    query->bindValue(":user_name", userName);
-    query->bindValue(":ip_address", address);
-    query->bindValue(":id_admin", userInfo->id());
-    query->bindValue(":minutes", minutes);
-    query->bindValue(":reason", textFromStdString(cmd.reason()));
-    query->bindValue(":visible_reason", visibleReason);
-    query->bindValue(":client_id", nameFromStdString(cmd.clientid()));
-    sqlInterface->execSqlQuery(query);
+    if (!sqlInterface->addUsersBan(userName, address, userInfo->id(), minutes, textFromStdString(cmd.reason()),
+                                   visibleReason, nameFromStdString(cmd.clientid())))
+        return Response::RespInternalError;
 
     servatrice->clientsLock.lockForRead();
     QList<QString> moderatorList = server->getOnlineModeratorList();
@@ -1432,6 +1356,8 @@ Response::ResponseCode AbstractServerSocketInterface::cmdAccountEdit(const Comma
     if (cmd.has_country()) {
         userInfo->set_country(country.toStdString());
     }
+    if (cmd.has_real_name() || cmd.has_country())
+        servatrice->updateUserInfo(this);
 
     return Response::RespOk;
 }
@@ -1914,9 +1840,11 @@ Response::ResponseCode AbstractServerSocketInterface::cmdUpdateAdminNotes(const
 TcpServerSocketInterface::TcpServerSocketInterface(Servatrice *_server,
                                                    Servatrice_DatabaseInterface *_databaseInterface,
                                                    QObject *parent)
-    : AbstractServerSocketInterface(_server, _databaseInterface, parent), messageInProgress(false),
-      handshakeStarted(false)
+    : AbstractServerSocketInterface(_server, _databaseInterface, parent), handshakeStarted(false)
 {
+    // reserve() keeps the allocation alive across resize(0), so the buffer is reused between flushes
+    sendBuffer.reserve(maxCoalescedWriteSize);
+
     socket = new QTcpSocket(this);
     socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
     connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
@@ -1934,12 +1862,15 @@ TcpServerSocketInterface::~TcpServerSocketInterface()
 
 void TcpServerSocketInterface::initConnection(int socketDescriptor)
 {
+    socket->setSocketDescriptor(socketDescriptor);
+    // The peer address is kept so that it stays valid after the socket disconnects; the server indexes clients by it.
+    address = socket->peerAddress();
+
     // Add this object to the server's list of connections before it can receive socket events.
     // Otherwise, in case a of a socket error, it could be removed from the list before it is added.
     server->addClient(this);
 
-    socket->setSocketDescriptor(socketDescriptor);
-    logger->logMessage(QString("Incoming connection: %1").arg(socket->peerAddress().toString()), this);
+    logger->logMessage(QString("Incoming connection: %1").arg(address.toString()), this);
     initSessionDeprecated();
 }
 
@@ -1959,31 +1890,48 @@ void TcpServerSocketInterface::flushOutputQueue()
     if (outputQueue.isEmpty())
         return;
 
-    int totalBytes = 0;
-    while (!outputQueue.isEmpty()) {
-        ServerMessage item = outputQueue.takeFirst();
-        locker.unlock();
+    // Drain the whole queue at once. In case socket->write() calls catchSocketError(), the mutex must not be locked
+    // while writing.
+    QList<ServerMessageFrame> frames;
+    frames.swap(outputQueue);
+    const qint64 flushLatency = outputQueueTimer.nsecsElapsed() / 1000;
+    locker.unlock();
 
-        QByteArray buf;
-#if GOOGLE_PROTOBUF_VERSION > 3001000
-        unsigned int size = static_cast<unsigned int>(item.ByteSizeLong());
-#else
-        unsigned int size = static_cast<unsigned int>(item.ByteSize());
-#endif
-        buf.resize(size + 4);
-        item.SerializeToArray(buf.data() + 4, size);
-        buf.data()[3] = (unsigned char)size;
-        buf.data()[2] = (unsigned char)(size >> 8);
-        buf.data()[1] = (unsigned char)(size >> 16);
-        buf.data()[0] = (unsigned char)(size >> 24);
-        // In case socket->write() calls catchSocketError(), the mutex must not be locked during this call.
-        writeToSocket(buf);
-
-        totalBytes += size + 4;
-        locker.relock();
+    quint64 totalBytes = 0;
+    quint64 writes = 0;
+    quint64 compressedFrames = 0, uncompressedBytes = 0, compressedBytes = 0;
+    sendBuffer.resize(0);
+    for (const ServerMessageFrame &frame : frames) {
+        const QByteArray *compressed = getCompressedFrame(frame);
+        const QByteArray &data = compressed ? *compressed : frame.getFrame();
+        if (compressed) {
+            ++compressedFrames;
+            uncompressedBytes += frame.getFrameSize();
+            compressedBytes += data.size();
+        }
+
+        if (!sendBuffer.isEmpty() && sendBuffer.size() + data.size() > maxCoalescedWriteSize) {
+            writeToSocket(sendBuffer);
+            ++writes;
+            sendBuffer.resize(0);
+        }
+        if (data.size() >= maxCoalescedWriteSize) {
+            writeToSocket(data);
+            ++writes;
+        } else {
+            sendBuffer.append(data);
+        }
+        totalBytes += data.size();
     }
-    locker.unlock();
-    emit incTxBytes(totalBytes);
+    if (!sendBuffer.isEmpty()) {
+        writeToSocket(sendBuffer);
+        ++writes;
+        sendBuffer.resize(0);
+    }
+
+    servatrice->incTxBytes(totalBytes, writes, flushLatency);
+    if (compressedFrames > 0)
+        servatrice->incCompressedTxBytes(compressedFrames, uncompressedBytes, compressedBytes);
     // see above wrt mutex
     flushSocket();
 }
@@ -1994,24 +1942,12 @@ void TcpServerSocketInterface::readClient()
     servatrice->incRxBytes(data.size());
     inputBuffer.append(data);
 
-    do {
-        if (!messageInProgress) {
-            if (inputBuffer.size() >= 4) {
-                messageLength = (((quint32)(unsigned char)inputBuffer[0]) << 24) +
-                                (((quint32)(unsigned char)inputBuffer[1]) << 16) +
-                                (((quint32)(unsigned char)inputBuffer[2]) << 8) +
-                                ((quint32)(unsigned char)inputBuffer[3]);
-                inputBuffer.remove(0, 4);
-                messageInProgress = true;
-            } else
-                return;
-        }
-        if (inputBuffer.size() < messageLength || messageLength < 0)
-            return;
-
+    const char *message;
+    int messageLength;
+    while (inputBuffer.readFrame(message, messageLength)) {
         CommandContainer newCommandContainer;
         try {
-            newCommandContainer.ParseFromArray(inputBuffer.data(), messageLength);
+            newCommandContainer.ParseFromArray(message, messageLength);
         } catch (std::exception &e) {
             qDebug() << "Caught std::exception in" << __FILE__ << __LINE__ <<
 #ifdef _MSC_VER // Visual Studio
@@ -2022,7 +1958,7 @@ void TcpServerSocketInterface::readClient()
             qDebug() << "Exception:" << e.what();
             qDebug() << "Message coming from:" << getAddress();
             qDebug() << "Message length:" << messageLength;
-            qDebug() << "Message content:" << inputBuffer.toHex();
+            qDebug() << "Message content:" << QByteArray::fromRawData(message, messageLength).toHex();
         } catch (...) {
             qDebug() << "Unhandled exception in" << __FILE__ << __LINE__ <<
 #ifdef _MSC_VER // Visual Studio
@@ -2033,9 +1969,6 @@ void TcpServerSocketInterface::readClient()
             qDebug() << "Message coming from:" << getAddress();
         }
 
-        inputBuffer.remove(0, messageLength);
-        messageInProgress = false;
-
         // dirty hack to make v13 client display the correct error message
         if (handshakeStarted)
             processCommandContainer(newCommandContainer);
@@ -2045,7 +1978,7 @@ void TcpServerSocketInterface::readClient()
                 prepareDestroy();
         }
         // end of hack
-    } while (!inputBuffer.isEmpty());
+    }
 }
 
 bool TcpServerSocketInterface::initTcpSession()
@@ -2160,27 +2093,34 @@ void WebsocketServerSocketInterface::flushOutputQueue()
     if (outputQueue.isEmpty())
         return;
 
-    qint64 totalBytes = 0;
-    while (!outputQueue.isEmpty()) {
-        ServerMessage item = outputQueue.takeFirst();
-        locker.unlock();
-
-        QByteArray buf;
-#if GOOGLE_PROTOBUF_VERSION > 3001000
-        unsigned int size = static_cast<unsigned int>(item.ByteSizeLong());
-#else
-        unsigned int size = static_cast<unsigned int>(item.ByteSize());
-#endif
-        buf.resize(size);
-        item.SerializeToArray(buf.data(), size);
-        // In case socket->write() calls catchSocketError(), the mutex must not be locked during this call.
-        writeToSocket(buf);
+    // Drain the whole queue at once. In case socket->write() calls catchSocketError(), the mutex must not be locked
+    // while writing.
+    QList<ServerMessageFrame> frames;
+    frames.swap(outputQueue);
+    const qint64 flushLatency = outputQueueTimer.nsecsElapsed() / 1000;
+    locker.unlock();
 
-        totalBytes += size;
-        locker.relock();
+    // Every ServerMessage is its own WebSocket message, so frames can't be merged; only the payload is sent since
+    // WebSocket messages carry their own length. Compressed frames keep their length prefix: its first byte has the
+    // compressed flag set, which no serialized ServerMessage starts with.
+    quint64 totalBytes = 0;
+    quint64 compressedFrames = 0, uncompressedBytes = 0, compressedBytes = 0;
+    for (const ServerMessageFrame &frame : frames) {
+        if (const QByteArray *compressed = getCompressedFrame(frame)) {
+            writeToSocket(*compressed);
+            totalBytes += compressed->size();
+            ++compressedFrames;
+            uncompressedBytes += frame.getPayloadSize();
+            compressedBytes += compressed->size();
+        } else {
+            writeToSocket(frame.getPayload());
+            totalBytes += frame.getPayloadSize();
+        }
     }
-    locker.unlock();
-    emit incTxBytes(totalBytes);
+
+    servatrice->incTxBytes(totalBytes, frames.size(), flushLatency);
+    if (compressedFrames > 0)
+        servatrice->incCompressedTxBytes(compressedFrames, uncompressedBytes, compressedBytes);
     // see above wrt mutex
     flushSocket();
 }
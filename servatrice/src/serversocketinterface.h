@@ -20,16 +20,18 @@
 #ifndef SERVERSOCKETINTERFACE_H
 #define SERVERSOCKETINTERFACE_H
 
+#include <QElapsedTimer>
 #include <QHostAddress>
 #include <QMutex>
 #include <QTcpSocket>
 #include <QWebSocket>
+#include <libcockatrice/protocol/frame_reader.h>
+#include <server_message_frame.h>
 #include <server_protocolhandler.h>
 
 class Servatrice;
 class Servatrice_DatabaseInterface;
 class DeckList;
-class ServerInfo_DeckStorage_Folder;
 
 class Command_AddToList;
 class Command_RemoveFromList;
@@ -64,27 +66,27 @@ protected slots:
     virtual void flushOutputQueue() = 0;
 signals:
     void outputQueueChanged();
-    void incTxBytes(qint64 amount);
 
 protected:
     void logDebugMessage(const QString &message);
     bool tooManyRegistrationAttempts(const QString &ipAddress);
 
-    virtual void writeToSocket(QByteArray &data) = 0;
+    virtual void writeToSocket(const QByteArray &data) = 0;
     virtual void flushSocket() = 0;
+    /// The compressed form of @p frame if this session negotiated compression and it pays off, or nullptr.
+    const QByteArray *getCompressedFrame(const ServerMessageFrame &frame) const;
 
     Servatrice *servatrice;
-    QList<ServerMessage> outputQueue;
+    QList<ServerMessageFrame> outputQueue;
     QMutex outputQueueMutex;
+    QElapsedTimer outputQueueTimer; // started when the first item is queued into an empty queue
 
 private:
     Servatrice_DatabaseInterface *sqlInterface;
 
     Response::ResponseCode cmdAddToList(const Command_AddToList &cmd, ResponseContainer &rc);
     Response::ResponseCode cmdRemoveFromList(const Command_RemoveFromList &cmd, ResponseContainer &rc);
-    int getDeckPathId(int basePathId, QStringList path);
     int getDeckPathId(const QString &path);
-    bool deckListHelper(int folderId, ServerInfo_DeckStorage_Folder *folder);
     Response::ResponseCode cmdDeckList(const Command_DeckList &cmd, ResponseContainer &rc);
     Response::ResponseCode cmdDeckNewDir(const Command_DeckNewDir &cmd, ResponseContainer &rc);
     void deckDelDirHelper(int basePathId);
@@ -155,6 +157,7 @@ public:
     virtual QString getAddress() const = 0;
 
     void transmitProtocolItem(const ServerMessage &item);
+    void transmitProtocolFrame(const ServerMessageFrame &frame);
 };
 
 class TcpServerSocketInterface : public AbstractServerSocketInterface
@@ -168,11 +171,11 @@ public:
 
     QHostAddress getPeerAddress() const
     {
-        return socket->peerAddress();
+        return address;
     }
     QString getAddress() const
     {
-        return socket->peerAddress().toString();
+        return address.toString();
     }
     QString getConnectionType() const
     {
@@ -181,13 +184,13 @@ public:
 
 private:
     QTcpSocket *socket;
-    QByteArray inputBuffer;
-    bool messageInProgress;
+    QHostAddress address;
+    QByteArray sendBuffer;
+    FrameReader inputBuffer;
     bool handshakeStarted;
-    int messageLength;
 
 protected:
-    void writeToSocket(QByteArray &data)
+    void writeToSocket(const QByteArray &data)
     {
         socket->write(data);
     }
@@ -231,7 +234,7 @@ private:
     QHostAddress address;
 
 protected:
-    void writeToSocket(QByteArray &data)
+    void writeToSocket(const QByteArray &data)
     {
         socket->sendBinaryMessage(data);
     }
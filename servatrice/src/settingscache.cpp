@@ -16,6 +16,16 @@ SettingsCache::SettingsCache(const QString &fileName, QSettings::Format format,
     for (const QString &regExpStr : disallowedRegExpStr) {
         disallowedRegExp.append(QRegularExpression(QString("\\A%1\\z").arg(regExpStr)));
     }
+
+    loadMessageLogSettings();
+}
+
+void SettingsCache::loadMessageLogSettings()
+{
+    logUserMessagesRoom = value("logging/log_user_msg_room", false).toBool();
+    logUserMessagesGame = value("logging/log_user_msg_game", false).toBool();
+    logUserMessagesChat = value("logging/log_user_msg_chat", false).toBool();
+    logUserMessagesIsl = value("logging/log_user_msg_isl", false).toBool();
 }
 
 QString SettingsCache::guessConfigurationPath()
@@ -5,6 +5,7 @@
 #include <QRegularExpression>
 #include <QSettings>
 #include <QString>
+#include <atomic>
 
 class SettingsCache : public QSettings
 {
@@ -18,6 +19,9 @@ public:
                   QObject *parent = 0);
     static QString guessConfigurationPath();
     QList<QRegularExpression> disallowedRegExp;
+    // the logging/log_user_msg_* switches, checked for every chat line; reloaded on SIGHUP
+    std::atomic<bool> logUserMessagesRoom, logUserMessagesGame, logUserMessagesChat, logUserMessagesIsl;
+    void loadMessageLogSettings();
     bool getIsPortableBuild() const
     {
         return isPortableBuild;
@@ -69,6 +69,7 @@ void SignalHandler::internalSigHupHandler()
     logger->rotateLogs();
 
     settingsCache->sync();
+    settingsCache->loadMessageLogSettings();
 
     snHup->setEnabled(true);
 }
@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <game/server_card.h>
+#include <game/server_cardzone.h>
+
+static constexpr int cardCount = 500;
+static constexpr int rounds = 200;
+
+// does what Server_AbstractPlayer::moveCard() does to the zones: look up every card first, then move them in order
+static void moveAllCards(Server_CardZone &startZone, Server_CardZone &targetZone, bool fromTheBack)
+{
+    QList<int> cardIds;
+    for (const Server_Card *card : startZone.getCards())
+        cardIds.append(card->getId());
+    if (fromTheBack)
+        std::reverse(cardIds.begin(), cardIds.end());
+
+    QList<Server_Card *> cards;
+    for (int cardId : cardIds) {
+        int position;
+        Server_Card *card = startZone.getCard(cardId, &position);
+        ASSERT_NE(card, nullptr);
+        ASSERT_EQ(startZone.getCards().at(position), card);
+        cards.append(card);
+    }
+    for (Server_Card *card : cards) {
+        const int position = startZone.removeCard(card);
+        ASSERT_EQ(position, fromTheBack ? startZone.getCards().size() : 0);
+        targetZone.insertCard(card, fromTheBack ? 0 : -1, 0);
+    }
+}
+
+TEST(CardZoneTest, MoveCards)
+{
+    Server_CardZone graveyard(nullptr, "grave", false, ServerInfo_Zone::PublicZone);
+    Server_CardZone exile(nullptr, "rfg", false, ServerInfo_Zone::PublicZone);
+    for (int i = 0; i < cardCount; ++i)
+        graveyard.insertCard(new Server_Card({QString::number(i)}, i, 0, 0), -1, 0);
+
+    for (int round = 0; round < rounds; ++round) {
+        moveAllCards(graveyard, exile, round % 2);
+        moveAllCards(exile, graveyard, round % 2);
+    }
+
+    ASSERT_TRUE(exile.getCards().isEmpty());
+    for (int i = 0; i < cardCount; ++i)
+        ASSERT_EQ(graveyard.getCards().at(i)->getId(), i);
+}
+
+TEST(CardZoneTest, PositionsAndIds)
+{
+    Server_CardZone hand(nullptr, "hand", false, ServerInfo_Zone::PrivateZone);
+    for (int i = 0; i < 10; ++i)
+        hand.insertCard(new Server_Card({QString::number(i)}, i, 0, 0), i % 2 ? 0 : -1, 0);
+
+    // cards are inserted in the middle and removed from both sides
+    Server_Card *card = hand.getCard(4);
+    hand.removeCard(card);
+    hand.insertCard(card, 3, 0);
+    hand.removeCard(hand.getCard(9));
+    hand.removeCard(hand.getCard(8));
+    for (int i = 0; i < hand.getCards().size(); ++i) {
+        int position;
+        ASSERT_EQ(hand.getCard(hand.getCards().at(i)->getId(), &position), hand.getCards().at(i));
+        ASSERT_EQ(position, i);
+    }
+
+    card->setId(42);
+    ASSERT_EQ(hand.getCard(4), nullptr);
+    ASSERT_EQ(hand.getCard(42), card);
+    delete hand.getCard(42, nullptr, true);
+    ASSERT_EQ(hand.getCard(42), nullptr);
+    ASSERT_EQ(hand.getCards().size(), 7);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
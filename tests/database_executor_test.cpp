@@ -0,0 +1,130 @@
+#include "gtest/gtest.h"
+#include <QCoreApplication>
+#include <QList>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <servatrice_database_executor.h>
+
+namespace
+{
+
+// Occupies the worker until release() is called, so that the jobs posted meanwhile pile up in the queues.
+class BlockedWorker
+{
+    QSemaphore started;
+    QSemaphore released;
+
+public:
+    explicit BlockedWorker(Servatrice_DatabaseExecutor &executor)
+    {
+        executor.post(Servatrice_DatabaseExecutor::PriorityStatistics, [this] {
+            started.release();
+            released.acquire();
+        });
+        started.acquire();
+    }
+    void release()
+    {
+        released.release();
+    }
+};
+
+TEST(DatabaseExecutorTest, RunsHigherPrioritiesFirst)
+{
+    Servatrice_DatabaseExecutor executor("db_test", 100);
+    QMutex mutex;
+    QList<int> order;
+    const auto record = [&](int value) {
+        return [&, value] {
+            QMutexLocker locker(&mutex);
+            order.append(value);
+        };
+    };
+
+    BlockedWorker blocker(executor);
+    ASSERT_TRUE(executor.post(Servatrice_DatabaseExecutor::PriorityStatistics, record(20)));
+    ASSERT_TRUE(executor.post(Servatrice_DatabaseExecutor::PriorityLogging, record(10)));
+    ASSERT_TRUE(executor.post(Servatrice_DatabaseExecutor::PriorityStatistics, record(21)));
+    ASSERT_TRUE(executor.post(Servatrice_DatabaseExecutor::PriorityLogin, record(0)));
+    ASSERT_TRUE(executor.post(Servatrice_DatabaseExecutor::PriorityLogging, record(11)));
+
+    const Servatrice_DatabaseExecutor::Stats queued = executor.takeStats();
+    ASSERT_EQ(queued.queued[Servatrice_DatabaseExecutor::PriorityLogin], 1);
+    ASSERT_EQ(queued.queued[Servatrice_DatabaseExecutor::PriorityLogging], 2);
+    ASSERT_EQ(queued.queued[Servatrice_DatabaseExecutor::PriorityStatistics], 2);
+
+    blocker.release();
+    ASSERT_EQ(executor.submit<int>(Servatrice_DatabaseExecutor::PriorityStatistics, [] { return 42; }).result(), 42);
+    ASSERT_EQ(order, QList<int>({0, 10, 11, 20, 21}));
+
+    const Servatrice_DatabaseExecutor::Stats done = executor.takeStats();
+    ASSERT_EQ(done.executed[Servatrice_DatabaseExecutor::PriorityLogin], 1u);
+    ASSERT_EQ(done.executed[Servatrice_DatabaseExecutor::PriorityLogging], 2u);
+    ASSERT_EQ(done.executed[Servatrice_DatabaseExecutor::PriorityStatistics], 3u);
+    ASSERT_EQ(done.queued[Servatrice_DatabaseExecutor::PriorityStatistics], 0);
+}
+
+TEST(DatabaseExecutorTest, DropsLowerPriorityJobsWhenTheirQueueIsFull)
+{
+    Servatrice_DatabaseExecutor executor("db_test", 2);
+    QAtomicInt runCount(0);
+
+    BlockedWorker blocker(executor);
+    ASSERT_TRUE(executor.post(Servatrice_DatabaseExecutor::PriorityLogging, [&] { ++runCount; }));
+    ASSERT_TRUE(executor.post(Servatrice_DatabaseExecutor::PriorityLogging, [&] { ++runCount; }));
+    ASSERT_FALSE(executor.post(Servatrice_DatabaseExecutor::PriorityLogging, [&] { ++runCount; }));
+    QFuture<int> dropped = executor.submit<int>(Servatrice_DatabaseExecutor::PriorityLogging, [] { return 1; });
+    // the login queue is never full
+    for (int i = 0; i < 5; ++i)
+        ASSERT_TRUE(executor.post(Servatrice_DatabaseExecutor::PriorityLogin, [&] { ++runCount; }));
+
+    dropped.waitForFinished();
+    ASSERT_TRUE(dropped.isCanceled());
+
+    const Servatrice_DatabaseExecutor::Stats stats = executor.takeStats();
+    ASSERT_EQ(stats.dropped[Servatrice_DatabaseExecutor::PriorityLogging], 2u);
+    ASSERT_EQ(stats.peakQueued[Servatrice_DatabaseExecutor::PriorityLogging], 2);
+    ASSERT_EQ(stats.dropped[Servatrice_DatabaseExecutor::PriorityLogin], 0u);
+    ASSERT_EQ(stats.peakQueued[Servatrice_DatabaseExecutor::PriorityLogin], 5);
+    ASSERT_EQ(executor.takeStats().dropped[Servatrice_DatabaseExecutor::PriorityLogging], 0u);
+
+    blocker.release();
+    executor.submit<bool>(Servatrice_DatabaseExecutor::PriorityStatistics, [] { return true; }).waitForFinished();
+    ASSERT_EQ(runCount.loadRelaxed(), 7);
+}
+
+TEST(DatabaseExecutorTest, RunsQueuedJobsOnShutdown)
+{
+    QAtomicInt runCount(0);
+    QSemaphore started, released;
+    QThread *workerThread;
+    {
+        Servatrice_DatabaseExecutor executor("db_test", 1000);
+        workerThread = executor.getThread();
+        ASSERT_NE(workerThread, QThread::currentThread());
+
+        executor.post(Servatrice_DatabaseExecutor::PriorityStatistics, [&] {
+            started.release();
+            released.acquire();
+        });
+        started.acquire();
+        for (int i = 0; i < 500; ++i) {
+            executor.post(Servatrice_DatabaseExecutor::PriorityLogging, [&] {
+                EXPECT_EQ(QThread::currentThread(), workerThread);
+                ++runCount;
+            });
+        }
+        released.release();
+    }
+    ASSERT_EQ(runCount.loadRelaxed(), 500);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
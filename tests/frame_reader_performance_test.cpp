@@ -0,0 +1,147 @@
+#include "gtest/gtest.h"
+#include <QByteArray>
+#include <libcockatrice/protocol/frame_reader.h>
+#include <libcockatrice/protocol/pb/commands.pb.h>
+
+static constexpr int amount = 1e5;
+QByteArray pipelinedStream;
+
+static QByteArray frameWithHeader(quint32 header, const QByteArray &payload)
+{
+    QByteArray result;
+    result.append(static_cast<char>(header >> 24));
+    result.append(static_cast<char>(header >> 16));
+    result.append(static_cast<char>(header >> 8));
+    result.append(static_cast<char>(header));
+    result.append(payload);
+    return result;
+}
+
+static QByteArray frame(const CommandContainer &cont)
+{
+    const std::string payload = cont.SerializeAsString();
+    return frameWithHeader(static_cast<quint32>(payload.size()),
+                           QByteArray(payload.data(), static_cast<int>(payload.size())));
+}
+
+static int readAll(FrameReader &reader, int &nextCmdId)
+{
+    int count = 0;
+    const char *payload;
+    int length;
+    while (reader.readFrame(payload, length)) {
+        CommandContainer cont;
+        EXPECT_TRUE(cont.ParseFromArray(payload, length));
+        EXPECT_EQ(cont.cmd_id(), static_cast<quint64>(nextCmdId)) << "Frames were decoded out of order!";
+        ++nextCmdId;
+        ++count;
+    }
+    return count;
+}
+
+TEST(FrameReaderTest, WholeStream)
+{
+    FrameReader reader;
+    reader.append(pipelinedStream);
+    int nextCmdId = 0;
+    ASSERT_EQ(readAll(reader, nextCmdId), amount);
+    ASSERT_EQ(reader.bytesAvailable(), 0);
+}
+
+TEST(FrameReaderTest, SocketSizedChunks)
+{
+    // chunk boundaries deliberately do not line up with frame boundaries
+    static constexpr int chunkSize = 1400;
+    FrameReader reader;
+    int nextCmdId = 0;
+    int count = 0;
+    for (int i = 0; i < pipelinedStream.size(); i += chunkSize) {
+        reader.append(pipelinedStream.mid(i, chunkSize));
+        count += readAll(reader, nextCmdId);
+    }
+    ASSERT_EQ(count, amount);
+    ASSERT_EQ(reader.bytesAvailable(), 0);
+}
+
+TEST(FrameReaderTest, SingleBytes)
+{
+    FrameReader reader;
+    int nextCmdId = 0;
+    int count = 0;
+    QByteArray stream;
+    for (int i = 0; i < amount / 100; ++i) {
+        CommandContainer cont;
+        cont.set_cmd_id(i);
+        stream += frame(cont);
+    }
+    for (char c : stream) {
+        reader.append(QByteArray(1, c));
+        count += readAll(reader, nextCmdId);
+    }
+    ASSERT_EQ(count, amount / 100);
+}
+
+TEST(FrameReaderTest, RawHandshakeFrame)
+{
+    FrameReader reader;
+    reader.append(QByteArray(60, '<') + frame(CommandContainer()));
+    ASSERT_TRUE(reader.startsWith("<<<<"));
+    reader.expectRawFrame(60);
+
+    const char *payload;
+    int length;
+    ASSERT_TRUE(reader.readFrame(payload, length));
+    ASSERT_EQ(length, 60);
+    ASSERT_TRUE(reader.readFrame(payload, length));
+    ASSERT_EQ(length, 0);
+    ASSERT_FALSE(reader.readFrame(payload, length));
+}
+
+TEST(FrameReaderTest, CompressedFrames)
+{
+    // a container as repetitive as a game state or user list
+    CommandContainer big;
+    for (int i = 0; i < 500; ++i)
+        big.add_session_command();
+    big.set_cmd_id(0);
+    const std::string serialized = big.SerializeAsString();
+    const QByteArray payload(serialized.data(), static_cast<int>(serialized.size()));
+    const QByteArray compressedPayload = FrameReader::compressPayload(payload);
+    ASSERT_LT(compressedPayload.size(), payload.size() / 4);
+
+    CommandContainer small;
+    small.set_cmd_id(1);
+    const QByteArray stream =
+        frameWithHeader(FrameReader::compressedFlag | static_cast<quint32>(compressedPayload.size()),
+                        compressedPayload) +
+        frame(small);
+
+    FrameReader reader;
+    for (char c : stream)
+        reader.append(QByteArray(1, c));
+
+    const char *data;
+    int length;
+    bool compressed;
+    ASSERT_TRUE(reader.readFrame(data, length, &compressed));
+    ASSERT_TRUE(compressed);
+    ASSERT_EQ(FrameReader::uncompressPayload(data, length), payload);
+    ASSERT_TRUE(reader.readFrame(data, length, &compressed));
+    ASSERT_FALSE(compressed);
+    CommandContainer cont;
+    ASSERT_TRUE(cont.ParseFromArray(data, length));
+    ASSERT_EQ(cont.cmd_id(), 1u);
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 0; i < amount; ++i) {
+        CommandContainer cont;
+        cont.set_cmd_id(i);
+        cont.set_game_id(i % 97);
+        pipelinedStream += frame(cont);
+    }
+
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,170 @@
+// Compares how long connection threads are held up by game commands with and without the game executor. Not run by
+// ctest, since the numbers depend on the machine; run it by hand on an otherwise idle machine.
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <server_game_executor.h>
+#include <vector>
+
+namespace
+{
+
+constexpr int gameCount = 500;
+constexpr int commandsPerGame = 40;
+constexpr int connectionThreads = 8;
+constexpr int gameThreads = 4;
+
+struct Game
+{
+    QMutex mutex;
+};
+
+void spin(qint64 nsecs)
+{
+    QElapsedTimer busy;
+    busy.start();
+    while (busy.nsecsElapsed() < nsecs) {
+    }
+}
+
+// The locks every game command takes, like Server_ProtocolHandler::executeGameCommands().
+struct Room
+{
+    QReadWriteLock roomsLock{QReadWriteLock::Recursive};
+    QReadWriteLock gamesLock{QReadWriteLock::Recursive};
+    std::vector<Game> games;
+
+    Room() : games(gameCount)
+    {
+    }
+
+    void processCommand(int gameId)
+    {
+        QReadLocker roomsLocker(&roomsLock);
+        QReadLocker gamesLocker(&gamesLock);
+        QMutexLocker gameLocker(&games[gameId].mutex);
+        spin(20000);
+    }
+};
+
+// Creates and closes games while the commands run: Server_Room::addGame() and removeGame() hold the games lock for
+// writing while they update the room and tell its users.
+class RoomWriter
+{
+    std::atomic<bool> stopped{false};
+    QThread *thread;
+
+public:
+    explicit RoomWriter(Room &room)
+    {
+        thread = QThread::create([this, &room] {
+            while (!stopped.load()) {
+                {
+                    QWriteLocker locker(&room.gamesLock);
+                    spin(500000);
+                }
+                QThread::usleep(1500);
+            }
+        });
+        thread->start();
+    }
+    ~RoomWriter()
+    {
+        stopped = true;
+        thread->wait();
+        delete thread;
+    }
+};
+
+struct Latencies
+{
+    std::vector<qint64> blocked;   // how long the connection thread was busy with the command
+    std::vector<qint64> completed; // from sending the command until it has run
+
+    Latencies() : blocked(gameCount * commandsPerGame), completed(gameCount * commandsPerGame)
+    {
+    }
+};
+
+qint64 percentileUs(std::vector<qint64> nsecs, double p)
+{
+    std::sort(nsecs.begin(), nsecs.end());
+    return nsecs[static_cast<size_t>(p * static_cast<double>(nsecs.size() - 1))] / 1000;
+}
+
+void printPercentiles(const char *name, const Latencies &latencies)
+{
+    qInfo().nospace() << name << ": blocked p50 " << percentileUs(latencies.blocked, 0.5) << "us, p99 "
+                      << percentileUs(latencies.blocked, 0.99) << "us; completed p50 "
+                      << percentileUs(latencies.completed, 0.5) << "us, p99 " << percentileUs(latencies.completed, 0.99)
+                      << "us";
+}
+
+// Each connection thread owns the games with gameId % connectionThreads == thread and sends their commands in order.
+// submit() calls done() once the command has run, right away or later on another thread.
+template <typename Submit> Latencies runConnections(Room &room, Submit submit)
+{
+    Latencies latencies;
+    std::atomic<int> completed{0};
+    QElapsedTimer clock;
+    clock.start();
+    RoomWriter writer(room);
+
+    QList<QThread *> threads;
+    for (int t = 0; t < connectionThreads; ++t) {
+        threads.append(QThread::create([&, t] {
+            for (int sequence = 0; sequence < commandsPerGame; ++sequence) {
+                for (int gameId = t; gameId < gameCount; gameId += connectionThreads) {
+                    const int index = gameId * commandsPerGame + sequence;
+                    const qint64 submitted = clock.nsecsElapsed();
+                    submit(gameId, [&, index, submitted] {
+                        latencies.completed[index] = clock.nsecsElapsed() - submitted;
+                        ++completed;
+                    });
+                    latencies.blocked[index] = clock.nsecsElapsed() - submitted;
+                }
+            }
+        }));
+        threads.last()->start();
+    }
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    while (completed.load() < gameCount * commandsPerGame)
+        QThread::msleep(1);
+    return latencies;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    // without an executor the connection threads take the locks themselves
+    Room sharedRoom;
+    const Latencies shared = runConnections(sharedRoom, [&](int gameId, auto done) {
+        sharedRoom.processCommand(gameId);
+        done();
+    });
+    printPercentiles("shared locks", shared);
+
+    Room mailboxRoom;
+    Server_GameExecutor executor(gameThreads);
+    const Latencies mailboxes = runConnections(mailboxRoom, [&](int gameId, auto done) {
+        executor.post(gameId, [&mailboxRoom, gameId, done] {
+            mailboxRoom.processCommand(gameId);
+            done();
+        });
+    });
+    printPercentiles("mailboxes", mailboxes);
+    return 0;
+}
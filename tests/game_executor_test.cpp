@@ -0,0 +1,264 @@
+#include "gtest/gtest.h"
+#include <QCoreApplication>
+#include <QList>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QSemaphore>
+#include <QThread>
+#include <atomic>
+#include <game/server_game.h>
+#include <libcockatrice/protocol/pb/command_game_say.pb.h>
+#include <libcockatrice/protocol/pb/commands.pb.h>
+#include <libcockatrice/protocol/pb/serverinfo_user.pb.h>
+#include <server.h>
+#include <server_database_interface.h>
+#include <server_game_executor.h>
+#include <server_protocolhandler.h>
+#include <server_response_containers.h>
+#include <server_room.h>
+#include <vector>
+
+namespace
+{
+
+struct LoggedMessage
+{
+    QThread *thread;
+    QThread *databaseInterfaceThread;
+    QString message;
+};
+
+class RecordingDatabaseInterface : public Server_DatabaseInterface
+{
+    QMutex &logMutex;
+    QList<LoggedMessage> &loggedMessages;
+
+public:
+    RecordingDatabaseInterface(QMutex &_logMutex, QList<LoggedMessage> &_loggedMessages)
+        : logMutex(_logMutex), loggedMessages(_loggedMessages)
+    {
+    }
+
+    AuthenticationResult checkUserPassword(Server_ProtocolHandler * /* handler */,
+                                           const QString & /* user */,
+                                           const QString & /* password */,
+                                           const QString & /* clientId */,
+                                           QString & /* reasonStr */,
+                                           int & /* secondsLeft */,
+                                           bool /* passwordNeedsHash */) override
+    {
+        return UnknownUser;
+    }
+    ServerInfo_User getUserData(const QString &name, bool /* withId */) override
+    {
+        ServerInfo_User result;
+        result.set_name(name.toStdString());
+        return result;
+    }
+    int getNextGameId() override
+    {
+        return 1;
+    }
+    int getNextReplayId() override
+    {
+        return 1;
+    }
+    int getActiveUserCount(QString /* connectionType */) override
+    {
+        return 0;
+    }
+    void logMessage(const int /* senderId */,
+                    const QString & /* senderName */,
+                    const QString & /* senderIp */,
+                    const QString &logMessage,
+                    LogMessage_TargetType /* targetType */,
+                    const int /* targetId */,
+                    const QString & /* targetName */) override
+    {
+        QMutexLocker locker(&logMutex);
+        loggedMessages.append(LoggedMessage{QThread::currentThread(), thread(), logMessage});
+    }
+};
+
+class GameServer : public Server
+{
+public:
+    QMutex logMutex;
+    QList<LoggedMessage> loggedMessages;
+    RecordingDatabaseInterface mainDatabaseInterface;
+    Server_Room *room;
+
+    explicit GameServer(int gameThreads) : mainDatabaseInterface(logMutex, loggedMessages)
+    {
+        setDatabaseInterface(&mainDatabaseInterface);
+        startGameExecutor(gameThreads);
+        room = new Server_Room(0, 0, "room", "", "none", "none", false, "", QStringList(), this);
+        addRoom(room);
+    }
+    ~GameServer() override
+    {
+        prepareDestroy();
+    }
+    using Server::prepareDestroy;
+
+protected:
+    Server_DatabaseInterface *createGameThreadDatabaseInterface(int /* threadNumber */, QThread *thread) override
+    {
+        auto newDatabaseInterface = new RecordingDatabaseInterface(logMutex, loggedMessages);
+        newDatabaseInterface->moveToThread(thread);
+        connect(thread, &QThread::finished, newDatabaseInterface, &QObject::deleteLater);
+        return newDatabaseInterface;
+    }
+};
+
+class Client : public Server_ProtocolHandler
+{
+public:
+    Client(Server *_server, const ServerInfo_User &_userInfo) : Server_ProtocolHandler(_server, nullptr)
+    {
+        setUserInfo(_userInfo);
+        authState = PasswordRight;
+    }
+
+    QString getAddress() const override
+    {
+        return "127.0.0.1";
+    }
+    QString getConnectionType() const override
+    {
+        return "tcp";
+    }
+
+private:
+    void transmitProtocolItem(const ServerMessage & /* item */) override
+    {
+    }
+};
+
+struct Game
+{
+    std::atomic<int> running{0};
+    int lastSequence = -1;
+    bool outOfOrder = false;
+    bool overlapped = false;
+};
+
+TEST(GameExecutorTest, CommandsOfAGameRunInOrderAndOneAtATime)
+{
+    constexpr int gameCount = 64;
+    constexpr int commandsPerGame = 200;
+    constexpr int connectionThreads = 4;
+    std::vector<Game> games(gameCount);
+    QSemaphore done;
+
+    Server_GameExecutor executor(4);
+    // each connection thread owns the games with gameId % connectionThreads == thread and sends their commands in order
+    QList<QThread *> threads;
+    for (int t = 0; t < connectionThreads; ++t) {
+        threads.append(QThread::create([&, t] {
+            for (int sequence = 0; sequence < commandsPerGame; ++sequence) {
+                for (int gameId = t; gameId < gameCount; gameId += connectionThreads) {
+                    executor.post(gameId, [&games, &done, gameId, sequence] {
+                        Game &game = games[gameId];
+                        if (game.running.fetch_add(1) != 0)
+                            game.overlapped = true;
+                        if (sequence != game.lastSequence + 1)
+                            game.outOfOrder = true;
+                        game.lastSequence = sequence;
+                        QThread::yieldCurrentThread();
+                        game.running.fetch_sub(1);
+                        done.release();
+                    });
+                }
+            }
+        }));
+        threads.last()->start();
+    }
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    ASSERT_TRUE(done.tryAcquire(gameCount * commandsPerGame, 10000));
+
+    for (const Game &game : games) {
+        ASSERT_FALSE(game.overlapped) << "Commands of one game ran concurrently!";
+        ASSERT_FALSE(game.outOfOrder) << "Commands of one game ran out of order!";
+        ASSERT_EQ(game.lastSequence, commandsPerGame - 1);
+    }
+}
+
+TEST(GameExecutorTest, PostDoesNotWaitForTheRoomLocks)
+{
+    Server_GameExecutor executor(2);
+    QReadWriteLock gamesLock;
+    // like Server_Room::addGame(), which holds the games lock for writing while it tells the room's users
+    QWriteLocker writer(&gamesLock);
+
+    QSemaphore waiting, firstGameDone, secondGameDone;
+    executor.post(1, [&] {
+        waiting.release();
+        QReadLocker locker(&gamesLock);
+        firstGameDone.release();
+    });
+    ASSERT_TRUE(waiting.tryAcquire(1, 10000));
+
+    // the connection thread hands off the next command of the stuck game without waiting for it
+    executor.post(1, [&] { firstGameDone.release(); });
+    // and the other worker still runs the commands of other games
+    executor.post(2, [&] { secondGameDone.release(); });
+    ASSERT_TRUE(secondGameDone.tryAcquire(1, 10000));
+    EXPECT_EQ(firstGameDone.available(), 0);
+
+    writer.unlock();
+    ASSERT_TRUE(firstGameDone.tryAcquire(2, 10000));
+}
+
+TEST(GameExecutorTest, GameSayIsLoggedThroughTheGameThreadDatabaseInterface)
+{
+    GameServer server(2);
+    ASSERT_NE(server.getGameExecutor(), nullptr);
+
+    ServerInfo_User userInfo;
+    userInfo.set_name("alice");
+    userInfo.set_id(7);
+    userInfo.set_user_level(ServerInfo_User::IsUser);
+    Client client(&server, userInfo);
+
+    auto game = new Server_Game(userInfo, 3, "game", "", 2, QList<int>(), false, false, false, false, false, false,
+                                20, false, server.room);
+    server.room->addGame(game);
+    ResponseContainer joinResponse(-1);
+    game->addPlayer(&client, joinResponse, false, false);
+
+    CommandContainer cont;
+    cont.set_cmd_id(1);
+    cont.set_game_id(3);
+    cont.add_game_command()->MutableExtension(Command_GameSay::ext)->set_message("hello");
+    client.processCommandContainer(cont);
+
+    // the say went into the game's mailbox first, so it has run by the time this job does
+    QSemaphore done;
+    server.getGameExecutor()->post(3, [&done] { done.release(); });
+    ASSERT_TRUE(done.tryAcquire(1, 10000));
+
+    {
+        QMutexLocker locker(&server.logMutex);
+        ASSERT_EQ(server.loggedMessages.size(), 1);
+        const LoggedMessage &logged = server.loggedMessages.first();
+        EXPECT_EQ(logged.message, "hello");
+        EXPECT_TRUE(server.getGameExecutor()->getThreads().contains(logged.thread));
+        EXPECT_EQ(logged.databaseInterfaceThread, logged.thread);
+    }
+
+    // the game is closed while the client is still around to be told
+    server.prepareDestroy();
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,371 @@
+#include "gtest/gtest.h"
+#include <QCoreApplication>
+#include <QList>
+#include <QMap>
+#include <libcockatrice/protocol/pb/event_list_games.pb.h>
+#include <libcockatrice/protocol/pb/room_event.pb.h>
+#include <libcockatrice/protocol/pb/server_message.pb.h>
+#include <libcockatrice/protocol/pb/serverinfo_user.pb.h>
+#include <server.h>
+#include <server_database_interface.h>
+#include <server_game_filter.h>
+#include <server_protocolhandler.h>
+#include <server_room.h>
+
+namespace
+{
+
+ServerInfo_Game makeGame(int gameId)
+{
+    ServerInfo_Game game;
+    game.set_room_id(0);
+    game.set_game_id(gameId);
+    game.set_description("Game " + std::to_string(gameId));
+    game.set_max_players(2);
+    game.set_player_count(1);
+    game.set_start_time(1000);
+    game.add_game_types(0);
+    game.mutable_creator_info()->set_name("alice");
+    return game;
+}
+
+bool accepts(const ServerInfo_GameFilter &filter, const ServerInfo_Game &game, bool userIsRegistered = true)
+{
+    return Server_GameFilter(filter, userIsRegistered).accepts(game, 1000);
+}
+
+TEST(GameFilterTest, EmptyFilterAcceptsEveryGame)
+{
+    ServerInfo_Game game = makeGame(1);
+    game.set_only_registered(true);
+    game.set_with_password(true);
+    game.set_started(true);
+    ASSERT_TRUE(accepts(ServerInfo_GameFilter(), game));
+}
+
+TEST(GameFilterTest, HideFlags)
+{
+    ServerInfo_GameFilter filter;
+    filter.set_hide_full_games(true);
+    filter.set_hide_games_that_started(true);
+    filter.set_hide_password_protected_games(true);
+    filter.set_hide_buddies_only_games(true);
+    filter.set_hide_open_decklist_games(true);
+    ASSERT_TRUE(accepts(filter, makeGame(1)));
+
+    ServerInfo_Game full = makeGame(1);
+    full.set_player_count(2);
+    EXPECT_FALSE(accepts(filter, full));
+    ServerInfo_Game started = makeGame(1);
+    started.set_started(true);
+    EXPECT_FALSE(accepts(filter, started));
+    ServerInfo_Game withPassword = makeGame(1);
+    withPassword.set_with_password(true);
+    EXPECT_FALSE(accepts(filter, withPassword));
+    ServerInfo_Game onlyBuddies = makeGame(1);
+    onlyBuddies.set_only_buddies(true);
+    EXPECT_FALSE(accepts(filter, onlyBuddies));
+    ServerInfo_Game openDecklists = makeGame(1);
+    openDecklists.set_share_decklists_on_load(true);
+    EXPECT_FALSE(accepts(filter, openDecklists));
+}
+
+TEST(GameFilterTest, OnlyRegisteredGamesAreHiddenFromUnregisteredUsers)
+{
+    ServerInfo_Game game = makeGame(1);
+    game.set_only_registered(true);
+    EXPECT_TRUE(accepts(ServerInfo_GameFilter(), game, true));
+    EXPECT_FALSE(accepts(ServerInfo_GameFilter(), game, false));
+}
+
+TEST(GameFilterTest, NamesMatchIgnoringCase)
+{
+    ServerInfo_GameFilter filter;
+    filter.set_game_name_filter("GAME 1");
+    EXPECT_TRUE(accepts(filter, makeGame(1)));
+    EXPECT_FALSE(accepts(filter, makeGame(2)));
+
+    ServerInfo_GameFilter creatorFilter;
+    creatorFilter.add_creator_name_filters("bob");
+    creatorFilter.add_creator_name_filters("ALI");
+    EXPECT_TRUE(accepts(creatorFilter, makeGame(1)));
+    creatorFilter.set_creator_name_filters(1, "carol");
+    EXPECT_FALSE(accepts(creatorFilter, makeGame(1)));
+}
+
+TEST(GameFilterTest, GameTypesAndPlayerCount)
+{
+    ServerInfo_GameFilter filter;
+    filter.add_game_type_ids(1);
+    filter.add_game_type_ids(2);
+    ServerInfo_Game game = makeGame(1);
+    EXPECT_FALSE(accepts(filter, game));
+    game.add_game_types(2);
+    EXPECT_TRUE(accepts(filter, game));
+
+    ServerInfo_GameFilter playerFilter;
+    playerFilter.set_max_players_min(3);
+    playerFilter.set_max_players_max(4);
+    game.set_max_players(2);
+    EXPECT_FALSE(accepts(playerFilter, game));
+    game.set_max_players(4);
+    EXPECT_TRUE(accepts(playerFilter, game));
+    game.set_max_players(5);
+    EXPECT_FALSE(accepts(playerFilter, game));
+}
+
+TEST(GameFilterTest, MaxGameAge)
+{
+    ServerInfo_GameFilter filter;
+    filter.set_max_game_age_seconds(60);
+    ServerInfo_Game game = makeGame(1);
+    const Server_GameFilter gameFilter(filter, true);
+    EXPECT_TRUE(gameFilter.accepts(game, 1060));
+    EXPECT_FALSE(gameFilter.accepts(game, 1061));
+}
+
+TEST(GameFilterTest, SpectatorOptions)
+{
+    ServerInfo_GameFilter filter;
+    filter.set_show_only_if_spectators_can_watch(true);
+    ServerInfo_Game game = makeGame(1);
+    EXPECT_FALSE(accepts(filter, game));
+    game.set_spectators_allowed(true);
+    EXPECT_TRUE(accepts(filter, game));
+
+    game.set_spectators_need_password(true);
+    EXPECT_FALSE(accepts(filter, game));
+    filter.set_show_spectator_password_protected(true);
+    EXPECT_TRUE(accepts(filter, game));
+
+    filter.set_show_only_if_spectators_can_chat(true);
+    filter.set_show_only_if_spectators_can_see_hands(true);
+    EXPECT_FALSE(accepts(filter, game));
+    game.set_spectators_can_chat(true);
+    game.set_spectators_omniscient(true);
+    EXPECT_TRUE(accepts(filter, game));
+}
+
+class DatabaseInterface : public Server_DatabaseInterface
+{
+public:
+    AuthenticationResult checkUserPassword(Server_ProtocolHandler * /* handler */,
+                                           const QString & /* user */,
+                                           const QString & /* password */,
+                                           const QString & /* clientId */,
+                                           QString & /* reasonStr */,
+                                           int & /* secondsLeft */,
+                                           bool /* passwordNeedsHash */) override
+    {
+        return UnknownUser;
+    }
+    ServerInfo_User getUserData(const QString &name, bool /* withId */) override
+    {
+        ServerInfo_User result;
+        result.set_name(name.toStdString());
+        return result;
+    }
+    int getNextGameId() override
+    {
+        return 1;
+    }
+    int getNextReplayId() override
+    {
+        return 1;
+    }
+    int getActiveUserCount(QString /* connectionType */) override
+    {
+        return 0;
+    }
+};
+
+class RoomServer : public Server
+{
+public:
+    DatabaseInterface databaseInterface;
+    Server_Room *room;
+
+    RoomServer()
+    {
+        setDatabaseInterface(&databaseInterface);
+        room = new Server_Room(0, 0, "room", "", "none", "none", false, "", QStringList{"a", "b"}, this);
+        addRoom(room);
+    }
+    ~RoomServer() override
+    {
+        prepareDestroy();
+    }
+
+    // games of other servers are the easiest to add and change without players
+    void updateGame(const ServerInfo_Game &game)
+    {
+        room->updateExternalGameList(game);
+    }
+    void closeGame(int gameId)
+    {
+        ServerInfo_Game game;
+        game.set_room_id(0);
+        game.set_game_id(gameId);
+        game.set_closed(true);
+        room->updateExternalGameList(game);
+    }
+};
+
+// Keeps the game list of the room like the client does, from the Event_ListGames it receives.
+class Client : public Server_ProtocolHandler
+{
+public:
+    QMap<int, ServerInfo_Game> gameList;
+
+    Client(Server *_server, const QString &name) : Server_ProtocolHandler(_server, nullptr)
+    {
+        ServerInfo_User userInfo;
+        userInfo.set_name(name.toStdString());
+        userInfo.set_user_level(ServerInfo_User::IsUser | ServerInfo_User::IsRegistered);
+        setUserInfo(userInfo);
+        authState = PasswordRight;
+    }
+
+    QString getAddress() const override
+    {
+        return "127.0.0.1";
+    }
+    QString getConnectionType() const override
+    {
+        return "tcp";
+    }
+    QList<int> getGameIds() const
+    {
+        return gameList.keys();
+    }
+
+private:
+    void transmitProtocolItem(const ServerMessage &item) override
+    {
+        if (!item.has_room_event() || !item.room_event().HasExtension(Event_ListGames::ext))
+            return;
+        for (const ServerInfo_Game &game : item.room_event().GetExtension(Event_ListGames::ext).game_list()) {
+            if (game.closed())
+                gameList.remove(game.game_id());
+            else
+                gameList[game.game_id()].MergeFrom(game);
+        }
+    }
+};
+
+ServerInfo_GameFilter makePagedFilter(int pageSize)
+{
+    ServerInfo_GameFilter filter;
+    filter.set_hide_games_that_started(true);
+    filter.set_page_size(pageSize);
+    return filter;
+}
+
+TEST(GameFilterTest, RoomSendsOnlyTheGamesThatPassTheFilter)
+{
+    RoomServer server;
+    Client client(&server, "bob");
+    server.room->addClient(&client);
+    for (int gameId = 1; gameId <= 3; ++gameId)
+        server.updateGame(makeGame(gameId));
+    ASSERT_EQ(client.getGameIds(), QList<int>({1, 2, 3}));
+
+    ServerInfo_GameFilter filter;
+    filter.set_hide_games_that_started(true);
+    server.room->setGameFilter(&client, &filter);
+    EXPECT_EQ(client.getGameIds(), QList<int>({1, 2, 3}));
+
+    // a game that stops passing the filter is closed for the client, and comes back when it passes again
+    ServerInfo_Game started = makeGame(2);
+    started.set_started(true);
+    server.updateGame(started);
+    EXPECT_EQ(client.getGameIds(), QList<int>({1, 3}));
+    started.set_started(false);
+    server.updateGame(started);
+    EXPECT_EQ(client.getGameIds(), QList<int>({1, 2, 3}));
+
+    // a new game that fails the filter is not sent at all
+    ServerInfo_Game startedGame = makeGame(4);
+    startedGame.set_started(true);
+    server.updateGame(startedGame);
+    EXPECT_EQ(client.getGameIds(), QList<int>({1, 2, 3}));
+
+    // without a filter the client gets every game again
+    server.room->setGameFilter(&client, nullptr);
+    EXPECT_EQ(client.getGameIds(), QList<int>({1, 2, 3, 4}));
+    server.room->removeClient(&client);
+}
+
+TEST(GameFilterTest, TruncatedPageIsRefilled)
+{
+    RoomServer server;
+    Client client(&server, "bob");
+    server.room->addClient(&client);
+    for (int gameId = 1; gameId <= 5; ++gameId)
+        server.updateGame(makeGame(gameId));
+
+    const ServerInfo_GameFilter filter = makePagedFilter(2);
+    server.room->setGameFilter(&client, &filter);
+    ASSERT_EQ(client.getGameIds(), QList<int>({1, 2}));
+
+    // a full page doesn't take new games
+    server.updateGame(makeGame(6));
+    EXPECT_EQ(client.getGameIds(), QList<int>({1, 2}));
+
+    // games that leave the page are replaced by the next games that pass the filter
+    server.closeGame(1);
+    EXPECT_EQ(client.getGameIds(), QList<int>({2, 3}));
+    ServerInfo_Game started = makeGame(2);
+    started.set_started(true);
+    server.updateGame(started);
+    EXPECT_EQ(client.getGameIds(), QList<int>({3, 4}));
+    server.room->removeClient(&client);
+}
+
+TEST(GameFilterTest, NextGamePageShowsTheHiddenGames)
+{
+    RoomServer server;
+    Client client(&server, "bob");
+    server.room->addClient(&client);
+    for (int gameId = 1; gameId <= 5; ++gameId)
+        server.updateGame(makeGame(gameId));
+
+    // nothing to page through without a page size
+    EXPECT_FALSE(server.room->showNextGamePage(&client));
+
+    const ServerInfo_GameFilter filter = makePagedFilter(2);
+    server.room->setGameFilter(&client, &filter);
+    ASSERT_EQ(client.getGameIds(), QList<int>({1, 2}));
+
+    ASSERT_TRUE(server.room->showNextGamePage(&client));
+    EXPECT_EQ(client.getGameIds(), QList<int>({3, 4}));
+    ASSERT_TRUE(server.room->showNextGamePage(&client));
+    EXPECT_EQ(client.getGameIds(), QList<int>({5}));
+
+    // the last page takes new games, but not the games of the pages before it
+    server.updateGame(makeGame(6));
+    EXPECT_EQ(client.getGameIds(), QList<int>({5, 6}));
+    server.closeGame(5);
+    EXPECT_EQ(client.getGameIds(), QList<int>({6}));
+
+    // after the last page comes the first one again
+    ASSERT_TRUE(server.room->showNextGamePage(&client));
+    EXPECT_EQ(client.getGameIds(), QList<int>({1, 2}));
+    ASSERT_TRUE(server.room->showNextGamePage(&client));
+    ASSERT_TRUE(server.room->showNextGamePage(&client));
+    EXPECT_EQ(client.getGameIds(), QList<int>({6}));
+
+    // a later page that loses all of its games goes back to the first one
+    server.closeGame(6);
+    EXPECT_EQ(client.getGameIds(), QList<int>({1, 2}));
+    server.room->removeClient(&client);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
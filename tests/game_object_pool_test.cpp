@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+#include <QList>
+#include <game/server_game_object_pool.h>
+
+namespace
+{
+
+struct PooledObject : public Server_GameObject
+{
+    int value;
+    char payload[100];
+
+    explicit PooledObject(int _value) : value(_value), payload{}
+    {
+    }
+};
+
+struct LargeObject : public Server_GameObject
+{
+    char payload[4096];
+};
+
+TEST(GameObjectPoolTest, ReusesFreedBlocks)
+{
+    auto *pool = new Server_GameObjectPool;
+
+    QList<PooledObject *> objects;
+    for (int i = 0; i < 1000; ++i)
+        objects.append(new (pool) PooledObject(i));
+    for (int i = 0; i < objects.size(); ++i)
+        ASSERT_EQ(objects[i]->value, i);
+
+    const Server_GameObjectPool::Stats full = pool->getStats();
+    ASSERT_EQ(full.allocations, 1000u);
+    ASSERT_EQ(full.liveObjects, 1000);
+    ASSERT_EQ(full.peakLiveObjects, 1000);
+
+    for (auto *object : objects)
+        delete object;
+    objects.clear();
+    ASSERT_EQ(pool->getStats().liveObjects, 0);
+    ASSERT_EQ(pool->getStats().liveBytes, 0);
+
+    // a second round of the same size fits into the chunks of the first one
+    for (int i = 0; i < 1000; ++i)
+        objects.append(new (pool) PooledObject(i));
+    const Server_GameObjectPool::Stats again = pool->getStats();
+    ASSERT_EQ(again.reservedBytes, full.reservedBytes);
+    ASSERT_EQ(again.peakLiveObjects, 1000);
+
+    for (auto *object : objects)
+        delete object;
+    pool->release();
+}
+
+TEST(GameObjectPoolTest, LargeAndUnpooledObjects)
+{
+    auto *pool = new Server_GameObjectPool;
+
+    auto *large = new (pool) LargeObject;
+    ASSERT_GE(pool->getStats().reservedBytes, static_cast<qint64>(sizeof(LargeObject)));
+    delete large;
+    ASSERT_EQ(pool->getStats().reservedBytes, 0);
+
+    auto *unpooled = new PooledObject(7);
+    ASSERT_EQ(unpooled->value, 7);
+    ASSERT_EQ(pool->getStats().allocations, 1u);
+    delete unpooled;
+
+    pool->release();
+}
+
+TEST(GameObjectPoolTest, OutlivesReleaseUntilLastObjectIsFreed)
+{
+    auto *pool = new Server_GameObjectPool;
+    auto *first = new (pool) PooledObject(1);
+    auto *second = new (pool) PooledObject(2);
+
+    // the game ends while objects are still waiting for deleteLater()
+    pool->release();
+    ASSERT_EQ(first->value, 1);
+    delete first;
+    ASSERT_EQ(second->value, 2);
+    delete second;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
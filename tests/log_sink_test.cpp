@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <servatrice_log_sink.h>
+
+namespace
+{
+
+Servatrice_LogSink::Entry makeEntry(int number)
+{
+    return {QDateTime::currentDateTimeUtc(), 1, {}, {}, QString("message %1").arg(number, 4, 10, QChar('0')), {}, {},
+            {}};
+}
+
+// Collects what the sink writes, from whatever thread it runs in.
+struct Table
+{
+    QMutex mutex;
+    QList<QString> messages;
+    QList<int> batchSizes;
+
+    Servatrice_LogSink::Writer writer()
+    {
+        return [this](const QList<Servatrice_LogSink::Entry> &entries) {
+            QMutexLocker locker(&mutex);
+            batchSizes.append(entries.size());
+            for (const auto &entry : entries)
+                messages.append(entry.message);
+            return true;
+        };
+    }
+    int rowCount()
+    {
+        QMutexLocker locker(&mutex);
+        return messages.size();
+    }
+    bool waitForRows(int count)
+    {
+        QElapsedTimer clock;
+        clock.start();
+        while (rowCount() < count && clock.elapsed() < 5000)
+            QThread::msleep(1);
+        return rowCount() >= count;
+    }
+};
+
+// Runs a sink in its own thread, like the executor thread of a connection pool.
+struct SinkThread
+{
+    QThread thread;
+    Servatrice_LogSink *sink;
+
+    explicit SinkThread(Servatrice_LogSink *_sink) : sink(_sink)
+    {
+        sink->moveToThread(&thread);
+        thread.start();
+    }
+    void destroySink()
+    {
+        QMetaObject::invokeMethod(sink, [this] { delete sink; }, Qt::BlockingQueuedConnection);
+    }
+    ~SinkThread()
+    {
+        thread.quit();
+        thread.wait();
+    }
+};
+
+TEST(LogSinkTest, WritesFullBatches)
+{
+    Table table;
+    SinkThread runner(
+        new Servatrice_LogSink(table.writer(), 60000, 100, 64 * 1024 * 1024, Servatrice_LogSink::DropNewest));
+    for (int i = 0; i < 1000; ++i)
+        ASSERT_TRUE(runner.sink->append(makeEntry(i)));
+
+    // the flush interval is far away, only the row count starts a batch
+    ASSERT_TRUE(table.waitForRows(900));
+    const Servatrice_LogSink::Stats stats = runner.sink->takeStats();
+    ASSERT_GE(stats.writtenRows, 900u);
+    ASSERT_EQ(stats.droppedRows, 0u);
+
+    runner.destroySink();
+    ASSERT_EQ(table.messages.size(), 1000);
+    for (int i = 0; i < 1000; ++i)
+        ASSERT_EQ(table.messages[i], makeEntry(i).message);
+    for (int batchSize : table.batchSizes)
+        ASSERT_LE(batchSize, 100);
+}
+
+TEST(LogSinkTest, FlushesAfterInterval)
+{
+    Table table;
+    SinkThread runner(
+        new Servatrice_LogSink(table.writer(), 20, 1000, 64 * 1024 * 1024, Servatrice_LogSink::DropNewest));
+    for (int i = 0; i < 3; ++i)
+        ASSERT_TRUE(runner.sink->append(makeEntry(i)));
+
+    ASSERT_TRUE(table.waitForRows(3));
+    ASSERT_EQ(table.batchSizes, QList<int>({3}));
+    runner.destroySink();
+}
+
+TEST(LogSinkTest, OverflowPolicies)
+{
+    // room for exactly ten of the entries, which only differ in their number
+    const qint64 entrySize = sizeof(Servatrice_LogSink::Entry) + makeEntry(0).message.size() * sizeof(QChar);
+    for (auto policy : {Servatrice_LogSink::DropNewest, Servatrice_LogSink::DropOldest}) {
+        Table table;
+        // without an event loop nothing is written until the sink is destroyed
+        auto *sink = new Servatrice_LogSink(table.writer(), 60000, 1000, 10 * entrySize, policy);
+        int accepted = 0;
+        for (int i = 0; i < 15; ++i)
+            accepted += sink->append(makeEntry(i)) ? 1 : 0;
+
+        const Servatrice_LogSink::Stats stats = sink->takeStats();
+        ASSERT_EQ(stats.droppedRows, 5u);
+        ASSERT_EQ(stats.peakBufferedBytes, 10 * entrySize);
+        delete sink;
+
+        ASSERT_EQ(table.messages.size(), 10);
+        if (policy == Servatrice_LogSink::DropNewest) {
+            ASSERT_EQ(accepted, 10);
+            ASSERT_EQ(table.messages.first(), makeEntry(0).message);
+        } else {
+            ASSERT_EQ(accepted, 15);
+            ASSERT_EQ(table.messages.first(), makeEntry(5).message);
+        }
+    }
+}
+
+TEST(LogSinkTest, CountsFailedBatches)
+{
+    auto *sink = new Servatrice_LogSink([](const QList<Servatrice_LogSink::Entry> &) { return false; }, 60000, 4,
+                                        64 * 1024, Servatrice_LogSink::DropNewest);
+    for (int i = 0; i < 10; ++i)
+        sink->append(makeEntry(i));
+    sink->flush();
+
+    const Servatrice_LogSink::Stats stats = sink->takeStats();
+    ASSERT_EQ(stats.failedRows, 10u);
+    ASSERT_EQ(stats.writtenRows, 0u);
+    delete sink;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+#include <QThread>
+#include <server_rate_limiter.h>
+
+namespace
+{
+
+Server_RateLimiter::Limits sessionLimits(int maxMessages, int maxBytes, int maxCommands)
+{
+    Server_RateLimiter::Limits limits;
+    limits.perSession[Server_RateLimiter::MessageCount] = {maxMessages, 10000};
+    limits.perSession[Server_RateLimiter::MessageSize] = {maxBytes, 10000};
+    limits.perSession[Server_RateLimiter::CommandCount] = {maxCommands, 10000};
+    limits.exemptCommands = Server_RateLimiter::defaultExemptCommands();
+    return limits;
+}
+
+TEST(RateLimiterTest, MessageCountAndSize)
+{
+    Server_RateLimiter limiter;
+    limiter.setLimits(sessionLimits(3, 100, 0));
+    Server_RateLimiter::Buckets buckets;
+
+    ASSERT_TRUE(limiter.allowMessage(buckets, nullptr, 10));
+    ASSERT_TRUE(limiter.allowMessage(buckets, nullptr, 10));
+    ASSERT_FALSE(limiter.allowMessage(buckets, nullptr, 81)) << "Only 80 bytes are left";
+    ASSERT_TRUE(limiter.allowMessage(buckets, nullptr, 80)) << "A dropped message must not use up tokens";
+    ASSERT_FALSE(limiter.allowMessage(buckets, nullptr, 0)) << "Only 3 messages are allowed";
+
+    Server_RateLimiter::Counters counters = limiter.takeCounters();
+    ASSERT_EQ(counters.allowed[Server_RateLimiter::MessageCount], 3u);
+    ASSERT_EQ(counters.dropped[Server_RateLimiter::MessageCount], 2u);
+    ASSERT_EQ(counters.allowed[Server_RateLimiter::MessageSize], 100u);
+    ASSERT_EQ(limiter.takeCounters().allowed[Server_RateLimiter::MessageCount], 0u);
+}
+
+TEST(RateLimiterTest, ExemptCommandsAreNotCounted)
+{
+    Server_RateLimiter limiter;
+    limiter.setLimits(sessionLimits(0, 0, 2));
+    Server_RateLimiter::Buckets buckets;
+
+    for (int i = 0; i < 100; ++i)
+        ASSERT_TRUE(limiter.allowGameCommand(buckets, nullptr, GameCommand::DRAW_CARDS));
+    ASSERT_TRUE(limiter.allowGameCommand(buckets, nullptr, GameCommand::SHUFFLE));
+    ASSERT_TRUE(limiter.allowGameCommand(buckets, nullptr, GameCommand::ROLL_DIE));
+    ASSERT_FALSE(limiter.allowGameCommand(buckets, nullptr, GameCommand::SHUFFLE));
+}
+
+TEST(RateLimiterTest, DisabledLimitAllowsEverything)
+{
+    Server_RateLimiter limiter;
+    Server_RateLimiter::Buckets buckets;
+
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(limiter.allowMessage(buckets, nullptr, 1000));
+        ASSERT_TRUE(limiter.allowGameCommand(buckets, nullptr, GameCommand::SHUFFLE));
+    }
+    ASSERT_TRUE(limiter.getAddressBuckets("127.0.0.1").isNull());
+}
+
+TEST(RateLimiterTest, AddressBucketsAreShared)
+{
+    Server_RateLimiter limiter;
+    Server_RateLimiter::Limits limits = sessionLimits(10, 1000, 0);
+    limits.perAddress[Server_RateLimiter::MessageCount] = {3, 10000};
+    limiter.setLimits(limits);
+
+    Server_RateLimiter::Buckets first, second, other;
+    QSharedPointer<Server_RateLimiter::Buckets> address = limiter.getAddressBuckets("10.0.0.1");
+    ASSERT_EQ(address, limiter.getAddressBuckets("10.0.0.1"));
+    QSharedPointer<Server_RateLimiter::Buckets> otherAddress = limiter.getAddressBuckets("10.0.0.2");
+
+    ASSERT_TRUE(limiter.allowMessage(first, address.data(), 1));
+    ASSERT_TRUE(limiter.allowMessage(second, address.data(), 1));
+    ASSERT_TRUE(limiter.allowMessage(first, address.data(), 1));
+    ASSERT_FALSE(limiter.allowMessage(second, address.data(), 1));
+    ASSERT_TRUE(limiter.allowMessage(other, otherAddress.data(), 1));
+}
+
+TEST(RateLimiterTest, Refill)
+{
+    Server_RateLimiter limiter;
+    Server_RateLimiter::Limits limits;
+    limits.perSession[Server_RateLimiter::CommandCount] = {10, 1000};
+    limiter.setLimits(limits);
+    Server_RateLimiter::Buckets buckets;
+
+    for (int i = 0; i < 10; ++i)
+        ASSERT_TRUE(limiter.allowGameCommand(buckets, nullptr, GameCommand::SHUFFLE));
+    ASSERT_FALSE(limiter.allowGameCommand(buckets, nullptr, GameCommand::SHUFFLE));
+
+    // one command every 100 msecs
+    QThread::msleep(150);
+    ASSERT_TRUE(limiter.allowGameCommand(buckets, nullptr, GameCommand::SHUFFLE));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
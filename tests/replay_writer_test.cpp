@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include <game/server_replay_writer.h>
+#include <libcockatrice/protocol/pb/event_game_say.pb.h>
+#include <libcockatrice/protocol/pb/game_event_container.pb.h>
+#include <libcockatrice/protocol/pb/game_replay.pb.h>
+
+namespace
+{
+
+GameEventContainer makeEvent(int i)
+{
+    GameEventContainer cont;
+    cont.set_seconds_elapsed(i / 10);
+    GameEvent *event = cont.add_event_list();
+    event->set_player_id(i % 4);
+    event->MutableExtension(Event_GameSay::ext)->set_message(std::string(50 + i % 200, 'a' + i % 26));
+    return cont;
+}
+
+ServerInfo_Game makeGameInfo()
+{
+    ServerInfo_Game gameInfo;
+    gameInfo.set_game_id(17);
+    gameInfo.set_description("commander night");
+    gameInfo.set_max_players(4);
+    return gameInfo;
+}
+
+void expectSameReplay(Server_ReplayWriter &writer, int eventCount)
+{
+    GameReplay expected;
+    expected.set_replay_id(writer.getReplayId());
+    expected.mutable_game_info()->CopyFrom(makeGameInfo());
+    expected.set_duration_seconds(writer.getDurationSeconds());
+    for (int i = 0; i < eventCount; ++i)
+        expected.add_event_list()->CopyFrom(makeEvent(i));
+
+    const QByteArray blob = writer.readReplay();
+    GameReplay replay;
+    ASSERT_TRUE(replay.ParseFromArray(blob.data(), static_cast<int>(blob.size())));
+    ASSERT_EQ(replay.SerializeAsString(), expected.SerializeAsString());
+}
+
+TEST(ReplayWriterTest, SmallReplayStaysInMemory)
+{
+    Server_ReplayWriter writer(5, makeGameInfo(), 1024 * 1024);
+    for (int i = 0; i < 20; ++i)
+        writer.appendEvent(makeEvent(i));
+    writer.setDurationSeconds(90);
+
+    ASSERT_EQ(writer.getEventCount(), 20);
+    ASSERT_EQ(writer.getPeakBufferedBytes(), writer.getRecordedBytes());
+    expectSameReplay(writer, 20);
+}
+
+TEST(ReplayWriterTest, SpooledReplayMatchesInMemoryReplay)
+{
+    Server_ReplayWriter writer(6, makeGameInfo(), 1000);
+    for (int i = 0; i < 500; ++i)
+        writer.appendEvent(makeEvent(i));
+    writer.setDurationSeconds(600);
+
+    ASSERT_LT(writer.getPeakBufferedBytes(), writer.getRecordedBytes());
+    expectSameReplay(writer, 500);
+    // reading the replay doesn't end the recording
+    writer.appendEvent(makeEvent(500));
+    expectSameReplay(writer, 501);
+}
+
+TEST(ReplayWriterTest, EmptyReplay)
+{
+    Server_ReplayWriter writer(7, makeGameInfo(), 1000);
+    expectSameReplay(writer, 0);
+}
+
+TEST(ReplayWriterTest, LongGameSoak)
+{
+    // a long game: about 30 MB of events, which used to be held in memory until the game ended
+    const int bufferSize = 64 * 1024;
+    const int eventCount = 200000;
+    Server_ReplayWriter writer(8, makeGameInfo(), bufferSize);
+    int largestEvent = 0;
+    for (int i = 0; i < eventCount; ++i) {
+        const GameEventContainer event = makeEvent(i);
+        largestEvent = qMax(largestEvent, static_cast<int>(event.ByteSizeLong()) + 10);
+        writer.appendEvent(event);
+    }
+    ASSERT_EQ(writer.getEventCount(), eventCount);
+    ASSERT_GT(writer.getRecordedBytes(), 100 * bufferSize);
+    ASSERT_LT(writer.getPeakBufferedBytes(), bufferSize + largestEvent);
+
+    const QByteArray blob = writer.readReplay();
+    GameReplay replay;
+    ASSERT_TRUE(replay.ParseFromArray(blob.data(), static_cast<int>(blob.size())));
+    ASSERT_EQ(replay.event_list_size(), eventCount);
+    ASSERT_EQ(replay.event_list(eventCount - 1).SerializeAsString(), makeEvent(eventCount - 1).SerializeAsString());
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,68 @@
+// Compares how many numbers threads draw per second from one generator behind a lock, as the RNG worked before every
+// thread got its own stream, and from their own streams. Not run by ctest, since the numbers depend on the machine;
+// run it by hand on an otherwise idle machine.
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <libcockatrice/rng/rng_sfmt.h>
+
+namespace
+{
+
+constexpr int threadCount = 8;
+constexpr int drawsPerThread = 2000000;
+
+// Runs draw(numbers) on every thread at once, returns the numbers drawn per second.
+template <typename Draw> qint64 measure(Draw draw)
+{
+    QList<QThread *> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.append(QThread::create([&draw] {
+            QVector<unsigned int> numbers(drawsPerThread);
+            draw(numbers);
+        }));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (QThread *thread : threads)
+        thread->start();
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    return static_cast<qint64>(threadCount) * drawsPerThread * 1000000000 / qMax(timer.nsecsElapsed(), qint64(1));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    RNG_SFMT rng;
+
+    QMutex sharedMutex;
+    const qint64 shared = measure([&](QVector<unsigned int> &numbers) {
+        for (unsigned int &number : numbers) {
+            QMutexLocker locker(&sharedMutex);
+            number = rng.rand(1, 6);
+        }
+    });
+    qInfo() << "shared generator behind a lock:" << shared << "numbers/s";
+
+    const qint64 streams = measure([&](QVector<unsigned int> &numbers) {
+        for (unsigned int &number : numbers)
+            number = rng.rand(1, 6);
+    });
+    qInfo() << "per-thread streams, rand():" << streams << "numbers/s";
+
+    const qint64 filled = measure(
+        [&](QVector<unsigned int> &numbers) { rng.fill(std::span(numbers.data(), numbers.size()), 1, 6); });
+    qInfo() << "per-thread streams, fill():" << filled << "numbers/s";
+    return 0;
+}
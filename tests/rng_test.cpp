@@ -0,0 +1,138 @@
+#include "gtest/gtest.h"
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <libcockatrice/rng/rng_sfmt.h>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+
+// chi-square values that a fair RNG exceeds with a probability of 0.1%
+constexpr double chiSquare5 = 20.52;
+constexpr double chiSquare9 = 27.88;
+constexpr double chiSquare23 = 49.73;
+
+TEST(RngTest, RandIsUniform)
+{
+    RNG_SFMT rng(1234);
+    const QVector<int> numbers = rng.makeNumbersVector(600000, 1, 6);
+    ASSERT_LT(rng.testRandom(numbers), chiSquare5);
+}
+
+TEST(RngTest, FillIsUniform)
+{
+    RNG_SFMT rng(1234);
+    QVector<unsigned int> numbers(1000000);
+    rng.fill(std::span(numbers.data(), numbers.size()), 0, 9);
+
+    QVector<int> counts(10);
+    for (unsigned int number : numbers) {
+        ASSERT_LE(number, 9u);
+        ++counts[number];
+    }
+    ASSERT_LT(rng.testRandom(counts), chiSquare9);
+}
+
+TEST(RngTest, FillMatchesRand)
+{
+    // both generators seed the first stream of this thread the same way
+    RNG_SFMT randRng(1234);
+    RNG_SFMT fillRng(1234);
+    for (auto [min, max] : {std::pair(1, 6), std::pair(0, 1000000), std::pair(0, -20)}) {
+        QVector<unsigned int> drawn(100000);
+        for (unsigned int &number : drawn)
+            number = randRng.rand(min, max);
+        QVector<unsigned int> filled(100000);
+        fillRng.fill(std::span(filled.data(), filled.size()), min, max);
+        ASSERT_EQ(filled, drawn) << "fill(" << min << ", " << max << ") differs from rand()";
+    }
+}
+
+TEST(RngTest, ShuffleIsUniform)
+{
+    RNG_SFMT rng(1234);
+    // every permutation of four items is counted under its index in lexicographic order
+    QVector<int> counts(24);
+    for (int round = 0; round < 240000; ++round) {
+        QList<int> items = {0, 1, 2, 3};
+        rng.shuffle(items.begin(), items.end());
+
+        int index = 0;
+        for (int i = 0; i < 4; ++i) {
+            int smallerAfter = 0;
+            for (int j = i + 1; j < 4; ++j)
+                if (items[j] < items[i])
+                    ++smallerAfter;
+            index = index * (4 - i) + smallerAfter;
+        }
+        ++counts[index];
+    }
+    ASSERT_LT(rng.testRandom(counts), chiSquare23);
+}
+
+TEST(RngTest, ThreadsHaveIndependentStreams)
+{
+    RNG_SFMT rng(1234);
+    constexpr int threadCount = 8;
+    constexpr int drawsPerThread = 60000;
+
+    QMutex resultMutex;
+    QList<QVector<int>> sequences;
+    QVector<int> counts(6);
+    QList<QThread *> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.append(QThread::create([&] {
+            QVector<int> sequence;
+            for (int i = 0; i < 100; ++i)
+                sequence.append(static_cast<int>(rng.rand(0, 1000000)));
+            const QVector<int> threadCounts = rng.makeNumbersVector(drawsPerThread, 1, 6);
+
+            QMutexLocker locker(&resultMutex);
+            sequences.append(sequence);
+            for (int i = 0; i < counts.size(); ++i)
+                counts[i] += threadCounts[i];
+        }));
+        threads.last()->start();
+    }
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    ASSERT_EQ(sequences.size(), threadCount);
+    for (int a = 0; a < threadCount; ++a)
+        for (int b = a + 1; b < threadCount; ++b)
+            ASSERT_NE(sequences[a], sequences[b]);
+    ASSERT_LT(rng.testRandom(counts), chiSquare5);
+}
+
+TEST(RngTest, Bounds)
+{
+    RNG_SFMT rng(1234);
+    ASSERT_EQ(rng.rand(5, 5), 5u);
+    ASSERT_THROW(rng.rand(-1, 5), std::invalid_argument);
+    ASSERT_THROW(rng.rand(6, 5), std::invalid_argument);
+
+    unsigned int numbers[16];
+    rng.fill(numbers, 3, 3);
+    ASSERT_TRUE(std::all_of(std::begin(numbers), std::end(numbers), [](unsigned int n) { return n == 3; }));
+    ASSERT_THROW(rng.fill(numbers, 6, 5), std::invalid_argument);
+
+    for (int i = 0; i < 1000; ++i) {
+        const unsigned int number = rng.rand(0, 1);
+        ASSERT_LE(number, 1u);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
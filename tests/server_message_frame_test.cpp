@@ -0,0 +1,70 @@
+#include "gtest/gtest.h"
+#include <libcockatrice/protocol/pb/response_join_room.pb.h>
+#include <libcockatrice/protocol/pb/serverinfo_room.pb.h>
+#include <server_message_frame.h>
+
+namespace
+{
+
+ServerInfo_Room roomInfo()
+{
+    ServerInfo_Room room;
+    room.set_room_id(3);
+    room.set_name("Magic");
+    room.set_game_count(200);
+    for (int i = 0; i < 200; ++i) {
+        ServerInfo_Game *game = room.add_game_list();
+        game->set_game_id(i);
+        game->set_description(std::string(i, 'x'));
+    }
+    room.add_user_list()->set_name("someone");
+    return room;
+}
+
+TEST(ServerMessageFrameTest, EncodedResponseMatchesResponse)
+{
+    Response response;
+    response.set_cmd_id(42);
+    response.set_response_code(Response::RespOk);
+    Response full(response);
+    full.MutableExtension(Response_JoinRoom::ext)->mutable_room_info()->CopyFrom(roomInfo());
+
+    QByteArray encodedRoom = QByteArray::fromStdString(roomInfo().SerializeAsString());
+    QByteArray joinRoom, encodedExtension;
+    ServerMessageFrame::appendEncodedField(joinRoom, Response_JoinRoom::kRoomInfoFieldNumber, encodedRoom);
+    ServerMessageFrame::appendEncodedField(encodedExtension, Response_JoinRoom::kExtFieldNumber, joinRoom);
+
+    const ServerMessageFrame expected(full);
+    const ServerMessageFrame encoded(response, encodedExtension);
+    ASSERT_EQ(encoded.getFrame(), expected.getFrame());
+    ASSERT_EQ(encoded.getMessage().SerializeAsString(), expected.getMessage().SerializeAsString());
+    ASSERT_EQ(encoded.getMessage().response().GetExtension(Response_JoinRoom::ext).room_info().game_list_size(), 200);
+}
+
+TEST(ServerMessageFrameTest, FieldsInAnyOrder)
+{
+    // the room lists follow the other fields when a room snapshot is assembled
+    ServerInfo_Room head;
+    head.set_room_id(1);
+    head.add_gametype_list()->set_description("Standard");
+    ServerInfo_Game game;
+    game.set_game_id(7);
+
+    QByteArray encoded = QByteArray::fromStdString(head.SerializeAsString());
+    ServerMessageFrame::appendEncodedField(encoded, ServerInfo_Room::kGameListFieldNumber,
+                                           QByteArray::fromStdString(game.SerializeAsString()));
+
+    ServerInfo_Room decoded;
+    ASSERT_TRUE(decoded.ParseFromArray(encoded.constData(), encoded.size()));
+    ASSERT_EQ(decoded.gametype_list_size(), 1);
+    ASSERT_EQ(decoded.game_list_size(), 1);
+    ASSERT_EQ(decoded.game_list(0).game_id(), 7);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
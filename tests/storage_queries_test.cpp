@@ -0,0 +1,234 @@
+#include "gtest/gtest.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <libcockatrice/protocol/pb/response_replay_list.pb.h>
+#include <libcockatrice/protocol/pb/serverinfo_deckstorage.pb.h>
+#include <libcockatrice/protocol/pb/serverinfo_replay.pb.h>
+#include <libcockatrice/protocol/pb/serverinfo_replay_match.pb.h>
+#include <libcockatrice/protocol/replay_codec.h>
+#include <servatrice_storage_queries.h>
+
+namespace
+{
+
+const int userId = 1;
+const int otherUserId = 2;
+const int gameCount = 300;
+
+// the tables of servatrice.sql that the queries read, in SQLite
+const char *const schema[] = {
+    "create table cockatrice_games (id integer primary key, room_name text, descr text, time_started datetime, "
+    "time_finished datetime)",
+    "create table cockatrice_games_players (id_game integer, player_name text)",
+    "create table cockatrice_replays (id integer primary key, id_game integer, duration integer, replay blob)",
+    "create table cockatrice_replays_access (id_game integer, id_player integer, replay_name text, do_not_hide "
+    "integer)",
+    "create table cockatrice_decklist_folders (id integer primary key, id_parent integer, id_user integer, name text)",
+    "create table cockatrice_decklist_files (id integer primary key, id_folder integer, id_user integer, name text, "
+    "upload_time datetime, content text)",
+};
+
+class StorageQueriesTest : public ::testing::Test
+{
+protected:
+    QSqlDatabase database;
+    QHash<QString, QSqlQuery *> preparedStatements;
+    int queryCount = 0;
+    Servatrice_StorageQueries queries{[this](const QString &queryText) { return prepare(queryText); },
+                                      [this](QSqlQuery *query) {
+                                          ++queryCount;
+                                          const bool ok = query->exec();
+                                          EXPECT_TRUE(ok) << query->lastError().text().toStdString();
+                                          return ok;
+                                      }};
+
+    QSqlQuery *prepare(const QString &queryText)
+    {
+        QString prefixedQueryText = queryText;
+        prefixedQueryText.replace("{prefix}", "cockatrice");
+        if (!preparedStatements.contains(prefixedQueryText)) {
+            auto *query = new QSqlQuery(database);
+            EXPECT_TRUE(query->prepare(prefixedQueryText)) << query->lastError().text().toStdString();
+            preparedStatements.insert(prefixedQueryText, query);
+        }
+        return preparedStatements.value(prefixedQueryText);
+    }
+
+    void run(const QString &queryText, const QVariantList &values = {})
+    {
+        QSqlQuery query(database);
+        ASSERT_TRUE(query.prepare(queryText)) << query.lastError().text().toStdString();
+        for (const QVariant &value : values)
+            query.addBindValue(value);
+        ASSERT_TRUE(query.exec()) << query.lastError().text().toStdString();
+    }
+
+    void SetUp() override
+    {
+        if (!QSqlDatabase::isDriverAvailable("QSQLITE"))
+            GTEST_SKIP() << "the Qt SQLite driver is not available";
+        database = QSqlDatabase::addDatabase("QSQLITE", "storage_queries_test");
+        database.setDatabaseName(":memory:");
+        ASSERT_TRUE(database.open());
+        for (const char *table : schema)
+            run(table);
+    }
+
+    void TearDown() override
+    {
+        qDeleteAll(preparedStatements);
+        preparedStatements.clear();
+        if (database.isValid()) {
+            database.close();
+            database = QSqlDatabase();
+            QSqlDatabase::removeDatabase("storage_queries_test");
+        }
+    }
+
+    void addGame(int gameId, const QDateTime &started, bool doNotHide)
+    {
+        run("insert into cockatrice_games values (?, ?, ?, ?, ?)",
+            {gameId, "room", QString("game %1").arg(gameId), started, started.addSecs(gameId)});
+        for (const QString &player : {QString("alice"), QString("bob %1").arg(gameId)})
+            run("insert into cockatrice_games_players values (?, ?)", {gameId, player});
+        for (int i = 0; i < 2; ++i)
+            run("insert into cockatrice_replays (id_game, duration, replay) values (?, ?, '')", {gameId, 60 * i});
+        run("insert into cockatrice_replays_access values (?, ?, ?, ?)",
+            {gameId, userId, QString("replay %1").arg(gameId), doNotHide ? 1 : 0});
+        run("insert into cockatrice_replays_access values (?, ?, ?, 0)",
+            {gameId, otherUserId, QString("theirs %1").arg(gameId)});
+    }
+};
+
+TEST_F(StorageQueriesTest, ReplayListTakesFourQueries)
+{
+    // games are started with the database's clock, like servatrice does
+    QSqlQuery clock("select current_timestamp", database);
+    ASSERT_TRUE(clock.next());
+    const QDateTime now = clock.value(0).toDateTime();
+    ASSERT_TRUE(now.isValid());
+    database.transaction();
+    for (int gameId = 1; gameId <= gameCount; ++gameId)
+        addGame(gameId, now.addSecs(-gameId * 60), false);
+    // too old to be listed, unless it is kept
+    addGame(gameCount + 1, now.addDays(-30), false);
+    addGame(gameCount + 2, now.addDays(-30), true);
+    database.commit();
+
+    Response_ReplayList replayList;
+    ASSERT_TRUE(queries.getReplayList(userId, replayList));
+    ASSERT_EQ(queryCount, 4);
+
+    ASSERT_EQ(replayList.match_list_size(), gameCount + 1);
+    for (const ServerInfo_ReplayMatch &match : replayList.match_list()) {
+        ASSERT_NE(match.game_id(), gameCount + 1);
+        ASSERT_EQ(match.game_name(), QString("game %1").arg(match.game_id()).toStdString());
+        ASSERT_EQ(match.length(), static_cast<unsigned int>(match.game_id()));
+        ASSERT_EQ(match.player_names_size(), 2);
+        ASSERT_EQ(match.replay_list_size(), 2);
+        for (const ServerInfo_Replay &replay : match.replay_list())
+            ASSERT_EQ(replay.replay_name(), QString("replay %1").arg(match.game_id()).toStdString());
+        ASSERT_LT(match.replay_list(0).replay_id(), match.replay_list(1).replay_id());
+    }
+
+    // an empty list stops after reading the clock and the first query
+    queryCount = 0;
+    Response_ReplayList emptyList;
+    ASSERT_TRUE(queries.getReplayList(42, emptyList));
+    ASSERT_EQ(queryCount, 2);
+    ASSERT_EQ(emptyList.match_list_size(), 0);
+}
+
+TEST_F(StorageQueriesTest, DeckTreeTakesTwoQueries)
+{
+    const QDateTime uploaded = QDateTime::currentDateTime();
+    database.transaction();
+    // a chain of 50 nested folders with a deck in each, and a second top level folder
+    for (int id = 1; id <= 50; ++id) {
+        run("insert into cockatrice_decklist_folders values (?, ?, ?, ?)",
+            {id, id - 1, userId, QString("f%1").arg(id)});
+        run("insert into cockatrice_decklist_files values (?, ?, ?, ?, ?, '')",
+            {id, id, userId, QString("deck %1").arg(id), uploaded});
+    }
+    run("insert into cockatrice_decklist_folders values (51, 0, ?, 'Other')", {userId});
+    run("insert into cockatrice_decklist_files values (51, 0, ?, 'top deck', ?, '')", {userId, uploaded});
+    run("insert into cockatrice_decklist_folders values (52, 0, ?, 'not mine')", {otherUserId});
+    database.commit();
+
+    ServerInfo_DeckStorage_Folder root;
+    ASSERT_TRUE(queries.getDeckTree(userId, root));
+    ASSERT_EQ(queryCount, 2);
+
+    // folders first, then files
+    ASSERT_EQ(root.items_size(), 3);
+    ASSERT_EQ(root.items(0).name(), "f1");
+    ASSERT_EQ(root.items(1).name(), "Other");
+    ASSERT_EQ(root.items(2).name(), "top deck");
+    ASSERT_EQ(root.items(2).file().creation_time(), static_cast<unsigned int>(uploaded.toSecsSinceEpoch()));
+
+    const ServerInfo_DeckStorage_Folder *folder = &root;
+    for (int depth = 1; depth <= 50; ++depth) {
+        const ServerInfo_DeckStorage_TreeItem &child = folder->items(0);
+        ASSERT_EQ(child.name(), QString("f%1").arg(depth).toStdString());
+        ASSERT_TRUE(child.has_folder());
+        folder = &child.folder();
+        ASSERT_EQ(folder->items(folder->items_size() - 1).name(), QString("deck %1").arg(depth).toStdString());
+    }
+}
+
+TEST_F(StorageQueriesTest, DeckFolderIdTakesOneQuery)
+{
+    database.transaction();
+    for (int id = 1; id <= 20; ++id) {
+        run("insert into cockatrice_decklist_folders values (?, ?, ?, ?)",
+            {id, id - 1, userId, QString("f%1").arg(id)});
+    }
+    database.commit();
+
+    ASSERT_EQ(queries.getDeckFolderId(userId, "f1/f2/f3"), 3);
+    ASSERT_EQ(queryCount, 1);
+    ASSERT_EQ(queries.getDeckFolderId(userId, "F1/F2"), 2);
+    ASSERT_EQ(queries.getDeckFolderId(userId, "f1/f3"), -1);
+    ASSERT_EQ(queries.getDeckFolderId(otherUserId, "f1"), -1);
+
+    // the root folder is found without a query
+    queryCount = 0;
+    ASSERT_EQ(queries.getDeckFolderId(userId, ""), 0);
+    ASSERT_EQ(queryCount, 0);
+}
+
+TEST_F(StorageQueriesTest, ReplayShareHashDoesNotDependOnCompression)
+{
+    QByteArray replays[2];
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 300; ++j)
+            replays[i].append(static_cast<char>((i * 7 + j) % 251));
+        run("insert into cockatrice_replays (id_game, duration, replay) values (?, ?, ?)", {1, 60, replays[i]});
+    }
+
+    // the hash in the share codes handed out while replays were stored as they are
+    auto expected = QCryptographicHash::hash(replays[0].left(128) + replays[1].left(128), QCryptographicHash::Md5)
+                        .toBase64(QByteArray::OmitTrailingEquals);
+    expected.truncate(10);
+    ASSERT_EQ(queries.getReplayShareHash(1), QString(expected));
+    ASSERT_EQ(queryCount, 1);
+
+    for (const QByteArray &replay : replays)
+        run("update cockatrice_replays set replay = ? where replay = ?", {ReplayCodec::encode(replay), replay});
+    ASSERT_EQ(queries.getReplayShareHash(1), QString(expected));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
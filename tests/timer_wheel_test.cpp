@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+#include <QAtomicInt>
+#include <QList>
+#include <QSemaphore>
+#include <QThread>
+#include <server_timer_wheel.h>
+
+namespace
+{
+
+TEST(TimerWheelTest, FiresOnDeadline)
+{
+    Server_TimerWheel wheel;
+    // one deadline in every level, on and next to the slot boundaries
+    const QList<qint64> deadlines = {0, 1, 63, 64, 65, 4095, 4096, 4097, 100000, 262143, 262144, 300000};
+    QList<qint64> firedAt;
+    for (qint64 deadline : deadlines)
+        wheel.scheduleAt(deadline, [&] { firedAt.append(wheel.getCurrentTick()); });
+
+    while (wheel.getCurrentTick() <= 300000)
+        wheel.advance();
+
+    ASSERT_EQ(firedAt, deadlines);
+}
+
+TEST(TimerWheelTest, PastDeadlineFiresOnNextTick)
+{
+    Server_TimerWheel wheel;
+    for (int i = 0; i < 10; ++i)
+        wheel.advance();
+
+    qint64 firedAt = -1;
+    wheel.scheduleAt(3, [&] { firedAt = wheel.getCurrentTick(); });
+    wheel.advance();
+    ASSERT_EQ(firedAt, 10);
+}
+
+TEST(TimerWheelTest, CancelledTimerDoesNotFire)
+{
+    Server_TimerWheel wheel;
+    bool fired = false;
+    quint64 timerId = wheel.scheduleAt(5000, [&] { fired = true; });
+    for (int i = 0; i < 100; ++i)
+        wheel.advance();
+    wheel.cancel(timerId);
+    for (int i = 0; i < 10000; ++i)
+        wheel.advance();
+    ASSERT_FALSE(fired);
+}
+
+TEST(TimerWheelTest, CallbackCanReschedule)
+{
+    Server_TimerWheel wheel;
+    QList<qint64> firedAt;
+    std::function<void()> repeat = [&] {
+        firedAt.append(wheel.getCurrentTick());
+        // a deadline on the running tick can't fire in it any more
+        wheel.scheduleAt(firedAt.size() % 2 ? wheel.getCurrentTick() : wheel.getCurrentTick() + 100, repeat);
+    };
+    wheel.scheduleAt(1, repeat);
+    while (wheel.getCurrentTick() < 300)
+        wheel.advance();
+
+    ASSERT_EQ(firedAt, QList<qint64>({1, 2, 102, 103, 203, 204}));
+}
+
+TEST(TimerWheelTest, CallbackCancelsLaterOneOfSameTick)
+{
+    Server_TimerWheel wheel;
+    quint64 second = 0;
+    bool secondFired = false;
+    wheel.scheduleAt(7, [&] { wheel.cancel(second); });
+    second = wheel.scheduleAt(7, [&] { secondFired = true; });
+    while (wheel.getCurrentTick() < 10)
+        wheel.advance();
+    ASSERT_FALSE(secondFired);
+}
+
+TEST(TimerWheelTest, CancelWaitsForRunningCallback)
+{
+    Server_TimerWheel wheel;
+    QSemaphore started, released;
+    QAtomicInt finished(0);
+    const quint64 timerId = wheel.scheduleAt(0, [&] {
+        started.release();
+        released.acquire();
+        finished.storeRelease(1);
+    });
+
+    // the callback has been taken off the wheel when the other thread cancels it
+    QThread *ticker = QThread::create([&] { wheel.advance(); });
+    ticker->start();
+    started.acquire();
+    QThread *canceller = QThread::create([&] {
+        wheel.cancel(timerId);
+        EXPECT_EQ(finished.loadAcquire(), 1);
+    });
+    canceller->start();
+    ASSERT_FALSE(canceller->wait(50));
+    released.release();
+    ASSERT_TRUE(canceller->wait(5000));
+    ASSERT_TRUE(ticker->wait(5000));
+    delete canceller;
+    delete ticker;
+}
+
+TEST(TimerWheelTest, CallbackCanCancelItself)
+{
+    Server_TimerWheel wheel;
+    quint64 timerId = 0;
+    int runCount = 0;
+    timerId = wheel.scheduleAt(1, [&] {
+        ++runCount;
+        wheel.cancel(timerId);
+    });
+    while (wheel.getCurrentTick() < 3)
+        wheel.advance();
+    ASSERT_EQ(runCount, 1);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
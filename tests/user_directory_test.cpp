@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+#include <server_user_directory.h>
+
+namespace
+{
+
+ServerInfo_User user(const char *name)
+{
+    ServerInfo_User userInfo;
+    userInfo.set_name(name);
+    return userInfo;
+}
+
+QStringList names(const QList<ServerInfo_User> &users)
+{
+    QStringList result;
+    for (const ServerInfo_User &userInfo : users)
+        result.append(QString::fromStdString(userInfo.name()));
+    return result;
+}
+
+TEST(UserDirectoryTest, Pages)
+{
+    Server_UserDirectory directory;
+    for (const char *name : {"dave", "alice", "erin", "carol", "bob"})
+        directory.addUser(user(name));
+    ASSERT_EQ(directory.getVersion(), 5u);
+
+    bool hasMore;
+    ASSERT_EQ(names(directory.getPage(QString(), 2, nullptr, hasMore)), QStringList({"alice", "bob"}));
+    ASSERT_TRUE(hasMore);
+    ASSERT_EQ(names(directory.getPage("bob", 2, nullptr, hasMore)), QStringList({"carol", "dave"}));
+    ASSERT_TRUE(hasMore);
+    ASSERT_EQ(names(directory.getPage("dave", 2, nullptr, hasMore)), QStringList({"erin"}));
+    ASSERT_FALSE(hasMore);
+    ASSERT_EQ(directory.getPage(QString(), 0, nullptr, hasMore).size(), 5);
+    ASSERT_FALSE(hasMore);
+
+    const QSet<QString> buddies{"erin", "bob", "mallory"};
+    ASSERT_EQ(names(directory.getPage(QString(), 1, &buddies, hasMore)), QStringList({"bob"}));
+    ASSERT_TRUE(hasMore);
+    ASSERT_EQ(names(directory.getPage("bob", 1, &buddies, hasMore)), QStringList({"erin"}));
+    ASSERT_FALSE(hasMore);
+}
+
+TEST(UserDirectoryTest, ChangesSince)
+{
+    Server_UserDirectory directory;
+    directory.addUser(user("alice"));
+    directory.addUser(user("bob"));
+    const quint64 version = directory.getVersion();
+
+    directory.addUser(user("carol"));
+    ASSERT_EQ(directory.removeUser("alice"), version + 2);
+    ASSERT_EQ(directory.removeUser("nobody"), version + 2) << "Unknown users must not change the version";
+    directory.addUser(user("dave"));
+    directory.removeUser("dave");
+
+    Server_UserDirectory::Changes changes;
+    ASSERT_TRUE(directory.getChangesSince(directory.getEpoch(), version, nullptr, changes));
+    ASSERT_EQ(names(changes.users), QStringList({"carol"}));
+    ASSERT_EQ(changes.leftUserNames, QStringList({"alice", "dave"}));
+
+    const QSet<QString> buddies{"alice"};
+    Server_UserDirectory::Changes buddyChanges;
+    ASSERT_TRUE(directory.getChangesSince(directory.getEpoch(), version, &buddies, buddyChanges));
+    ASSERT_TRUE(buddyChanges.users.isEmpty());
+    ASSERT_EQ(buddyChanges.leftUserNames, QStringList({"alice"}));
+
+    Server_UserDirectory::Changes none;
+    ASSERT_TRUE(directory.getChangesSince(directory.getEpoch(), directory.getVersion(), nullptr, none));
+    ASSERT_TRUE(none.users.isEmpty() && none.leftUserNames.isEmpty());
+    ASSERT_FALSE(directory.getChangesSince(directory.getEpoch(), directory.getVersion() + 1, nullptr, none))
+        << "A version higher than the current one is unknown";
+}
+
+TEST(UserDirectoryTest, VersionsOfAnotherEpochAreUnknown)
+{
+    // e.g. the same server before a restart, or another server of the ISL network
+    Server_UserDirectory before, after;
+    ASSERT_NE(before.getEpoch(), after.getEpoch());
+    for (const char *name : {"alice", "bob", "carol"})
+        before.addUser(user(name));
+    for (const char *name : {"dave", "erin", "frank", "grace"})
+        after.addUser(user(name));
+
+    // the stale version is known in the new epoch, but means something else there
+    Server_UserDirectory::Changes changes;
+    ASSERT_FALSE(after.getChangesSince(before.getEpoch(), before.getVersion(), nullptr, changes));
+    ASSERT_TRUE(changes.users.isEmpty() && changes.leftUserNames.isEmpty());
+    ASSERT_TRUE(after.getChangesSince(after.getEpoch(), before.getVersion(), nullptr, changes));
+    ASSERT_EQ(names(changes.users), QStringList({"grace"}));
+}
+
+TEST(UserDirectoryTest, HistoryIsLimited)
+{
+    Server_UserDirectory directory(3);
+    for (const char *name : {"alice", "bob", "carol", "dave"})
+        directory.addUser(user(name));
+
+    Server_UserDirectory::Changes changes;
+    ASSERT_FALSE(directory.getChangesSince(directory.getEpoch(), 0, nullptr, changes));
+    ASSERT_TRUE(directory.getChangesSince(directory.getEpoch(), 1, nullptr, changes));
+    ASSERT_EQ(names(changes.users), QStringList({"bob", "carol", "dave"}));
+
+    directory.setHistorySize(0);
+    ASSERT_FALSE(directory.getChangesSince(directory.getEpoch(), 3, nullptr, changes));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}